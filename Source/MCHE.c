@@ -11,12 +11,98 @@
 
 /**
  * Main entry point of the program.
+ *
+ * The engine can also run a test suite without entering any mode, which is used by
+ * automated builds:
+ * - "MCHE perftsuite <file> [threads] [maxdepth] [json|csv] [report]", the exit status is non-zero if any position failed.
+ * - "MCHE epdsuite <file> <ms> [workers] [json|csv] [report]", the exit status is non-zero if the suite can't be read.
+ * - "MCHE bench [depth] [compare]".
+ * - "MCHE endgames <file>", the exit status is non-zero if any ending is evaluated wrongly.
+ * - "MCHE gentb [dir] [threads] [tables...]", generate the endgame tablebases (e.g. KRKP) or all of them,
+ *   the exit status is non-zero if any table failed.
+ * - "MCHE tune <file> [threads] [epochs] [output]", tune the evaluation weights by the labelled positions of the file
+ *   (a FEN and a result on every line), the exit status is non-zero if the positions can't be read.
+ * - "MCHE evalbench <file> [iterations]", measure the evaluations per second on the positions of an EPD file without
+ *   the evaluation cache and profile the cycles of each group of terms, the exit status is non-zero if the positions
+ *   can't be read or the instruction sets don't give the same evaluations.
  */
-s32 main(){	
+s32 main(s32 argc, char *argv[]){	
 	
 	setbuf(stdin, NULL);
     setbuf(stdout, NULL);
 	
+	if(argc >= 3 && !strcmp(argv[1], "perftsuite")){
+		AllInit();
+		s32 threads = argc >= 4 ? atoi(argv[3]) : 1;
+		s32 maxDepth = argc >= 5 ? atoi(argv[4]) : MAXPERFTDEPTH;
+		if(threads < 1 || threads > 255) threads = 1;
+		if(maxDepth < 1 || maxDepth > MAXPERFTDEPTH) maxDepth = MAXPERFTDEPTH;
+		u8 format = (argc >= 6 && !strcmp(argv[5], "csv")) ? REPORT_CSV : REPORT_JSON;
+		s32 failed = DebugPerftTest(argv[2], threads, maxDepth, format, argc >= 7 ? argv[6] : NULL);
+		return failed == 0 ? 0 : 1;
+	}
+	
+	if(argc >= 4 && !strcmp(argv[1], "epdsuite")){
+		AllInit();
+		s32 time = atoi(argv[3]);
+		s32 workers = argc >= 5 ? atoi(argv[4]) : 1;
+		if(workers < 1 || workers > 255) workers = 1;
+		u8 format = (argc >= 6 && !strcmp(argv[5], "csv")) ? REPORT_CSV : REPORT_JSON;
+		s32 failed = DebugAnalysisTest(argv[2], time > 0 ? time : 1000, workers, format, argc >= 7 ? argv[6] : NULL);
+		return failed < 0 ? 1 : 0;
+	}
+	
+	if(argc >= 2 && !strcmp(argv[1], "bench")){
+		AllInit();
+		static S_BOARD pos[1];
+		InitHashTable(pos->HashTable, HASH_TABLE_SIZE_MB);
+		InitEvalTable(pos->EvalTable, PAWN_TABLE_SIZE_MB, EVAL_TABLE_SIZE_MB);
+		s32 depth = argc >= 3 ? atoi(argv[2]) : 0;
+		DebugBench(pos, depth > 0 && depth <= MAXDEPTH ? depth : 0, argc >= 4 && !strcmp(argv[3], "compare"));
+		CleanMemory(pos->HashTable, pos->EvalTable);
+		return 0;
+	}
+	
+	if(argc >= 3 && !strcmp(argv[1], "endgames")){
+		AllInit();
+		static S_BOARD pos[1];
+		InitEvalTable(pos->EvalTable, SUITE_PAWN_SIZE_MB, SUITE_EVAL_SIZE_MB);
+		s32 failed = DebugEndgameTest(pos, argv[2]);
+		FreeTables(pos->HashTable, pos->EvalTable);
+		return failed == 0 ? 0 : 1;
+	}
+	
+	if(argc >= 2 && !strcmp(argv[1], "gentb")){
+		AllInit();
+		s32 threads = argc >= 4 ? atoi(argv[3]) : 1;
+		if(threads < 1 || threads > 255) threads = 1;
+		s32 failed = GenerateTablebases(argc >= 3 ? argv[2] : TB_DIR, threads, argv + 4, argc > 4 ? argc - 4 : 0);
+		CleanPolyBook();
+		return failed == 0 ? 0 : 1;
+	}
+	
+	if(argc >= 3 && !strcmp(argv[1], "tune")){
+		AllInit();
+		s32 threads = argc >= 4 ? atoi(argv[3]) : 1;
+		s32 epochs = argc >= 5 ? atoi(argv[4]) : TUNE_EPOCHS;
+		if(threads < 1 || threads > 255) threads = 1;
+		if(epochs < 1) epochs = TUNE_EPOCHS;
+		s32 done = TuneEvaluation(argv[2], threads, epochs, argc >= 6 ? argv[5] : TUNE_FILE);
+		CleanPolyBook();
+		return done < 0 ? 1 : 0;
+	}
+	
+	if(argc >= 3 && !strcmp(argv[1], "evalbench")){
+		AllInit();
+		static S_BOARD pos[1];
+		InitEvalTable(pos->EvalTable, SUITE_PAWN_SIZE_MB, 0);
+		s32 iterations = argc >= 4 ? atoi(argv[3]) : EVALBENCH_ITERATIONS;
+		s32 failed = DebugEvalBench(pos, argv[2], iterations > 0 ? iterations : EVALBENCH_ITERATIONS);
+		FreeTables(pos->HashTable, pos->EvalTable);
+		CleanPolyBook();
+		return failed == 0 ? 0 : 1;
+	}
+	
 	SetColor(LIGHT_GREEN);
 	printf("************************************************************************\n");
 	printf("* Momentum's Chess Engine (MCHE), version 1.0, April 2020.\n");
@@ -28,12 +114,15 @@ s32 main(){
 	
 	AllInit();
 	
-	S_BOARD pos[1];
+	static S_BOARD pos[1];		// The history tables make the board too big for the stack
 	S_SEARCHINFO info[1];
 	info->quit = FALSE;
 	info->ponder = FALSE;
 	info->interrupt = FALSE;
 	info->stopped = FALSE;
+	info->nodeLimit = 0;
+	info->mate = 0;
+	info->searchMovesCount = 0;
 	InitHashTable(pos->HashTable, HASH_TABLE_SIZE_MB);
 	InitEvalTable(pos->EvalTable, PAWN_TABLE_SIZE_MB, EVAL_TABLE_SIZE_MB);
 	
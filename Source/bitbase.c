@@ -0,0 +1,196 @@
+/**
+ * @file bitbase.c
+ * This file generates and probes the KPK bitbase.
+ *
+ * The bitbase has one bit for every position of king and pawn against king that tells
+ * if the side of the pawn wins. It is generated at startup by retrograde iteration: the
+ * positions that are known at once (promotion, stalemate, the pawn is captured) are
+ * classified first, then every position is classified from the positions after its moves
+ * until nothing changes.
+ *
+ * The positions are seen from the side of the pawn (i.e. white has the pawn) and the pawn
+ * is on files A to D, the other positions are mirrored.
+ *
+ * I have used ideas from the open source engines Glaurung and Stockfish here.
+ *
+ * @author Tarek Elmenshawy (tarek.elmenshawy1997@gmail.com)
+ * Date: April 2020
+ */
+
+#include"defs.h"
+#include"string.h"
+
+#define KPK_INDEX_MAX (2 * 24 * 64 * 64)	///< The number of indices, side to move x pawn squares (files A-D, ranks 2-7) x white king x black king.
+
+#define KPK_INVALID 0						///< Result of an illegal position.
+#define KPK_UNKNOWN 1						///< Result of a position that isn't classified yet.
+#define KPK_DRAW 	2						///< Result of a drawn position.
+#define KPK_WIN 	4						///< Result of a position that the side of the pawn wins.
+
+/// The bitbase, bit (index) is set if the position of that index is won.
+static u32 KPKBitbase[KPK_INDEX_MAX / 32];
+
+/**
+ * Returns the index of a KPK position in the bitbase.
+ *
+ * @param side The side to move.
+ * @param wKing The square (64) of the white king.
+ * @param pawn The square (64) of the white pawn, it must be on files A to D.
+ * @param bKing The square (64) of the black king.
+ */
+static u32 KPKIndex(const u8 side, const u8 wKing, const u8 pawn, const u8 bKing){
+	return wKing | (bKing << 6) | (side << 12) | (FilesBrd[pawn] << 13) | ((RANK_7 - RanksBrd[pawn]) << 15);
+}
+
+/// Returns the squares attacked by the white pawn on the square (64).
+static u64 KPKPawnAttacks(const u8 pawn){
+	u64 bb = 1ULL << pawn;
+	return ((bb << 9) & ~FILE_A_BB) | ((bb << 7) & ~FILE_H_BB);
+}
+
+/// Returns the distance between two squares (64) in king moves.
+static u8 KPKDistance(const u8 sq1, const u8 sq2){
+	u8 files = abs(FilesBrd[sq1] - FilesBrd[sq2]);
+	u8 ranks = abs(RanksBrd[sq1] - RanksBrd[sq2]);
+	return files > ranks ? files : ranks;
+}
+
+/**
+ * Classifies a position by the rules only (without looking at its moves).
+ *
+ * @param idx The index of the position.
+ * @return The result of the position, KPK_UNKNOWN if its moves must be looked at.
+ */
+static u8 KPKInitial(const u32 idx){
+
+	u8 wKing = idx & 63;
+	u8 bKing = (idx >> 6) & 63;
+	u8 side = (idx >> 12) & 1;
+	u8 pawn = SQ64(FR2SQ((idx >> 13) & 3, RANK_7 - (idx >> 15)));
+	u64 pawnAttacks = KPKPawnAttacks(pawn);
+
+	// Overlapping pieces, touching kings or the black king is in check with white to move
+	if(KPKDistance(wKing, bKing) <= 1 || wKing == pawn || bKing == pawn || (side == WHITE && (pawnAttacks & (1ULL << bKing)))){
+		return KPK_INVALID;
+	}
+
+	if(side == WHITE){
+		// The pawn promotes and the queen can't be captured
+		if(RanksBrd[pawn] == RANK_7 && wKing != pawn + 8 && bKing != pawn + 8 && (KPKDistance(bKing, pawn + 8) > 1 || KPKDistance(wKing, pawn + 8) == 1)){
+			return KPK_WIN;
+		}
+	}else{
+		// Stalemate
+		if(!(KingAttacks[bKing] & ~(KingAttacks[wKing] | pawnAttacks))) return KPK_DRAW;
+		// The black king captures the undefended pawn
+		if(KingAttacks[bKing] & (1ULL << pawn) & ~KingAttacks[wKing]) return KPK_DRAW;
+	}
+
+	return KPK_UNKNOWN;
+}
+
+/**
+ * Classifies a position from the results of the positions after its moves, white wins if any
+ * of its moves wins and black draws if any of its moves draws.
+ *
+ * @param db The results of all positions.
+ * @param idx The index of the position.
+ * @return The result of the position, KPK_UNKNOWN if it still can't be classified.
+ */
+static u8 KPKClassify(const u8 *db, const u32 idx){
+
+	u8 wKing = idx & 63;
+	u8 bKing = (idx >> 6) & 63;
+	u8 side = (idx >> 12) & 1;
+	u8 pawn = SQ64(FR2SQ((idx >> 13) & 3, RANK_7 - (idx >> 15)));
+	u8 good = (side == WHITE) ? KPK_WIN : KPK_DRAW;
+	u8 bad = (side == WHITE) ? KPK_DRAW : KPK_WIN;
+	u8 result = KPK_INVALID;
+	u64 moves;
+
+	if(side == WHITE){
+		moves = KingAttacks[wKing];
+		while(moves) result |= db[KPKIndex(BLACK, PopBit(&moves), pawn, bKing)];
+
+		// Single and double pushes, the promotions are classified already
+		if(RanksBrd[pawn] < RANK_7 && pawn + 8 != wKing && pawn + 8 != bKing){
+			result |= db[KPKIndex(BLACK, wKing, pawn + 8, bKing)];
+			if(RanksBrd[pawn] == RANK_2 && pawn + 16 != wKing && pawn + 16 != bKing){
+				result |= db[KPKIndex(BLACK, wKing, pawn + 16, bKing)];
+			}
+		}
+	}else{
+		moves = KingAttacks[bKing];
+		while(moves) result |= db[KPKIndex(WHITE, wKing, pawn, PopBit(&moves))];
+	}
+
+	// A position without legal moves for black that isn't a stalemate is a mate
+	return (result & good) ? good : (result & KPK_UNKNOWN) ? KPK_UNKNOWN : bad;
+}
+
+/**
+ * Generates the KPK bitbase and prints the time of the generation.
+ */
+void InitKPKBitbase(){
+
+	s32 start = GetTimeMs();
+	u8 *db = (u8 *) malloc(KPK_INDEX_MAX);
+	u32 idx;
+	u8 changed = TRUE;
+
+	if(db == NULL){
+		SetColor(LIGHT_RED);
+		printf("INFO: KPK Bitbase Allocation Faild, memory isn't enough!!!");
+		exit(1);
+	}
+
+	for(idx = 0; idx < KPK_INDEX_MAX; idx++) db[idx] = KPKInitial(idx);
+
+	while(changed){
+		changed = FALSE;
+		for(idx = 0; idx < KPK_INDEX_MAX; idx++){
+			if(db[idx] == KPK_UNKNOWN && (db[idx] = KPKClassify(db, idx)) != KPK_UNKNOWN) changed = TRUE;
+		}
+	}
+
+	u32 wins = 0;
+	memset(KPKBitbase, 0, sizeof(KPKBitbase));
+	for(idx = 0; idx < KPK_INDEX_MAX; idx++){
+		if(db[idx] == KPK_WIN){
+			KPKBitbase[idx / 32] |= 1U << (idx % 32);
+			wins++;
+		}
+	}
+	free(db);
+
+	SetColor(LIGHT_RED);
+	printf("INFO: KPK Bitbase Init Complete With %d Positions(%d KB, %d Wins) in %d ms.\n", KPK_INDEX_MAX, (s32)(sizeof(KPKBitbase) / 1024), wins, GetTimeMs() - start);
+	SetColor(LIGHT_GRAY);
+}
+
+/**
+ * Probes the KPK bitbase for a position of king and pawn against king.
+ *
+ * @param pos The position's pointer.
+ * @return TRUE if the side of the pawn wins, FALSE if it is a draw.
+ */
+u8 ProbeKPK(const S_BOARD *pos){
+
+	u8 strong = pos->pceNum[wP] ? WHITE : BLACK;
+	u8 flip = (strong == WHITE) ? 0 : 56;
+	u8 wKing = SQ64(pos->kingSq[strong]) ^ flip;
+	u8 bKing = SQ64(pos->kingSq[strong ^ 1]) ^ flip;
+	u8 pawn = SQ64(pos->pList[wP + strong * (bP - wP)][0]) ^ flip;
+
+	ASSERT(pos->pceNum[wP] + pos->pceNum[bP] == 1);
+
+	// The bitbase has the pawn on files A to D only
+	if(FilesBrd[pawn] > FILE_D){
+		wKing ^= 7;
+		bKing ^= 7;
+		pawn ^= 7;
+	}
+
+	u32 idx = KPKIndex(pos->side == strong ? WHITE : BLACK, wKing, pawn, bKing);
+	return (KPKBitbase[idx / 32] >> (idx % 32)) & 1;
+}
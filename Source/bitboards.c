@@ -45,6 +45,44 @@ u8 CountBits(u64 b){
 }
 
 
+/**
+ * Returns the squares attacked along a ray up to and including the first occupied square.
+ * The rays to the north and east start from the LSB so their first blocker is the lowest
+ * setted bit, the others start from the MSB.
+ *
+ * @param dir The direction index of RayMasks.
+ * @param sq The square in 64 coordinates.
+ * @param occupied The occupied squares.
+ */
+static u64 RayAttacks(const u8 dir, const u8 sq, const u64 occupied){
+	
+	u64 attacks = RayMasks[dir][sq];
+	u64 blockers = attacks & occupied;
+	
+	if(blockers) attacks ^= RayMasks[dir][dir < 4 ? LSB(blockers) : MSB(blockers)];
+	return attacks;
+}
+
+/**
+ * Returns the squares attacked by a bishop, the occupied squares it hits are included.
+ *
+ * @param sq The square in 64 coordinates.
+ * @param occupied The occupied squares.
+ */
+u64 BishopAttacks(const u8 sq, const u64 occupied){
+	return RayAttacks(2, sq, occupied) | RayAttacks(3, sq, occupied) | RayAttacks(6, sq, occupied) | RayAttacks(7, sq, occupied);
+}
+
+/**
+ * Returns the squares attacked by a rook, the occupied squares it hits are included.
+ *
+ * @param sq The square in 64 coordinates.
+ * @param occupied The occupied squares.
+ */
+u64 RookAttacks(const u8 sq, const u64 occupied){
+	return RayAttacks(0, sq, occupied) | RayAttacks(1, sq, occupied) | RayAttacks(4, sq, occupied) | RayAttacks(5, sq, occupied);
+}
+
 /**
  * To print u64 variable as board on console.
  *
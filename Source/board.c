@@ -84,6 +84,7 @@ u8 CheckBoard(const S_BOARD *pos){
 	ASSERT(pos->side == WHITE || pos->side == BLACK);
 	ASSERT(GeneratePosKey(pos) == pos->posKey);
 	ASSERT(GeneratePawnKey(pos) == pos->pawnKey);
+	ASSERT(GenerateMaterialKey(pos) == pos->materialKey);
 	
 	ASSERT(pos->enPass == NO_SQ || (pos->side == WHITE && RanksBrd[SQ64(pos->enPass)] == RANK_6) || (pos->side == BLACK && RanksBrd[SQ64(pos->enPass)] == RANK_3));
 	
@@ -249,6 +250,7 @@ u8 ParseFen(const char *fen, S_BOARD *pos){
 	// position key
 	pos->posKey = GeneratePosKey(pos);                        // Generate an new postion key corresponding to the new case then update the poskey
 	pos->pawnKey = GeneratePawnKey(pos);
+	pos->materialKey = GenerateMaterialKey(pos);
 	
 	return TRUE;                                              // Return 1 if no errors occure
 }
@@ -290,6 +292,7 @@ void ResetBoard(S_BOARD *pos){
 	
 	pos->posKey = 0ULL;
 	pos->pawnKey = 0ULL;
+	pos->materialKey = 0ULL;
 	
 }
 
@@ -337,6 +340,7 @@ void PrintBoard(const S_BOARD *pos){
 #ifdef DEBUG
 	printf("posKey: %llX\n", pos->posKey);
 	printf("pawnKey: %llX\n", pos->pawnKey);
+	printf("materialKey: %llX\n", pos->materialKey);
 #endif
 	
 }
@@ -378,6 +382,7 @@ void MirrorBoard(S_BOARD *pos){
 	pos->enPass = tempEnnPass;
 	pos->posKey = GeneratePosKey(pos);
 	pos->pawnKey = GeneratePawnKey(pos);
+	pos->materialKey = GenerateMaterialKey(pos);
 	
 	
 	
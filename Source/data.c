@@ -20,6 +20,7 @@ const u8 PieceMaj[13] = {FALSE, FALSE, FALSE, FALSE, TRUE, TRUE, TRUE, FALSE, FA
 const u8 PieceMin[13] = {FALSE, FALSE, TRUE, TRUE, FALSE, FALSE, FALSE, FALSE, TRUE, TRUE, FALSE, FALSE, FALSE};      // Knights and Bishops
 const s16 PieceVal[13] = {0, 100, 325, 325, 500, 975, 0, 100, 325, 325, 500, 975, 0};
 const u8 PieceCol[13] = {BOTH, WHITE, WHITE, WHITE, WHITE, WHITE, WHITE, BLACK, BLACK, BLACK, BLACK, BLACK, BLACK};
+const u8 PromotedPce[2][4] = {{wN, wB, wR, wQ}, {bN, bB, bR, bQ}};												// Indexed by side and promotion type of the move
 
 // These arrays give an answer about a specified question by passing the type of piece as an index
 const u8 PiecePawn[13] = {FALSE, TRUE, FALSE, FALSE, FALSE, FALSE, FALSE, TRUE, FALSE, FALSE, FALSE, FALSE, FALSE}; 
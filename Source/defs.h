@@ -23,8 +23,92 @@
 #define USE_HISTORY						///< Macro to use history of best moves (i.e., moves that improve alpha) in searching process.
 #define USE_EVALMOVE					///< Macro to use evaluation move technique in moves ordering.
 #define USE_SEE							///< Macro to use static exchange evaluation technique in moves ordering.
+#define USE_EVAL_TABLE					///< Macro to cache the evaluation of positions in the evaluation table, without it only the hash table keeps them.
+//#define FIXED_OPTIONS					///< Macro to fix the search options to their default values at compile time.
+//#define USE_SEARCH_STATS				///< Macro to collect search statistics and dump them as JSON after every search.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define USE_SIMD						///< Macro to build the AVX2 piece square sums of the evaluation, they are used only if the CPU supports them.
+#endif
+
+/* Default values of the search options, they can be changed at runtime by UCI/console options */
+#define DEFAULT_NULLMOVE_R		4		///< Base depth reduction of null-move search, it grows with depth and static evaluation.
+#define DEFAULT_LMR_MOVES		4		///< Number of legal moves searched before late move reduction is tried.
+#define DEFAULT_LMR_DEPTH		3		///< Minimum depth where late move reduction is tried.
+#define DEFAULT_LMR_REDUCTION	1		///< Extra depth reduction of a late move if LmrTable isn't used.
+#define LMR_TABLE_DIVISOR		4.0		///< The reductions of LmrTable are ln(depth) * ln(move number) / LMR_TABLE_DIVISOR.
+#define LMR_HISTORY_DIVISOR		8192	///< History score of a quiet move that takes back one ply of its late move reduction, or adds one if it is negative.
+#define HISTORY_MAX				16384	///< Bound of the history scores, the gravity updates keep every entry in [-HISTORY_MAX, HISTORY_MAX].
+#define DEFAULT_PAWN_EXTENSION	TRUE	///< Extend the pushes of pawns from the 7th/2nd rank.
+#define DEFAULT_THREAT_EXTENSION	TRUE	///< Extend the moves of a node where the null move gets mated.
+
+/* 
+ * The search options are read from EngineOptions at runtime, if FIXED_OPTIONS is defined
+ * they are replaced by their default values so the compiler can fold them away.
+ */
+#ifdef FIXED_OPTIONS
+	#define OPT_TABLES				TRUE
+	#define OPT_NULLMOVE			TRUE
+	#define OPT_KILLERS				TRUE
+	#define OPT_HISTORY				TRUE
+	#define OPT_COUNTERMOVE			TRUE
+	#define OPT_CONTHISTORY			TRUE
+	#define OPT_CAPTUREHISTORY		TRUE
+	#define OPT_EVALMOVE			TRUE
+	#define OPT_SEE					TRUE
+	#define OPT_NULLMOVE_R			DEFAULT_NULLMOVE_R
+	#define OPT_LMR_MOVES			DEFAULT_LMR_MOVES
+	#define OPT_LMR_DEPTH			DEFAULT_LMR_DEPTH
+	#define OPT_LMR_REDUCTION		DEFAULT_LMR_REDUCTION
+	#define OPT_LMR_TABLE			TRUE
+	#define OPT_PAWN_EXTENSION		DEFAULT_PAWN_EXTENSION
+	#define OPT_THREAT_EXTENSION	DEFAULT_THREAT_EXTENSION
+	#define OPT_IID					TRUE
+	#define OPT_IIR					TRUE
+	#define OPT_SINGULAR			TRUE
+	#define OPT_RFP					TRUE
+	#define OPT_FUTILITY			TRUE
+	#define OPT_RAZORING			TRUE
+	#define OPT_LMP					TRUE
+#else
+	#define OPT_TABLES				(EngineOptions->UseTables)
+	#define OPT_NULLMOVE			(EngineOptions->UseNullMove)
+	#define OPT_KILLERS				(EngineOptions->UseKillers)
+	#define OPT_HISTORY				(EngineOptions->UseHistory)
+	#define OPT_COUNTERMOVE			(EngineOptions->UseCounterMove)
+	#define OPT_CONTHISTORY			(EngineOptions->UseContHistory)
+	#define OPT_CAPTUREHISTORY		(EngineOptions->UseCaptureHistory)
+	#define OPT_EVALMOVE			(EngineOptions->UseEvalMove)
+	#define OPT_SEE					(EngineOptions->UseSEE)
+	#define OPT_NULLMOVE_R			(EngineOptions->NullMoveR)
+	#define OPT_LMR_MOVES			(EngineOptions->LmrMoves)
+	#define OPT_LMR_DEPTH			(EngineOptions->LmrDepth)
+	#define OPT_LMR_REDUCTION		(EngineOptions->LmrReduction)
+	#define OPT_LMR_TABLE			(EngineOptions->UseLmrTable)
+	#define OPT_PAWN_EXTENSION		(EngineOptions->PawnExtension)
+	#define OPT_THREAT_EXTENSION	(EngineOptions->ThreatExtension)
+	#define OPT_IID					(EngineOptions->UseIID)
+	#define OPT_IIR					(EngineOptions->UseIIR)
+	#define OPT_SINGULAR			(EngineOptions->UseSingular)
+	#define OPT_RFP					(EngineOptions->UseRFP)
+	#define OPT_FUTILITY			(EngineOptions->UseFutility)
+	#define OPT_RAZORING			(EngineOptions->UseRazoring)
+	#define OPT_LMP					(EngineOptions->UseLMP)
+#endif
 
 
+/* 
+ * The search statistics counters are only touched through these macros,
+ * so they cost nothing when USE_SEARCH_STATS is not defined.
+ */
+#ifdef USE_SEARCH_STATS
+	#define STAT_INC(counter)		((counter)++)
+	#define STAT_ADD(counter, n)	((counter) += (n))
+#else
+	#define STAT_INC(counter)
+	#define STAT_ADD(counter, n)
+#endif
+
 #ifndef DEBUG
 	/// Debugging funtion
 	#define ASSERT(n)
@@ -67,18 +151,63 @@ typedef uint32_t u32;					///< Declares u32 to be an alias for the type uint32_t
 typedef int16_t  s16;					///< Declares s16 to be an alias for the type int16_t.
 typedef uint16_t u16;					///< Declares u16 to be an alias for the type uint16_t.
 
+#define THREAD_LOCAL __thread			///< Storage class of scratch data that must be private to each worker thread.
+
 #define NAME         "MCHE 1.0"			///< Name and version of chess engine.
 #define BRD_SQ_NUM    120				///< Number of board squres.
 
 #define MAXDEPTH 			64			///< Maximum number of depth that we would expect in searching.
 #define MAXGAMEMOVES 		350			///< Maximum number of moves that we would expect in a game.
 #define MAXPOSITIONMOVES 	256			///< Maximum number of moves for a given position.
+#define MAXPERFTDEPTH 		16			///< Maximum depth that can be read from a perft test suite.
+#define MAXEPDMOVES 		8			///< Maximum number of bm/am moves that can be read from an EPD test suite.
+#define MAXMULTIPV 			16			///< Maximum number of lines of MultiPV analysis.
+#ifdef USE_EVAL_TABLE
 #define HASH_TABLE_SIZE_MB 	128			///< Size of hash table in MB.
+#define SUITE_HASH_SIZE_MB 	16			///< Size of hash table of each test suite worker in MB.
+#else
+#define HASH_TABLE_SIZE_MB 	192			///< Size of hash table in MB, it takes the memory of the evaluation table.
+#define SUITE_HASH_SIZE_MB 	24			///< Size of hash table of each test suite worker in MB, it takes the memory of the evaluation table.
+#endif
 #define EVAL_TABLE_SIZE_MB 	64			///< Size of evaluation table in MB.
 #define PAWN_TABLE_SIZE_MB 	32			///< Size of pawn structure evaluation table in MB.
+#define SUITE_EVAL_SIZE_MB 	8			///< Size of evaluation table of each test suite worker in MB.
+#define SUITE_PAWN_SIZE_MB 	4			///< Size of pawn structure evaluation table of each test suite worker in MB.
+#define EVALBENCH_ITERATIONS 	10		///< Default number of times the evaluation bench evaluates every position.
+#define MATERIAL_TABLE_SIZE 8192		///< No. of entries of the material table, the material configurations are few so it doesn't depend on the memory size.
+
+#define MATERIAL_DRAW		 1			///< Material flag, neither side has enough material to win.
+#define MATERIAL_BISHOPS	 2			///< Material flag, an ending with one bishop each and few pawns, a draw if the bishops are on opposite colors.
 
 #define INFINITY 30000					///< Mathematical number represents infinity.
 #define ISMATE (INFINITY - MAXDEPTH)    ///< Cantant value compared to the score to detect mate state.
+#define KNOWN_WIN 1000					///< Evaluation bonus of an ending that is known to be won (e.g. KBNK), far below the mate scores.
+#define TB_WIN (ISMATE - MAXDEPTH)		///< Score of a tablebase win (without its distance to mate), below the mate scores.
+#define TB_WIN_MIN (TB_WIN - MAXDEPTH)	///< The lowest score of a tablebase win at any ply, the hash table stores the scores above it (mates too) from the position.
+
+#define TB_DIR				"tb"		///< The directory of the endgame tablebase files.
+#define TB_MAXPIECES		 4			///< Maximum number of pieces (kings included) of an endgame tablebase.
+#define TB_NAME_SIZE		 4096		///< Size of the name of a tablebase file with its directory (PATH_MAX).
+#define TB_KING_SLOTS		 10			///< No. of squares of the white king in the files of a table without pawns (a1-d1-d4 triangle).
+#define TB_PAWN_KING_SLOTS	 32			///< No. of squares of the white king in the files of a table with pawns (files a-d).
+#define TB_WDL_BITS			 2			///< Bits of a value of a win/draw/loss file, 4 values in a byte.
+#define TB_DTM_BITS			 8			///< Bits of a value of a distance to mate file, a byte.
+#define TB_CODE_DRAW		 0			///< Distance to mate code of a draw, a win/loss in n plies has the code n + 1 (even for a win, odd for a loss).
+#define TB_CODE_ILLEGAL		 255		///< Distance to mate code of an illegal position.
+#define WDL_LOSS			 0			///< Win/draw/loss value of a position that the side to move loses.
+#define WDL_DRAW			 1			///< Win/draw/loss value of a drawn position.
+#define WDL_WIN				 2			///< Win/draw/loss value of a position that the side to move wins.
+#define WDL_ILLEGAL			 3			///< Win/draw/loss value of an illegal position.
+
+#define WEIGHTS_FILE		"weights.txt"	///< The file of the evaluation weights that is loaded at startup if it exists.
+#define TUNE_FILE			"tuned.txt"	///< The default file of the tuned weights, it is renamed to WEIGHTS_FILE to be used.
+#define TUNE_EPOCHS			 100		///< The default number of epochs of the tuning.
+#define WEIGHT_MAX			 30000		///< The largest absolute middle game or ending value of a weight in a weights file, it must fit a 16 bit half of a packed score.
+#define TUNE_LINE_SIZE		 512		///< Maximum length of a line of the tuning positions file.
+#define TUNE_TRACE_TOLERANCE 4			///< The largest difference of the sum of the evaluation trace from the evaluation, the rounding of the taper, the scale and the halved bonuses.
+#define TUNE_LEARNING_RATE	 1.0		///< The step of the weights in every epoch of the tuning (Adam).
+#define TUNE_BETA1			 0.9		///< Decay rate of the mean of the gradient (Adam).
+#define TUNE_BETA2			 0.999		///< Decay rate of the variance of the gradient (Adam).
 
 #define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" ///< Starting position in FEN notation.           
 
@@ -152,6 +281,10 @@ enum{
 #define XBOARD_MODE	 1					///< XBoard mode constant.
 #define CONSOLE_MODE 2					///< Console mode constant.
 
+// Numerator constants of test suites report formats
+#define REPORT_JSON	 0					///< JSON report format constant.
+#define REPORT_CSV	 1					///< CSV report format constant.
+
 // Hash tables flags
 #define HFNONE		 0					///< None flag constant of Hash Tables.
 #define HFALPHA		 1					///< Alpha flag constant of Hash Tables.
@@ -173,25 +306,148 @@ enum{
 #define PHASE_ENDING       	 2			///< Ending game phase contant.
 #define PHASE_PAWN_ENDING  	 3 			///< Ending pawn game phase contant. No null-moves in this phase.
 
+/* Tapered evaluation */
+#define PHASE_MAX			24			///< The taper phase of all pieces (1 for a knight or a bishop, 2 for a rook and 4 for a queen), 0 is only kings and pawns.
+
+typedef s32 S_SCORE;					///< A packed score of an evaluation term, the middle game value in the low 16 bits and the ending value in the high 16 bits.
+
+/// Packs the middle game and ending values in a score, the scores are added and multiplied by integers without unpacking.
+#define SCORE(mg, eg)		((S_SCORE) ((u32) (eg) << 16) + (mg))
+#define SCORE_MG(score)		((s16) (u16) (u32) (score))					///< Returns the middle game value of a score.
+#define SCORE_EG(score)		((s16) (u16) (((u32) (score) + 0x8000) >> 16))	///< Returns the ending value of a score.
+
+/* Instruction sets of the piece square sums of the evaluation */
+#define SIMD_NONE			 0			///< The scalar sums, one piece at a time.
+#define SIMD_AVX2			 1			///< The AVX2 sums, a rank (8 squares) at a time.
+#define SIMD_NUM			 2			///< The number of the instruction sets.
+
+/* Groups of terms of the evaluation profile */
+#define EVAL_PROF_MATERIAL	 0			///< The material entry, the evaluation table and the piece bitboards.
+#define EVAL_PROF_PAWNS		 1			///< The pawn structure entry.
+#define EVAL_PROF_PIECESQ	 2			///< The piece square sums.
+#define EVAL_PROF_TRAPPED	 3			///< The trapped pieces.
+#define EVAL_PROF_PASSERS	 4			///< The passed pawns.
+#define EVAL_PROF_ATTACKS	 5			///< The mobility, attacks and placement of the pieces.
+#define EVAL_PROF_KING		 6			///< The king attack and defense, and the tempo.
+#define EVAL_PROF_HUNG		 7			///< The hung pieces.
+#define EVAL_PROF_DRAW		 8			///< The taper, the draw adjustment and the store to the evaluation table.
+#define EVAL_PROF_NUM		 9			///< The number of the groups.
+
 /* Contempt factor values */
 #define CONTEMPT_OPENING  50			///< Contempt factor value for opening phase.
 #define CONTEMPT_MIDDLE   25			///< Contempt factor value for middle phase.
 #define CONTEMPT_ENDING    0			///< Contempt factor value for ending phase.
 
+/* Quiescence search constants */
+#define DELTA_MARGIN     200			///< Safety margin of delta pruning in centipawns.
+
 /// This is a struct to contain configuration options of the engine
 typedef struct{
 	u8 UseBook;							///< A flag to use opening book or not.
+	u8 MultiPV;							///< The number of best lines reported by the search.
+	u8 UseTables;						///< A flag to probe hash table in searching process (USE_TABLES).
+	u8 UseNullMove;						///< A flag to use null-move technique in searching process (USE_NULLMOVE).
+	u8 UseKillers;						///< A flag to use killer moves in searching process (USE_KILLERS).
+	u8 UseHistory;						///< A flag to use history of best moves in searching process (USE_HISTORY).
+	u8 UseEvalMove;						///< A flag to use evaluation move technique in moves ordering (USE_EVALMOVE).
+	u8 UseSEE;							///< A flag to use static exchange evaluation in moves ordering (USE_SEE).
+	u8 NullMoveR;						///< Base depth reduction of null-move search.
+	u8 LmrMoves;						///< Number of legal moves searched before late move reduction is tried.
+	u8 LmrDepth;						///< Minimum depth where late move reduction is tried.
+	u8 LmrReduction;					///< Extra depth reduction of a late move if LmrTable isn't used.
+	u8 UseLmrTable;						///< A flag to reduce the late moves by the depth and move number reductions of LmrTable instead of LmrReduction.
+	u8 PawnExtension;					///< A flag to extend the pushes of pawns from the 7th/2nd rank.
+	u8 ThreatExtension;					///< A flag to extend the moves of a node where the null move gets mated.
+	u8 UseRFP;							///< A flag to use reverse futility (static evaluation) pruning.
+	u8 UseFutility;						///< A flag to use futility pruning of quiet moves.
+	u8 UseRazoring;						///< A flag to use razoring.
+	u8 UseLMP;							///< A flag to use late move (move count) pruning.
+	u8 UseIID;							///< A flag to use internal iterative deepening in PV nodes without a hash move.
+	u8 UseIIR;							///< A flag to use internal iterative reduction in non-PV nodes without a hash move.
+	u8 UseSingular;						///< A flag to use singular extensions and multi-cut.
+	u8 UseCounterMove;					///< A flag to order the counter move of the previous move after the killers.
+	u8 UseContHistory;					///< A flag to add the one and two ply continuation histories to the history of quiet moves.
+	u8 UseCaptureHistory;				///< A flag to add the capture history to the scores of captures.
 }S_OPTIONS;
 
+/// This is a struct that represents one position of a perft test suite and the result of checking it.
+typedef struct{
+	char fen[128];						///< The FEN notation of the position.
+	u64 expected[MAXPERFTDEPTH + 1];	///< Expected leaf nodes indexed by depth, zero if the suite has no entry for that depth.
+	u64 found;							///< Leaf nodes found at the deepest checked depth or at the failed depth.
+	u64 nodes;							///< Total leaf nodes visited for all checked depths.
+	s32 time;							///< Total time spent on this position in milliseconds.
+	u8 depth;							///< The deepest depth that has been checked.
+	u8 failDepth;						///< The depth where the node count mismatched, zero if the position passed.
+}S_PERFTJOB;
+
+/// This is a struct that represents one position of an EPD test suite and the result of searching it.
+typedef struct{
+	char fen[128];						///< The FEN notation of the position.
+	char id[64];						///< The id operation of the position.
+	char expected[64];					///< The bm/am operand as written in the suite.
+	s32 moves[MAXEPDMOVES];				///< The bm/am moves.
+	u8 moveCount;						///< The number of bm/am moves.
+	u8 am;								///< A flag that the moves are avoid moves (am) not best moves (bm).
+	s32 bestMove;						///< The best move found at the end of search.
+	u8 depth;							///< The deepest completed depth.
+	u8 solveDepth;						///< The depth from which the best move stayed correct, zero if not solved.
+	s32 solveTime;						///< The time in milliseconds when the best move became correct and stayed so.
+	u64 solveNodes;						///< The nodes searched when the best move became correct and stayed so.
+	u64 nodes;							///< The total searched nodes.
+	s32 time;							///< The total search time in milliseconds.
+}S_EPDJOB;
+
 /// This is a struct that represents an entry of hash table to store the data of search.
 typedef struct{
 	u64 posKey;							///< The position key that is an ID of a specified board position.
-	s32 move;							///< The move is that the best for this board position.
+	u16 move;							///< The move is that the best for this board position.
 	s16 score;							///< The score of this move.
+	s16 eval;							///< The static evaluation of the position, -INFINITY if it was not evaluated (in check).
 	u8 depth;							///< The depth of search where this move is found.
 	u8 flag;							///< The flag type (HFNONE, HFALPHA, HFBETA, HFEXACT).
 }S_HASHENTRY;
 
+/// This is a struct of all weights of the evaluation, every weight is a score (middle game and ending values) so the struct is also a vector of EVAL_WEIGHTS_NUM scores for the tuner.
+typedef struct{
+	S_SCORE pieceValue[5];				///< The values of pawn, knight, bishop, rook and queen.
+	S_SCORE bishopPair;					///< Bonus of the bishop pair.
+	S_SCORE doubledPawn;				///< Penalty of a doubled pawn.
+	S_SCORE isolatedPawn;				///< Penalty of an isolated pawn.
+	S_SCORE weakPawn;					///< Penalty of a weak pawn that can't be supported nor advance.
+	S_SCORE passedRank[8];				///< Bonus of a passed pawn by its rank from its side's point of view.
+	S_SCORE unstoppablePasser;			///< Bonus of a passed pawn that the enemy king can't catch in a pawn ending.
+	S_SCORE knightOutpost[64];			///< Bonus of a knight on an outpost square for every pawn protecting it (white's point of view).
+	S_SCORE rookOnOpen;					///< Bonus of a rook on an open file.
+	S_SCORE rookOnSemi;					///< Bonus of a rook on a semi-open file (with only enemy pawns).
+	S_SCORE rookOnSeventh;				///< Bonus of a rook on the 7th rank.
+	S_SCORE rookBehindPasser;			///< Bonus of a rook behind an enemy passed pawn.
+	S_SCORE queenOnSeventh;				///< Bonus of a queen on the 7th rank.
+	S_SCORE pinnedPiece;				///< Bonus of every enemy piece pinned to a more valuable one.
+	S_SCORE mobility;					///< Bonus of every empty square a piece attacks.
+	S_SCORE mobilitySafe;				///< Extra bonus of every empty square a piece attacks that no lesser enemy piece attacks.
+	S_SCORE lowMobility;				///< Penalty of a piece without safe squares for every rank it is up the board, halved for one safe square.
+	S_SCORE tropism[4][8];				///< Bonus of a knight, bishop, rook or queen by its distance to the enemy king.
+	S_SCORE kingAttack[80];				///< Penalty of the king by the count of the enemy attacks around it.
+	S_SCORE kingShelter[8];				///< Bonus of the pawn sheltering the king on a file by its relative rank, [0] if there is none.
+	S_SCORE pawnStorm[8];				///< Penalty of the enemy pawn storming the king on a file by its relative rank, [0] if there is none.
+	S_SCORE fianchetto;					///< Bonus of a fianchettoed bishop on the side of the king.
+	S_SCORE kingWeakPawn;				///< Penalty of a moved f (or c) pawn while the king is on its original square.
+	S_SCORE trappedKnight;				///< Penalty of a knight trapped on the 7th rank.
+	S_SCORE trappedKnightCorner;		///< Penalty of a knight trapped in a corner of the enemy side.
+	S_SCORE trappedBishop;				///< Penalty of a bishop trapped by an enemy pawn.
+	S_SCORE trappedBishopSupported;		///< Extra penalty of a trapped bishop that can't get out.
+	S_SCORE trappedRook;				///< Penalty of a rook trapped in the corner by its own king.
+	S_SCORE blockedCenterPawn;			///< Penalty of a blocked d or e pawn on its original square.
+	S_SCORE blockedBishop;				///< Extra penalty of a blocked center pawn in front of the bishop.
+	S_SCORE hungPieces;					///< Penalty of two hung pieces of the side to move, doubled for more.
+	S_SCORE tempo;						///< Bonus of the side to move, doubled if it attacks the enemy king.
+	S_SCORE pst[6][64];					///< The piece square tables of pawn, knight, bishop, rook, queen and king (white's point of view).
+}S_EVALWEIGHTS;
+
+#define EVAL_WEIGHTS_NUM (sizeof(S_EVALWEIGHTS) / sizeof(S_SCORE))	///< The number of evaluation weights.
+#define EVAL_TRACE_SIZE (2 * EVAL_WEIGHTS_NUM)						///< The size of an evaluation trace, the middle game and ending coefficients of every weight.
+
 /// This is a struct that represents one of evaluation table entries to store the evluation value of a specified board position.
 typedef struct{
 	u64 posKey;							///< The position key that is an ID of a specified board position.
@@ -201,19 +457,72 @@ typedef struct{
 /// This is a struct that represents one of evaluation table entries to store the pawn structure of a specified board position. 
 typedef struct{
 	u64 pawnKey;						///< The pawn key is an ID of a specified pawn structure.
-	s8 whiteStructure;					///< The evaluation of the white pawn strucutre.
-	s8 blackStructure;					///< The evaluation of the black pawn strucutre.
-	u16 passers;						///< The white and black passed pawns.
+	u64 passed[2];						///< The passed pawns of each side, only the most advanced pawn of a file can be passed.
+	u64 attacks[2];						///< The squares attacked by the pawns of each side.
+	u64 attackSpan[2];					///< The squares the pawns of each side attack or can attack as they advance.
+	u64 shelter[2];						///< The most backward pawn of each side on every file, it is the pawn that shelters a king on the file.
+	S_SCORE structure[2];				///< The evaluation of the pawn structure of each side (without passed pawns).
 }S_PAWNENTRY;
 
+struct S_BOARD;
+
+/// This is a function that evaluates a specified material configuration (e.g. KBNK) instead of the general evaluation, the score is from white's point of view.
+typedef s16 (*S_ENDGAMEEVAL)(const struct S_BOARD *pos);
+
+/// This is a struct that represents one of material table entries to store the information of a specified material configuration.
+typedef struct{
+	u64 materialKey;					///< The material key is an ID of a specified material configuration.
+	S_ENDGAMEEVAL evaluate;				///< The specialized evaluation function of the material configuration, NULL if there is none.
+	S_SCORE material[2];				///< The material of each side with its imbalance bonus (bishop pair).
+	u8 scale[2];						///< The percentage of the evaluation kept when each side is ahead, 0 if the side can't win with its material.
+	u8 phase;							///< The taper phase of the material configuration, from PHASE_MAX down to 0.
+	u8 gamePhase;						///< The game phase of the material configuration (PHASE_OPENING ... PHASE_PAWN_ENDING).
+	u8 flags;							///< The material flags (MATERIAL_DRAW, MATERIAL_BISHOPS).
+}S_MATERIALENTRY;
+
+/// This is a struct that represents the endgame tablebase of one material configuration, a win/draw/loss file and a distance to mate file.
+typedef struct{
+	char code[TB_MAXPIECES + 3];		///< The pieces of white then the pieces of black (e.g. "KRKP").
+	u8 count;							///< The number of pieces.
+	u8 pieces[TB_MAXPIECES];			///< The pieces in the order of the index, the two kings then the other white pieces then the other black pieces.
+	u64 materialKey[2];					///< The material key when white has the white pieces of the code ([WHITE]) or black has them ([BLACK]).
+	u32 size;							///< The number of positions (2 x 64 ^ count), the side to move and a square for every piece.
+	u32 entries;						///< The number of positions in the files, the white king is reduced to TB_KING_SLOTS or TB_PAWN_KING_SLOTS squares.
+	u8 pawns;							///< TRUE if the table has pawns, its files are reduced by the file mirror only.
+	const u8 *wdl;						///< The mapped win/draw/loss file, NULL if it isn't loaded.
+	const u8 *dtm;						///< The mapped distance to mate file, NULL if it isn't loaded.
+	u32 wdlSize;						///< The size of the win/draw/loss file in bytes.
+	u32 dtmSize;						///< The size of the distance to mate file in bytes.
+	u8 *data;							///< The distance to mate codes of all positions in memory, only used by the generator.
+}S_TBTABLE;
+
+/// This is the header of a tablebase file, it is followed by the values of the positions packed in bits.
+typedef struct{
+	char magic[4];						///< The characters "MCTB".
+	u32 entries;						///< The number of positions.
+	u32 bits;							///< The bits of a value, TB_WDL_BITS or TB_DTM_BITS.
+}S_TBHEADER;
+
+/// This is a struct that represents one of the endings that have a specialized evaluation or scale factor.
+typedef struct{
+	const char *code;					///< The pieces of the winning side then the pieces of the losing side (e.g. "KRKP").
+	S_ENDGAMEEVAL evaluate;				///< The evaluation function of the ending, NULL if only the scale factor is used.
+	u8 scale;							///< The percentage of the evaluation kept when the winning side is ahead.
+}S_ENDGAME;
+
 /// This is a struct to contain information about evaluation table (no. of entries and no. of times that data retrieve).
 typedef struct{
 	S_PAWNENTRY *pPawnTable;			///< A Pointer to the first entry of the pawn evaluation entries in the evaluation table.
 	S_EVALENTRY *pEvalTable;			///< A Pointer to the first entry of the position evaluation entries in the evaluation table.
+	S_MATERIALENTRY *pMaterialTable;	///< A Pointer to the first entry of the material entries in the evaluation table.
 	u32 numEntriesPawn;					///< The number of pawn evaluation entries.
 	u32 numEntriesEval;					///< The number of position evaluation entries.
-	u32 evalhits;						///< the number of times that position evaluation entries are retrieved.
-	u32 pawnhits;						///< the number of times that pawn evaluation entries are retrieved.
+	u64 evalhits;						///< the number of times that position evaluation entries are retrieved (USE_SEARCH_STATS only).
+	u64 pawnhits;						///< the number of times that pawn evaluation entries are retrieved (USE_SEARCH_STATS only).
+	u64 materialhits;					///< the number of times that material entries are retrieved (USE_SEARCH_STATS only).
+	u64 evalprobes;						///< the number of times that position evaluation entries are probed (USE_SEARCH_STATS only).
+	u64 pawnprobes;						///< the number of times that pawn evaluation entries are probed (USE_SEARCH_STATS only).
+	u64 materialprobes;					///< the number of times that material entries are probed (USE_SEARCH_STATS only).
 }S_EVALTABLE;
 
 /// This is a struct to contain information about hash table (no. of entries, no. of times that data retrieve, no. of overwrite casee etc.).
@@ -234,15 +543,11 @@ typedef struct{
 	/// An integer number that represents a move. This number cotains information about (from square, to square, ...).
 	/**
 	 *  Move Representation:\n
-	 *  0000 0000 0000 0000 0000 0111 1111 -> From 0x7F \n
-	 *  0000 0000 0000 0011 1111 1000 0000 -> To >> 7, 0x7F \n
-	 *  0000 0000 0011 1100 0000 0000 0000 -> Captured >> 14, 0xF \n
-	 *  0000 0000 0100 0000 0000 0000 0000 -> EP 0x40000 \n
-	 *  0000 0000 1000 0000 0000 0000 0000 -> Pawn Start 0x80000 \n
-	 *  0000 1111 0000 0000 0000 0000 0000 -> Promoted Piece >> 20, 0xF \n
-	 *  0001 0000 0000 0000 0000 0000 0000 -> Castle 0x1000000 \n
+	 *  0000 0000 0011 1111 -> From (64 squares) 0x3F \n
+	 *  0000 1111 1100 0000 -> To (64 squares) >> 6, 0x3F \n
+	 *  1111 0000 0000 0000 -> Flags >> 12, 0xF \n
 	 */
-	s32 move;					
+	u16 move;					
 	
 	s32 score;							///< The score of move repressents of move priority, and socre is used in move ordering.
 }S_MOVE;
@@ -255,16 +560,19 @@ typedef struct{
 
 /// This is a struct to contain information about a specific move to be able to store history and not lose game data.
 typedef struct{
-	s32 move;							///< It is a bit field that represents a move in 25 bits. This number cotains information about (from square, to square, ...).
+	u16 move;							///< It is a bit field that represents a move in 16 bits. This number cotains information about (from square, to square, ...).
 	u8 castlePerm;						///< An integer number that represents the castling permission flag in 4 bits(1001) according to numerator contants(WKCA = 1, ..., BQCA = 8).
 	u8 enPass;							///< The en passent square if there is one active, if not that will be set to NO_SQ.
 	u8 fiftyMove;						///< The fifty move counter, remember when that hits fifty move then the game is drawn.
+	u8 piece;							///< The moved piece, EMPTY for a null move.
+	u8 captured;						///< The captured piece, EMPTY if the move isn't a capture or it is en passant.
 	u64 posKey;							///< The position key that is an ID of a specified board position.
 	u64 pawnKey;						///< The pawn key is an ID of a specified pawn structure.
+	u64 materialKey;					///< The material key is an ID of the piece counts of a specified board position.
 }S_UNDO;
 
 /// This is a struct to contain all information about board representation.
-typedef struct{
+typedef struct S_BOARD{
 	u8 pieces[BRD_SQ_NUM];              ///< An array of 120 elements to represent the total board in where stored integer values represent the status of our board.
     u64 pawns[3];                       ///< An array to represent the exsited pawns on 64 squares of the board using 64 bits. Three elements to represent three colors (WHITE, BLACK, BOTH).                          
 
@@ -281,6 +589,7 @@ typedef struct{
 
 	u64 posKey;                         ///< The position key is a unique key, normally called hash key and represents an ID for each board position.						
 	u64 pawnKey;						///< The pawn key is an ID of a specified pawn structure.
+	u64 materialKey;					///< The material key is an ID of the piece counts, it is the same for every position with the same material.
 	
 	// These arrays will be used when we're evaluating a given board position.
 	u8 pceNum[13];                      ///< The number of pieces on the board where each index has a corresponding type according to numerator constants(0 = EMPTY, ..., 12 = bK)
@@ -297,29 +606,79 @@ typedef struct{
 	
 	S_EVALTABLE EvalTable[1];			///< A pinter to the evaluation table.
 	S_HASHTABLE HashTable[1];			///< A pinter to the hash table.
-	s32 PvArray[MAXDEPTH];				///< An array to store principle variation moves depends on searching process.
+	u16 PvArray[MAXDEPTH];				///< An array to store principle variation moves depends on searching process.
 	
-	u16 searchHistory[13][64];        	///< An array to store moves that improve alpha to be used to reduce searched nodes by increasing moves ordering.
-	s32 searchKillers[2][MAXDEPTH];     ///< An array to store moves that cut off beta to be used to reduce searched nodes by increasing moves ordering.
+	s16 searchHistory[13][64];        	///< The history of quiet moves indexed by piece and to square, moves that improve alpha gain and the other tried quiet moves lose.
+	s16 captureHistory[13][64][13];		///< The history of captures indexed by attacker, to square and victim.
+	s16 contHistory[13][64][13][64];	///< The continuation history of quiet moves indexed by the piece and to square of the move one or two plies before, then of the move itself.
+	u16 counterMoves[13][64];			///< The last quiet move that refuted a move indexed by the piece and to square of that move.
+	u16 searchKillers[2][MAXDEPTH];     ///< An array to store moves that cut off beta to be used to reduce searched nodes by increasing moves ordering.
+	s16 staticEval[MAXDEPTH];			///< The static evaluation of each ply of the current search line, -INFINITY if the side to move was in check.
+	u16 excludedMove[MAXDEPTH];			///< The move that is excluded from the search of each ply by the singular extension search.
+	u16 multiPvMoves[MAXMULTIPV];		///< The first moves of the MultiPV lines found in the current iteration, they are excluded from the root of the next lines.
+	u8 multiPvCount;					///< The number of MultiPV lines found in the current iteration.
 }S_BOARD;
 
+/// This is a struct that represents a legal move of the root position, the root list keeps them between iterations.
+typedef struct{
+	u16 move;							///< The root move.
+	s16 score;							///< The score of the move in the last iteration, -INFINITY if it failed low.
+	u64 nodes;							///< The nodes searched under the move in the last iteration.
+}S_ROOTMOVE;
+
+/// This is a struct to contain the statistics of one search, it is only collected if USE_SEARCH_STATS is defined.
+typedef struct{
+	u64 qnodes;							///< The number of quiescence nodes, the rest of nodes are main search nodes.
+	u64 iterNodes[MAXDEPTH + 1];		///< The nodes searched by each completed iteration indexed by depth.
+	u32 iterTime[MAXDEPTH + 1];			///< The time in milliseconds spent by each completed iteration indexed by depth.
+	u8 iterations;						///< The deepest completed iteration.
+	u64 ttProbes;						///< The number of hash table probes.
+	u64 ttEvals;						///< The number of static evaluations taken from the hash table instead of EvalPosition().
+	u64 nullTries;						///< The number of null-move searches.
+	u64 nullVerifies;					///< The number of verification searches of null-move cutoffs.
+	u64 nullVerifyFails;				///< The number of null-move cutoffs that failed verification.
+	u64 threatExtensions;				///< The number of nodes extended because the null move got mated.
+	u64 iidSearches;					///< The number of internal iterative deepening searches.
+	u64 iirReductions;					///< The number of nodes reduced by internal iterative reduction.
+	u64 singularSearches;				///< The number of singular extension searches.
+	u64 singularExtensions;				///< The number of hash moves extended as singular.
+	u64 multiCuts;						///< The number of nodes cut because the moves other than the hash move also fail high.
+	u64 lmrTries;						///< The number of reduced searches of late moves.
+	u64 lmrFails;						///< The number of reduced searches that failed high and had to be searched again.
+	u64 rfpCuts;						///< The number of nodes cut by reverse futility pruning.
+	u64 razorTries;						///< The number of razoring quiescence searches.
+	u64 razorCuts;						///< The number of nodes cut by razoring.
+	u64 futilityPrunes;					///< The number of quiet moves pruned by futility pruning.
+	u64 lmpPrunes;						///< The number of quiet moves pruned by late move pruning.
+}S_SEARCHSTATS;
+
 /// This is a struct to contain search information.
 typedef struct{
 	u32 starttime;						///< A variable to store the time of search starting.
 	u32 stoptime;						///< A variable to store the time of search ending.
 	u8 depth;							///< A variable to store the target depth of search (range = 1:64).
 	u8 depthset;						///< A flag to use depth as a terminator of search (TRUE or FALSE).
+	u8 rootDepth;						///< The depth of the current iteration, set by the root search.
 	u8 timeset;							///< A flag to use time as a terminator of search (TRUE or FALSE).
 	
-	u32 nodes;							///< A variable to store number of searched nodes.
+	u64 nodes;							///< A variable to store number of searched nodes.
+	u64 nodeLimit;						///< The nodes to stop the search after them (0 = no limit), set by "go nodes".
+	u8 mate;							///< The search stops when a mate in this number of moves is found (0 = off), set by "go mate".
+	
+	u16 searchMoves[MAXPOSITIONMOVES];	///< The root moves to search only, set by "go searchmoves".
+	u8 searchMovesCount;				///< The number of moves in searchMoves (0 = search all moves).
 	
 	u8 quit;							///< A flag to quit the chess engine (TRUE or FALSE).
 	u8 stopped;							///< A flag to end search (TRUE or FALSE).
 	
-	float fh;							///< A variable to store information used in caculating percentage of move ordering.
-	float fhf;							///< A variable to store information used in caculating percentage of move ordering.
+	u64 fh;								///< The number of beta cutoffs, used in caculating percentage of move ordering.
+	u64 fhf;							///< The number of beta cutoffs by the first move, used in caculating percentage of move ordering.
+	
+	u64 nullCut;				   		///< A vriable to store number of times that null-move techinque is used.
 	
-	u32 nullCut;				   		///< A vriable to store number of times that null-move techinque is used.
+#ifdef USE_SEARCH_STATS
+	S_SEARCHSTATS stats;				///< The search statistics dumped as JSON after every search.
+#endif
 	
 	u8 GAME_MODE;						///< The interface mode (UCI_MODE, XBOARD_MODE, CONSOLE_MODE)
 	u8 POST_THINKING;					///< A flag to print details of search steps (TRUE or FALSE).
@@ -331,27 +690,38 @@ typedef struct{
 // GAME MOVE 
 
 /*
- *  Move Representation:
- *  0000 0000 0000 0000 0000 0111 1111 -> From 0x7F
- *  0000 0000 0000 0011 1111 1000 0000 -> To >> 7, 0x7F
- *  0000 0000 0011 1100 0000 0000 0000 -> Captured >> 14, 0xF
- *  0000 0000 0100 0000 0000 0000 0000 -> EP 0x40000
- *  0000 0000 1000 0000 0000 0000 0000 -> Pawn Start 0x80000
- *  0000 1111 0000 0000 0000 0000 0000 -> Promoted Piece >> 20, 0xF
- *  0001 0000 0000 0000 0000 0000 0000 -> Castle 0x1000000
+ *  Move Representation (16 bits):
+ *  0000 0000 0011 1111 -> From (64 squares) 0x3F
+ *  0000 1111 1100 0000 -> To (64 squares) >> 6, 0x3F
+ *  1111 0000 0000 0000 -> Flags >> 12, 0xF
+ *
+ *  Flags:
+ *  0000 -> Quiet		0001 -> Pawn Start		0010 -> Castle
+ *  0100 -> Capture		0101 -> EP
+ *  10pp -> Promotion	11pp -> Promotion with capture, pp = 0 (Knight), 1 (Bishop), 2 (Rook), 3 (Queen)
+ *
+ *  The captured piece isn't stored in the move, it is on the to square before the move is made
+ *  and it is kept in S_UNDO after that.
  */
 
-#define FROMSQ(m)   (m & 0x7F)          ///< Returns the index of square where the piece move from
-#define TOSQ(m)     ((m >> 7) & 0x7F)   ///< Returns the index of square where the piece move to
-#define CAPTURED(m) ((m >> 14) & 0xF)   ///< Returns the type of the captured piece
-#define PROMOTED(m) ((m >> 20) & 0xF)   ///< Returns the type of piece which the pawn is promoted into
-
-#define MFLAGEP     0x40000             ///< Flag is uesd with (&) operator to check if there is EN PASSENT or not
-#define MFLAGPS     0x80000             ///< Flag is uesd with (&) operator to check if it is the first move to the pawn or not
-#define MFLAGCA     0x1000000           ///< Flag is uesd with (&) operator to check if there is CASTLING or not
-
-#define MFLAGCAP    0x7C000             ///< Flag is uesd with (&) operator to check if there is CAPTURING or not         
-#define MFLAGPRO    0xF00000            ///< Flag is uesd with (&) operator to check if there is PROMOTION or not
+#define FROM64(m)   ((m) & 0x3F)        ///< Returns the index64 of square where the piece move from
+#define TO64(m)     (((m) >> 6) & 0x3F) ///< Returns the index64 of square where the piece move to
+#define FROMSQ(m)   (Sq64ToSq120[FROM64(m)])	///< Returns the index of square where the piece move from
+#define TOSQ(m)     (Sq64ToSq120[TO64(m)])		///< Returns the index of square where the piece move to
+#define CAPTURED(pos, m) ((pos)->pieces[TOSQ(m)])		///< Returns the type of the captured piece, only before the move is made (EMPTY for en passant)
+#define PROMOTION(m) (((m) >> 12) & 0x3)	///< Returns the promotion type of a promotion move (0 = Knight, ..., 3 = Queen)
+#define PROMOTED(m, side) (((m) & MFLAGPRO) ? PromotedPce[side][PROMOTION(m)] : EMPTY)	///< Returns the type of piece which the pawn of side is promoted into
+
+#define MFLAGS      0xF000              ///< The flags field of the move
+#define MFLAGPS     0x1000              ///< Flags of the first move to the pawn (two squares)
+#define MFLAGCA     0x2000              ///< Flags of CASTLING
+#define MFLAGCAP    0x4000              ///< Flag is uesd with (&) operator to check if there is CAPTURING (en passant included) or not
+#define MFLAGEP     0x5000              ///< Flags of EN PASSENT
+#define MFLAGPRO    0x8000              ///< Flag is uesd with (&) operator to check if there is PROMOTION or not
+
+#define IsPS(m)     (((m) & MFLAGS) == MFLAGPS)	///< Returns TRUE if the move is the first move to the pawn
+#define IsCA(m)     (((m) & MFLAGS) == MFLAGCA)	///< Returns TRUE if the move is castling
+#define IsEP(m)     (((m) & MFLAGS) == MFLAGEP)	///< Returns TRUE if the move is en passant
 
 #define NOMOVE      0					///< None move constant.
 
@@ -364,6 +734,18 @@ typedef struct{
 #define CNT(b) CountBits(b)                     ///< Reurn no. of setted bits(1) in a 64 bits variable
 #define CLRBIT(bb, sq) (bb &= ~(1ULL << sq))    ///< Reset a specified bit in a 64 bits variable
 #define SETBIT(bb, sq) (bb |=  (1ULL << sq))    ///< Set a specified bit in a 64 bits variable
+#define POPCOUNT(bb) ((u8)__builtin_popcountll(bb))	///< Returns no. of setted bits(1) in a 64 bits variable using the compiler builtin
+#define LSB(bb) ((u8)__builtin_ctzll(bb))				///< Returns the index of the first setted bit from LSB to MSB, the variable must not be zero
+#define MSB(bb) ((u8)(63 - __builtin_clzll(bb)))		///< Returns the index of the first setted bit from MSB to LSB, the variable must not be zero
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CYCLES() ((u64)__builtin_ia32_rdtsc())			///< Returns the time stamp counter of the CPU, used to profile short operations
+#else
+#define CYCLES() GetTimeNs()							///< Returns the time in nanoseconds where the CPU has no time stamp counter
+#endif
+
+#define FILE_A_BB 0x0101010101010101ULL			///< The squares of file A as a 64 bits variable
+#define FILE_H_BB 0x8080808080808080ULL			///< The squares of file H as a 64 bits variable
 
 #define IsKn(p) (PieceKnight[p])                ///< Returns TRUE if the passing piece is knight
 #define IsKi(p) (PieceKing[p])                  ///< Returns TRUE if the passing piece is kings
@@ -395,10 +777,18 @@ extern const u8 PieceMaj[13];                   ///< Returns true if the piece p
 extern const u8 PieceMin[13];                   ///< Returns true if the piece passed as an index is knight or bishop
 extern const s16 PieceVal[13];                  ///< Returns the value of the piece passed as an index          
 extern const u8 PieceCol[13];                   ///< Returns the colour of the piece passed as an index
+extern const u8 PromotedPce[2][4];				///< Returns the promoted piece by passing the side and the promotion type of the move
 
 extern u8 FilesBrd[64];           		        ///< Returns the file of the square passed as an index
 extern u8 RanksBrd[64];                		    ///< Returns the rank of the square passed as an index
 
+extern u8 LmrTable[MAXDEPTH][MAXPOSITIONMOVES];	///< Late move reductions indexed by depth and move number.
+
+/// These bitboards are indexed by the square in 64 coordinates
+extern u64 KnightAttacks[64];					///< The squares attacked by a knight.
+extern u64 KingAttacks[64];						///< The squares attacked by a king.
+extern u64 RayMasks[8][64];						///< The squares of a ray to the board edge indexed by direction (north, east, north-east, north-west, south, west, south-west, south-east).
+
 extern u8 print;								///< A flag used in evalution debugging
 
 /// These arrays give an answer about a specified question by passing the type of piece as an index
@@ -418,6 +808,7 @@ extern const s8 RkDir[4];                       ///< An array contains all direc
 extern const s8 BiDir[4];                       ///< An array contains all directions that bishops can make on board.
 extern const s8 KiDir[8];                       ///< An array contains all directions that kings can make on board.
 extern S_OPTIONS EngineOptions[1];				///< A pointer to a engine options struct.
+extern S_EVALWEIGHTS EvalWeights;				///< The weights of the evaluation.
 
 #define INPUTBUFFER 400 * 6						///< Size of interrupt buffer.
 extern char interrupt_string[INPUTBUFFER];		///< Interrupt buffer to store incoming data.
@@ -432,10 +823,13 @@ extern void AllInit();							///< Initializing all used information arrays.
 extern void PrintBitBoard(u64);                 ///< Print u64 variable as board on console.
 extern u8 PopBit(u64 *bb);                      ///< Returns the index of the first setted(1) bit from LSB to MSB and resets it into 0.       
 extern u8 CountBits(u64 b);                     ///< Returns the nnumber of setted bits.
+extern u64 BishopAttacks(const u8 sq, const u64 occupied);	///< Returns the squares attacked by a bishop on the square (64) for the given occupied squares.
+extern u64 RookAttacks(const u8 sq, const u64 occupied);	///< Returns the squares attacked by a rook on the square (64) for the given occupied squares.
 
 // hashkeys.c
 extern u64 GeneratePosKey(const S_BOARD *pos);         	///< Returns a unique posKey for each board posiyions by using Piece, Side and Castle keys arrays.
 extern u64 GeneratePawnKey(const S_BOARD *pos);		   	///< Returns a unique posKey for each pawn structure.
+extern u64 GenerateMaterialKey(const S_BOARD *pos);	   	///< Returns a unique key for each material configuration.
 
 // board.c
 extern void ResetBoard(S_BOARD *pos);                  	///< Reset all contents of the board.
@@ -453,6 +847,7 @@ extern char *PrSq(const u8 sq);                      	///< Returns a pointer to
 extern char *PrMove(const s32 move);                   	///< Returns a pointer to an array of characters contained the algebraic form of move which is uesd in printing on console.
 extern void PrintMoveList(const S_MOVELIST *list);	   	///< Print moves in the passed structure.
 extern s32 ParseMove(const char *getcher, S_BOARD *pos);///< Convert move from string (e.g. e2e4) into intger move.
+extern s32 ParseSANMove(const char *ptrchar, S_BOARD *pos);///< Convert move from SAN (e.g. Nbd7) or coordinate string into intger move.
 extern char *SpePrMove(const s32 move);					///< Returns a pointer to an array of characters contained the custom algebraic form of move which is uesd in printing on console.
 
 // validate.c
@@ -464,12 +859,19 @@ extern u8 PieceValid(const u8 p);									///< Check if the given piece is valid
 extern u8 PieceValidEmpty(const u8 p);								///< Check if the given piece is a valid piece or empty or not.
 extern u8 MoveListOk(const S_MOVELIST *list, const S_BOARD *pos);	///< Check if the given list of moves is vaild or not.
 extern u8 MoveValid(const s32 move, const S_BOARD *pos);			///< Check if the given move is valid or not.
-extern void DebugAnalysisTest(S_BOARD *pos, S_SEARCHINFO *info);	///< This function is used to make a performance test for the chess engine thinking.
+/// Search the positions of an EPD test suite concurrently and print a report, returns the number of failed positions.
+extern s32 DebugAnalysisTest(const char *fileName, const s32 time, const u8 workers, const u8 format, const char *reportName);
 extern void MirrorEvalTest(S_BOARD *pos);							///< This function is used to check the performace of EvalPosition().
 extern void DebugSEETest(S_BOARD *pos);								///< This function is used to check the performace of SEE().
 extern u8 CapturesListOk(const S_MOVELIST *list, const S_BOARD *pos);///< Check if the given list of capture moves is valid or not.
 extern void CheckFen(S_BOARD *pos);									///< Check if the given FEN is valid or not.
-extern void DebugPerftTest(S_BOARD *pos);							///< Used for test some pre-calculated cases.
+extern void DebugBench(S_BOARD *pos, const u8 depth, const u8 compare);	///< Search the bench positions to a fixed depth and report nodes and time-to-depth.
+/// Run the positions of a perft test suite concurrently and print a report, returns the number of failed positions.
+extern s32 DebugPerftTest(const char *fileName, const u8 threads, const u8 maxDepth, const u8 format, const char *reportName);
+/// Check the evaluation of the registered endings on the positions of an EPD file, returns the number of failed positions.
+extern s32 DebugEndgameTest(S_BOARD *pos, const char *fileName);
+/// Measure the evaluations per second on the positions of an EPD file for every instruction set of the piece square sums and profile the terms.
+extern s32 DebugEvalBench(S_BOARD *pos, const char *fileName, const u32 iterations);
 
 // movege.c
 extern void GenerateAllMoves(const S_BOARD *pos, S_MOVELIST *list); ///< Generates all possible moves without filterating.
@@ -477,6 +879,7 @@ extern void GenerateAllCaps(const S_BOARD *pos, S_MOVELIST *list);	///< Generate
 extern u8 MoveExists(S_BOARD *pos, const s32 move);  				///< Check if the given move exists on the current board or not.
 // extern void InitMvvLva();
 extern void GenerateMovesForLocation(const S_BOARD *pos, S_MOVELIST *list, const u8 sq); ///< Generates all possible moves for a given piece on a square on board without filterating.
+extern s32 QuietHistory(const S_BOARD *pos, const s32 move);		///< Returns the history and continuation history score of a quiet move.
 
 // makemove.c
 extern void UnMakeMove(S_BOARD *pos);								///< Undo the last move and return to the previos move using history structure.			
@@ -486,15 +889,18 @@ extern void UnMakeNullMove(S_BOARD *pos);							///< Undo the last null-move and
 
 // perft.c
 extern u64 PerftTest(const u8 depth, S_BOARD *pos);					///< Counts all the leaf nodes of a certan depth.
+extern u64 Perft(const u8 depth, S_BOARD *pos);						///< Counts all the leaf nodes of a certan depth silently.
 extern s32 SEETest(const S_BOARD *pos);								///< Used for SEE testing.
 
 // search.c
-extern s32 SearchDebug(S_BOARD *pos, S_SEARCHINFO *info, s8 *moveTo, u8 am);///< Used for test some pre-calculated cases.
+extern s32 SearchDebug(S_BOARD *pos, S_SEARCHINFO *info, S_EPDJOB *job);///< Used for test some pre-calculated cases.
 extern void SearchPosition(S_BOARD *pos, S_SEARCHINFO *info);		///< Search for the best move for the given position.
 extern u8 GetGamePhase(const S_BOARD *pos);							///< Return the current phase game.
+extern void ClearHistory(S_BOARD *pos);								///< Wipe the move ordering tables for a new game.
 
 // misc.c
 extern s32 GetTimeMs();                            	   				///< Returns the current time in millisecodes
+extern u64 GetTimeNs();												///< Returns the time of a monotonic clock in nanoseconds, used to time short operations
 extern void ReadInput(S_SEARCHINFO *info);			   				///< Check if engine is interrupted or not and store check in info sturcture
 extern void SetColor(s32 ForgC);					   				///< Setup console font color
 
@@ -503,12 +909,18 @@ extern void SetColor(s32 ForgC);					   				///< Setup console font color
 extern void InitHashTable(S_HASHTABLE *table, const u8 MB);
 /// Allocate memory for evaluation tables.
 extern void InitEvalTable(S_EVALTABLE *table, const u8 MB_PAWN, const u8 MB_EVAL);
-/// Free all allocated memory of hash tables, evaluation tables and memory used for opening book
+/// Free all allocated memory of hash tables, evaluation tables and memory used for opening book and tablebases
 extern void CleanMemory(S_HASHTABLE *hashTable, S_EVALTABLE *evalTable);
+/// Free all allocated memory of hash tables and evaluation tables.
+extern void FreeTables(S_HASHTABLE *hashTable, S_EVALTABLE *evalTable);
 /// Clear all the entries of the hash table to ensure thers is no garbage.
 extern void ClearHashTable(S_HASHTABLE *table);
+/// Clear all the entries of the evaluation tables to ensure thers is no garbage.
+extern void ClearEvalTable(S_EVALTABLE *table);
 /// Store a hash entry in the two hash tables.
-extern void StoreHashEntry(S_BOARD *pos, const s32 move, s16 score, const u8 flag, const u8 depth);
+extern void StoreHashEntry(S_BOARD *pos, s32 move, s16 score, const s16 eval, const u8 flag, const u8 depth);
+/// Returns the deepest hash entry stored for a given position.
+extern S_HASHENTRY *GetHashEntry(const S_BOARD *pos);
 /// Returns the pv move stored in hash tables for a given position.
 extern s32 ProbePvTable(const S_BOARD *pos);
 /// Returns a thinking line depends on prinsiple variation moves
@@ -517,19 +929,62 @@ extern u8 GetPvLine(const u8 depth, S_BOARD *pos);
 extern u8 ProbeHashEntry(S_BOARD *pos, s32 *move, s16 *score, const s16 alpha, const s16  beta, const u8 depth);
 /// Probe an evaluation entry in the evaluation tables and returns entry information of a given position.
 extern u8 ProbeEval(S_BOARD *pos, s16 *eval);
-/// Probe a pawn structure evaluation entry in the pawn structure tables and returns entry information of a given position.
-extern u8 ProbePawnEval(S_BOARD *pos, s8 *whiteStructure, s8 *blackStructure, u16 *passers);
+/// Probe a pawn structure entry in the pawn structure tables and returns the entry of a given position.
+extern u8 ProbePawnEval(S_BOARD *pos, S_PAWNENTRY **entry);
 /// Store the pawn structure evaluation value of a given position.
 extern void StoreEval(S_BOARD *pos, s16 eval);
-/// Store the evaluation value of a given position.
-extern void StorePawnEval(S_BOARD *pos, s8 whiteStructure, s8 blackStructure, u16 passers);
+/// Mark a filled pawn structure entry as the entry of a given position.
+extern void StorePawnEval(S_BOARD *pos, S_PAWNENTRY *entry);
+/// Probe a material entry in the material table and returns the entry of a given position.
+extern u8 ProbeMaterial(S_BOARD *pos, S_MATERIALENTRY **entry);
+/// Mark a filled material entry as the entry of a given position.
+extern void StoreMaterial(S_BOARD *pos, S_MATERIALENTRY *entry);
 
 // evaluate.c
 extern s16 EvalPosition(S_BOARD *pos);								///< Caculate the total evaluation value for a given board position.
 extern s8 EvalMove(const S_BOARD *pos, const u8 from, const u8 to);	///< Caculate the evaluation value for a given move depends on piece positions.
+extern void SetEvalTrace(float *trace);								///< Set the trace that the evaluations of the calling thread add the coefficients of the weights to.
+extern void InitPieceSquare();										///< Build the piece square table of every piece from the weights, it must be called whenever the weights change.
+extern u8 SetEvalSimd(const u8 simd);								///< Select the best instruction set up to the given one for the piece square sums, returns the one that is used.
+extern const char *const EvalSimdNames[];							///< The names of the instruction sets of the piece square sums, indexed by SIMD_*.
+extern void SetEvalProfile(u64 *profile);							///< Set the profile that the evaluations of the calling thread add the cycles of each group of terms to.
+extern const char *const EvalProfileNames[];						///< The names of the groups of terms of the evaluation profile, indexed by EVAL_PROF_*.
+
+// tablebase.c
+extern S_TBTABLE Tablebases[];										///< All endgame tablebases ordered so that every table comes after the tables it converts into.
+extern const u8 TablebasesNum;										///< The number of endgame tablebases.
+extern void InitTablebases(const char *path);						///< Map the tablebase files found in the directory.
+extern u8 TBFileName(char *name, const char *path, const char *code, const char *extension);	///< Write the name of a tablebase file, returns FALSE if it doesn't fit TB_NAME_SIZE.
+extern void CleanTablebases();										///< Unmap the tablebase files.
+extern S_TBTABLE *TBLookup(const u8 *pieces, const u8 *squares, const u8 count, const u8 side, u32 *index);	///< Find the tablebase of a set of pieces and the index of the position in it.
+extern u32 TBFileIndex(const S_TBTABLE *table, const u32 index);		///< Returns the index of a position in the files of a tablebase, reduced by the symmetry of the board.
+extern u8 TBRead(const S_TBTABLE *table, const u32 index, const u8 dtm);	///< Returns the win/draw/loss value or the distance to mate code of a position in a tablebase.
+extern u8 ProbeWDL(const S_BOARD *pos, s8 *wdl);					///< Probe the win/draw/loss value of a position, returns FALSE if there is no tablebase for it.
+extern s32 ProbeRootDTM(S_BOARD *pos, s16 *score);					///< Returns the move of perfect play by the distance to mate tablebases, NOMOVE if there is no tablebase.
+
+// tbgen.c
+/// Generate the tablebases of the given codes (all if none) and write their files in the directory, returns the number of failed tables.
+extern s32 GenerateTablebases(const char *path, const u8 threads, char **codes, const u8 count);
+
+// tune.c
+extern u8 LoadEvalWeights(const char *fileName);					///< Load the evaluation weights from a file, returns FALSE if it can't be read or isn't valid.
+extern u8 SaveEvalWeights(const char *fileName);					///< Save the evaluation weights to a file, returns FALSE if it can't be written.
+/// Tune the evaluation weights by the labelled positions of a file, returns the number of epochs done or -1 if the positions can't be read.
+extern s32 TuneEvaluation(const char *fileName, const u8 threads, const u32 epochs, const char *output);
+
+// bitbase.c
+extern void InitKPKBitbase();										///< Generate the KPK bitbase.
+extern u8 ProbeKPK(const S_BOARD *pos);								///< Returns TRUE if the side of the pawn wins a position of king and pawn against king.
+
+// endgame.c
+extern void InitEndgames();											///< Compute the material keys of the registered endings.
+extern u64 EndgameMaterialKey(const char *code, const u8 strong);	///< Returns the material key of an ending code (e.g. "KRKP") for a given winning side.
+extern void SetEndgame(const S_BOARD *pos, S_MATERIALENTRY *entry);	///< Set the evaluation function and scale factor of a material entry if its ending is registered.
 
 // uci.c
 extern void UCI_Loop(S_BOARD *pos, S_SEARCHINFO *info);				///< This function handles some commands of UCI protocol in addition to some custom commands.
+extern u8 SetEngineOption(const char *name, const char *value);		///< Set an engine option by its name, returns TRUE if the option exists and the value is valid.
+extern void PrintEngineOptions(const u8 mode);						///< Print all engine options in UCI or console form.
 
 // xboard.c
 extern void XBoard_Loop(S_BOARD *pos, S_SEARCHINFO *info);			///< This function handles some commands of XBoard protocol.
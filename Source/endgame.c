@@ -0,0 +1,244 @@
+/**
+ * @file endgame.c
+ * This file handles the specialized evaluation of some known endings.
+ *
+ * Some material configurations (e.g. KBNK, KRKP) are evaluated badly by the general
+ * evaluation, so they have their own evaluation functions. Every ending in the registry
+ * is found by its material key, and its evaluation function and/or scale factor are
+ * saved in the material entry of the configuration, so the lookup is done only once
+ * per material configuration.
+ *
+ * I have used ideas from the open source engines Glaurung and Stockfish here.
+ *
+ * @author Tarek Elmenshawy (tarek.elmenshawy1997@gmail.com)
+ * Date: April 2020
+ */
+
+#include"defs.h"
+#include"string.h"
+
+/// Returns the square (64) from the side's point of view, i.e. the board is flipped for black.
+#define RELATIVE_SQ(side, sq) ((side) == WHITE ? (sq) : (sq) ^ 56)
+
+/// Drives the losing king to the edge of the board, used to mate with a queen or a rook.
+static const u8 PushToEdge[64] = {
+	100, 90, 80, 70, 70, 80, 90, 100,
+	 90, 70, 60, 50, 50, 60, 70,  90,
+	 80, 60, 40, 30, 30, 40, 60,  80,
+	 70, 50, 30, 20, 20, 30, 50,  70,
+	 70, 50, 30, 20, 20, 30, 50,  70,
+	 80, 60, 40, 30, 30, 40, 60,  80,
+	 90, 70, 60, 50, 50, 60, 70,  90,
+	100, 90, 80, 70, 70, 80, 90, 100
+};
+
+/// Drives the losing king to a corner of the dark squares (a1 or h8), used to mate with bishop and knight.
+static const u8 PushToCorner[64] = {
+	200, 190, 180, 170, 160, 150, 140, 130,
+	190, 180, 170, 160, 150, 140, 130, 140,
+	180, 170, 155, 140, 140, 125, 140, 150,
+	170, 160, 140, 120, 110, 140, 150, 160,
+	160, 150, 140, 110, 120, 140, 160, 170,
+	150, 140, 125, 140, 140, 155, 170, 180,
+	140, 130, 140, 150, 160, 170, 180, 190,
+	130, 140, 150, 160, 170, 180, 190, 200
+};
+
+/// Brings the winning king close to the losing king, indexed by the distance between them.
+static const u8 PushClose[8] = {0, 0, 100, 80, 60, 40, 20, 10};
+
+/// Returns the distance between two squares (64) in king moves.
+static u8 Distance(const u8 sq1, const u8 sq2){
+	u8 files = abs(FilesBrd[sq1] - FilesBrd[sq2]);
+	u8 ranks = abs(RanksBrd[sq1] - RanksBrd[sq2]);
+	return files > ranks ? files : ranks;
+}
+
+/// Returns the side with more material, it is the side that plays for a win in the registered endings.
+static u8 StrongSide(const S_BOARD *pos){
+	return pos->material[WHITE] > pos->material[BLACK] ? WHITE : BLACK;
+}
+
+/**
+ * Evaluates a bare king against a queen or a rook (and maybe more material),
+ * the winning side pushes the losing king to the edge and brings its own king close.
+ *
+ * @param pos The position's pointer.
+ * @return The evaluation from white's point of view.
+ */
+static s16 EvalKXK(const S_BOARD *pos){
+
+	u8 strong = StrongSide(pos);
+	u8 strongKing = SQ64(pos->kingSq[strong]);
+	u8 weakKing = SQ64(pos->kingSq[strong ^ 1]);
+
+	s16 score = KNOWN_WIN + pos->material[strong] - pos->material[strong ^ 1]
+			  + PushToEdge[weakKing] + PushClose[Distance(strongKing, weakKing)];
+
+	return strong == WHITE ? score : -score;
+}
+
+/**
+ * Evaluates king, bishop and knight against a bare king, the losing king is
+ * pushed to a corner of the same color of the bishop.
+ *
+ * @param pos The position's pointer.
+ * @return The evaluation from white's point of view.
+ */
+static s16 EvalKBNK(const S_BOARD *pos){
+
+	u8 strong = StrongSide(pos);
+	u8 strongKing = SQ64(pos->kingSq[strong]);
+	u8 weakKing = SQ64(pos->kingSq[strong ^ 1]);
+	u8 bishop = SQ64(pos->pList[wB + strong * (bP - wP)][0]);
+	u8 corner = weakKing;
+
+	// PushToCorner[] is for a dark squared bishop, mirror the files for a light one
+	if((FilesBrd[bishop] + RanksBrd[bishop]) & 1) corner ^= 7;
+
+	s16 score = KNOWN_WIN + pos->material[strong] - pos->material[strong ^ 1]
+			  + PushClose[Distance(strongKing, weakKing)] + PushToCorner[corner];
+
+	return strong == WHITE ? score : -score;
+}
+
+/**
+ * Evaluates king and pawn against king by the KPK bitbase, a won position is scored
+ * by the advance of the pawn and a drawn position is 0.
+ *
+ * @param pos The position's pointer.
+ * @return The evaluation from white's point of view.
+ */
+static s16 EvalKPK(const S_BOARD *pos){
+
+	if(!ProbeKPK(pos)) return 0;
+
+	u8 strong = StrongSide(pos);
+	u8 pawn = RELATIVE_SQ(strong, SQ64(pos->pList[wP + strong * (bP - wP)][0]));
+	s16 score = KNOWN_WIN + PieceVal[wP] + 20 * RanksBrd[pawn];
+
+	return strong == WHITE ? score : -score;
+}
+
+/**
+ * Evaluates king and rook against king and pawn, the position is seen from the
+ * side of the rook (i.e. the pawn moves down the board).
+ *
+ * @param pos The position's pointer.
+ * @return The evaluation from white's point of view.
+ */
+static s16 EvalKRKP(const S_BOARD *pos){
+
+	u8 strong = StrongSide(pos);
+	u8 strongToMove = (pos->side == strong);
+	u8 strongKing = RELATIVE_SQ(strong, SQ64(pos->kingSq[strong]));
+	u8 weakKing = RELATIVE_SQ(strong, SQ64(pos->kingSq[strong ^ 1]));
+	u8 rook = RELATIVE_SQ(strong, SQ64(pos->pList[wR + strong * (bP - wP)][0]));
+	u8 pawn = RELATIVE_SQ(strong, SQ64(pos->pList[bP - strong * (bP - wP)][0]));
+	u8 queening = SQ64(FR2SQ(FilesBrd[pawn], RANK_1));
+	u8 push = pawn - 8;
+	s16 score;
+
+	if(FilesBrd[strongKing] == FilesBrd[pawn] && RanksBrd[strongKing] < RanksBrd[pawn]){
+		// The winning king is in front of the pawn
+		score = PieceVal[wR] - Distance(strongKing, pawn);
+	}else if(Distance(weakKing, pawn) >= 3 + !strongToMove && Distance(weakKing, rook) >= 3){
+		// The losing king is too far from the pawn and the rook
+		score = PieceVal[wR] - Distance(strongKing, pawn);
+	}else if(RanksBrd[weakKing] <= RANK_3 && Distance(weakKing, pawn) == 1 && RanksBrd[strongKing] >= RANK_4 && Distance(strongKing, pawn) > 2 + strongToMove){
+		// The pawn is far advanced and supported by its king while the winning king is far away
+		score = 80 - 8 * Distance(strongKing, pawn);
+	}else{
+		score = 200 - 8 * (Distance(strongKing, push) - Distance(weakKing, push) - Distance(pawn, queening));
+	}
+
+	return strong == WHITE ? score : -score;
+}
+
+/// The registered endings, the code is the pieces of the winning side then the pieces of the losing side.
+static const S_ENDGAME Endgames[] = {
+	{"KQK",  EvalKXK,  100},
+	{"KRK",  EvalKXK,  100},
+	{"KBNK", EvalKBNK, 100},
+	{"KPK",  EvalKPK,  100},
+	{"KRKP", EvalKRKP, 100},
+	{"KRKB", NULL,      25},
+	{"KRKN", NULL,      25},
+};
+
+#define ENDGAMES_NUM (sizeof(Endgames) / sizeof(S_ENDGAME))	///< The number of the registered endings.
+
+/// The material keys of the registered endings, [WHITE] when white is the winning side and [BLACK] when black is.
+static u64 EndgameKeys[ENDGAMES_NUM][2];
+
+/**
+ * Returns the material key of an ending code (e.g. "KRKP") for a given winning side,
+ * it is the same key that GenerateMaterialKey() returns for a position of that ending.
+ *
+ * @param code The ending code.
+ * @param strong The winning side.
+ * @return The material key.
+ */
+u64 EndgameMaterialKey(const char *code, const u8 strong){
+
+	const char *pieces = "PNBRQK";
+	u8 count[13] = {0};
+	u8 side = strong ^ 1, piece;
+	u64 key = 0ULL;
+
+	for(; *code != '\0'; code++){
+		// Every king starts the pieces of a side
+		if(*code == 'K') side ^= 1;
+		piece = wP + (strchr(pieces, *code) - pieces) + side * (bP - wP);
+		key ^= PieceKeys[piece][count[piece]++];
+	}
+
+	return key;
+}
+
+/**
+ * Computes the material keys of the registered endings, it must be called after the
+ * piece keys are initialized.
+ */
+void InitEndgames(){
+
+	u8 i;
+
+	for(i = 0; i < ENDGAMES_NUM; i++){
+		EndgameKeys[i][WHITE] = EndgameMaterialKey(Endgames[i].code, WHITE);
+		EndgameKeys[i][BLACK] = EndgameMaterialKey(Endgames[i].code, BLACK);
+	}
+}
+
+/**
+ * Looks up the material configuration of the position in the registered endings and sets
+ * the evaluation function and the scale factor of its material entry if it is found.
+ *
+ * A bare king against a queen or a rook (with any other material) is evaluated by EvalKXK().
+ *
+ * @param pos The position's pointer.
+ * @param entry The material entry of the position.
+ */
+void SetEndgame(const S_BOARD *pos, S_MATERIALENTRY *entry){
+
+	u8 i, side;
+
+	entry->evaluate = NULL;
+
+	for(i = 0; i < ENDGAMES_NUM; i++){
+		for(side = WHITE; side <= BLACK; side++){
+			if(pos->materialKey == EndgameKeys[i][side]){
+				entry->evaluate = Endgames[i].evaluate;
+				entry->scale[side] = Endgames[i].scale;
+				return;
+			}
+		}
+	}
+
+	for(side = WHITE; side <= BLACK; side++){
+		if(pos->material[side ^ 1] == 0 && (pos->pceNum[wQ + side * (bP - wP)] || pos->pceNum[wR + side * (bP - wP)])){
+			entry->evaluate = EvalKXK;
+			return;
+		}
+	}
+}
@@ -7,62 +7,76 @@
  */
 
 #include"defs.h"
+#include"string.h"
+
+#ifdef USE_SIMD
+	#include"immintrin.h"
+#endif
 
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))		///< Retuens the maximun number
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))		///< Retuens the minimum number
 
-#define COUNT_BIT         	 7					///< Count mask of WB/BB.
-#define PAWN_BIT       	     8					///< Pawn mask of WB/BB.
-#define MINOR_BIT        	16					///< Minor mask of WB/BB.
-#define ROOK_BIT         	32					///< Rook mask of WB/BB.
-#define QUEEN_BIT        	64					///< Queen mask of WB/BB.
-#define KING_BIT           128					///< King mask of WB/BB.
-#define ATTACKERS_MASK   	31					///< Attackers mask of KING_ATTACK_PATTERN.
-
-#define QUEEN_VALUE  	   975					///< Evaluation value of queen.
-#define ROOK_VALUE 		   500					///< Evaluation value of rook.
-#define BISHOP_VALUE  	   325					///< Evaluation value of bishop.
-#define KNIGHT_VALUE  	   325					///< Evaluation value of knight.
-#define PAWN_VALUE  	   100					///< Evaluation value of pawn.
-
-// Evaluation constants
-#define PINNED_PIECE  		20					///< Evaluation value (bonus) of the pinned piece.
-#define PASSED_PAWN  		20					///< Evaluation value (bonus) of the passed pawn.
-#define DOUBLED_PAWN  		10					///< Evaluation value (bonus) of the doubled pawn.
-#define ISOLATED_PAWN  		20					///< Evaluation value (bonus) of the isolated pawn.
-#define WEAK_PAWN  			15					///< Evaluation value (bonus) of the weak pawn.
-#define ROOK_ON_SEVENTH  	20					///< Evaluation value (bonus) of the rook is on 7th or 2nd rank.
-#define ROOK_BEHIND_PASSER  15					///< Evaluation value (bonus) of the rook is behind passers.
-#define QUEEN_ON_SEVENTH  	10					///< Evaluation value (bonus) of the queen is on 7th or 2nd rank.
-#define ROOK_ON_OPEN  		20					///< Evaluation value (bonus) of the rook is on open file.
-#define ROOK_ON_SEMI  		15					///< Evaluation value (bonus) of the rook is on semi-open file (with only enemy pawns).
-#define HUNG_PIECE_PENALTY  80					///< Evaluation value (bonus) of the penalty of hung piece.
-#define BISHOP_PAIR  		50					///< Evaluation value (bonus) of the bishop pair.
-#define TEMPO  				10					///< Evaluation value (bonus) of the tempo in opening and middel phase.
+#define ATTACK_PAWN			 0					///< Index of the pawn attacks in AttackMap.
+#define ATTACK_MINOR		 1					///< Index of the minor (knight or bishop) attacks in AttackMap.
+#define ATTACK_ROOK			 2					///< Index of the rook attacks in AttackMap.
+#define ATTACK_QUEEN		 3					///< Index of the queen attacks in AttackMap.
+#define ATTACK_KING			 4					///< Index of the king attacks in AttackMap.
+#define ATTACK_ALL			 5					///< Index of the squares attacked by any piece in AttackMap.
+#define ATTACK_TWICE		 6					///< Index of the squares attacked by two pieces or more in AttackMap.
+
+#define PAWN_PUSH(side, bb) ((side) == WHITE ? (bb) << 8 : (bb) >> 8)	///< Moves the squares of the bitboard one rank forward for the side.
+
+/// Adds the middle game and ending coefficients of the weight at the address (in EvalWeights) to the trace of the evaluation, only if the evaluation is traced for the tuner.
+#define TRACE_AT(address, mg, eg) (EvalTrace != NULL ? (void)(EvalTrace[2 * ((address) - (S_SCORE *) &EvalWeights)] += (mg), \
+												EvalTrace[2 * ((address) - (S_SCORE *) &EvalWeights) + 1] += (eg)) : (void)0)
+
+/// Adds the cycles since the last mark of the evaluation to a group of terms of the profile and marks the time, only if the evaluation is profiled.
+#define PROFILE(group) (EvalProfile != NULL ? (void)(EvalProfile[group] -= profileTime, profileTime = CYCLES(), EvalProfile[group] += profileTime) : (void)0)
+
+/// Adds the coefficient of a weight to the trace of the evaluation.
+#define TRACE(weight, coef) TRACE_AT(&EvalWeights.weight, coef, coef)
+
+/// Adds different middle game and ending coefficients of a weight to the trace of the evaluation.
+#define TRACE_PAIR(weight, mg, eg) TRACE_AT(&EvalWeights.weight, mg, eg)
+
+#define SIGN(side) ((side) == WHITE ? 1 : -1)	///< The sign of the evaluation terms of the side, the evaluation is from white's point of view.
+
+#define FLIP(bb) __builtin_bswap64(bb)			///< Mirrors the squares of a bitboard (MIRROR64() of every square), the ranks are its bytes.
 
 /*
- *  Index [0 : 63] -> square on board
- *  Bit Field Representation od WB/BB arrays:
- *  0000 0111 -> Number of attackers to this square >> 7
- *  0000 1000 -> Pawn attacks this square >> 8
- *  0001 0000 -> Minor (knught or bishop) attack this square >> 16
- *  0010 0000 -> Rook attacks this square >> 32
- *  0100 0000 -> Queen attacks this square >> 64
- *  1000 0000 -> King attacks this square >> 128
+ *  The attack maps are filled by EvalPosition() before the pieces are evaluated, they are indexed
+ *  by the side and by ATTACK_PAWN ... ATTACK_TWICE. The piece type indices match the columns of
+ *  KING_ATTACK_PATTERN, and ATTACK_TWICE replaces the attackers count of the old byte arrays since
+ *  the evaluation only asks whether a square is attacked once or more.
  *
+ *  The sliders see through their own sliders that move in the same direction (x-ray), so a battery
+ *  attacks the squares behind its front piece too.
  */
-static u8 WB[64] = {0};						///< Bit field attacked squares on white board.
-static u8 BB[64] = {0};						///< Bit field attacked squares on black board.
-static u8 wPPos[10];
-static u8 bPPos[10];
-static u16 passers;
+static THREAD_LOCAL u64 AttackMap[2][7];		///< The squares attacked by each side indexed by ATTACK_*.
+static THREAD_LOCAL u64 PieceBB[13];			///< The squares of every piece type, filled from the piece lists.
+static THREAD_LOCAL u64 Occupied[3];			///< The squares occupied by white, black and both.
 
-static const u8 FILE_TO_BIT_MASK[8] = {1,2,4,8,16,32,64,128};
+/// The ranks where an unprotected pawn can be weak for each side, the pawn moved atleast two ranks
+static const u64 WEAK_PAWN_RANKS[2] = {0xFFFFFFFFFF000000ULL, 0x000000FFFFFFFFFFULL};
 
-static u8 w_bestPromDist;
-static u8 b_bestPromDist;
+static THREAD_LOCAL u8 w_bestPromDist;
+static THREAD_LOCAL u8 b_bestPromDist;
 
-static s16 gamePhase;
+static THREAD_LOCAL u8 gamePhase;
+
+static THREAD_LOCAL float *EvalTrace;			///< The coefficients of the weights in the evaluation, NULL if it isn't traced.
+static THREAD_LOCAL u64 *EvalProfile;			///< The cycles spent in each group of terms of the evaluation (EVAL_PROF_*), NULL if it isn't profiled.
+
+static S_SCORE PieceSquare[13][64];			///< The piece square score of every piece (EMPTY too) by square from white's point of view, filled by InitPieceSquare().
+
+static S_SCORE PieceSquareScalar(const S_BOARD *pos);
+static S_SCORE (*PieceSquareSum)(const S_BOARD *pos) = PieceSquareScalar;	///< The piece square sums of the instruction set selected by SetEvalSimd().
+
+const char *const EvalSimdNames[SIMD_NUM] = {"scalar", "avx2"};
+
+const char *const EvalProfileNames[EVAL_PROF_NUM] = {
+	"material", "pawns", "piece squares", "trapped", "passers", "attacks", "king attack/defense", "hung pieces", "draw adjustment"
+};
 
 
 /* The following pos The position's pointers should be read as follow:
@@ -77,149 +91,169 @@ static s16 gamePhase;
    a8,  b8,  c8,  d8,  e8,  f8,  g8,  h8,
 */
 
-/// Positioning of the knights
-static const s16 wN_POS[] = {		
-	-50	, -40, -30, -25, -25, -30, -40, -50,		
-	-35	, -25, -15, -10, -10, -15, -25, -35,	
-	-20	, -10,   0,   5,   5,   0, -10, -20,	
-	-10	,   0,  10,  15,  15,  10,   0, -10,	
-	-5	,   5,  15,  20,  20,  15,   5,  -5,		
-	-5	,   5,  15,  20,  20,  15,   5,  -5,	
-	-20	, -10,   0,   5,   5,   0, -10, -20,	
-	-135, -25, -15, -10, -10, -15, -25,-135
-};
-
-static const s8 KNIGHT_POS_ENDING[] = {
-	-10,  -5,  -5,  -5,  -5,  -5,  -5, -10,    
-	-5,   0,   0,   0,   0,   0,   0,  -5,    
-	-5,   0,   5,   5,   5,   5,   0,  -5,    
-	-5,   0,   5,  10,  10,   5,   0,  -5,    
-	-5,   0,   5,  10,  10,   5,   0,  -5,    
-	-5,   0,   5,   5,   5,   5,   0,  -5,    
-	-5,   0,   0,   0,   0,   0,   0,  -5,    
-	-10,  -5,  -5,  -5,  -5,  -5,  -5, -10
-};
-
-/// Positioning of the bishops
-static const s8 wB_POS[] = {
-   -20, -15, -15, -13, -13, -15, -15, -20,    
-	-5,   0,  -5,   0,   0,  -5,   0,  -5,    
-	-6,  -2,   4,   2,   2,   4,  -2,  -6,    
-	-4,   0,   2,  10,  10,   2,   0,  -4,    
-	-4,   0,   2,  10,  10,   2,   0,  -4,    
-	-6,  -2,   4,   2,   2,   4,  -2,  -6,    
-	-5,   0,  -2,   0,   0,  -2,   0,  -5,    
-	-8,  -8,  -6,  -4,  -4,  -6,  -8,  -8
-};
-
-static const s8 BISHOP_POS_ENDING[] = {
-	-18, -12,  -9,  -6,  -6,  -9, -12, -18,   
-	-12,  -6,  -3,   0,   0,  -3,  -6, -12,   
-	 -9,  -3,   0,   3,   3,   0,  -3,  -9,   
-	 -6,   0,   3,   6,   6,   3,   0,  -6,   
-	 -6,   0,   3,   6,   6,   3,   0,  -6,   
-	 -9,  -3,   0,   3,   3,   0,  -3,  -9,   
-	-12,  -6,  -3,   0,   0,  -3,  -6, -12,   
-	-18, -12,  -9,  -6,  -6,  -9, -12, -18
-};
-
-
-static const s8 wR_POS[] = {
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6,    
-	-6,   -3,   0,   3,   3,   0,   -3,   -6
-};
-
-static const s8 ROOK_POS_ENDING[] = {
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0
-};
-
-static const s8 wQ_POS[] = {
-  -10, -10, -10, -10, -10, -10, -10, -10,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0
-};
-
-static const s8 QUEEN_POS_ENDING[] = {
-	-24, -16, -12,  -8,  -8, -12, -16, -24,    
-	-16,  -8,  -4,   0,   0,  -4,  -8, -16,    
-	-12,  -4,   0,   4,   4,   0,  -4, -12,    
-	 -8,   0,   4,   8,   8,   4,   0,  -8,    
-	 -8,   0,   4,   8,   8,   4,   0,  -8,    
-	-12,  -4,   0,   4,   4,   0,  -4, -12,    
-	-16,  -8,  -4,   0,   0,  -4,  -8, -16,    
-	-24, -16, -12,  -8,  -8, -12, -16, -24
-};
-
-/// Positioning of the pawns
-static const s8 wP_POS[] = {
-	-15,   -5,   0,   5,   5,   0,   -5,   -15,    
-	-15,   -5,   0,   5,   5,   0,   -5,   -15,    
-	-15,   -5,   0,  15,  15,   0,   -5,   -15,    
-	-15,   -5,   0,  25,  25,   0,   -5,   -15,    
-	-15,   -5,   0,  15,  15,   0,   -5,   -15,    
-	-15,   -5,   0,   5,   5,   0,   -5,   -15,    
-	-15,   -5,   0,   5,   5,   0,   -5,   -15,    
-	-15,   -5,   0,   5,   5,   0,   -5,   -15
+/// The weights of the evaluation, they can be replaced by a weights file (see tune.c).
+S_EVALWEIGHTS EvalWeights = {
+	
+	// The pawns are worth a bit extra in the ending
+	.pieceValue = {SCORE( 100, 120), SCORE( 325, 325), SCORE( 325, 325), SCORE( 500, 500), SCORE( 975, 975)},
+	.bishopPair = SCORE(  50,  50),
+	
+	// Pawn structure
+	.doubledPawn = SCORE(  10,  10),
+	.isolatedPawn = SCORE(  20,  20),
+	.weakPawn = SCORE(  15,  15),
+	.passedRank = {
+		SCORE(   0,   0), SCORE(   5,  10), SCORE(  10,  20), SCORE(  20,  40), SCORE(  30,  60), SCORE(  60, 120), SCORE(  75, 150), SCORE(   0,   0)
+	},
+	.unstoppablePasser = SCORE( 600, 600),
+	
+	/// Marks the outpost squares for knight, do not put outpost values
+	/// on the edges since we check for protecting pawns without checking out of the board
+	.knightOutpost = {
+		SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   2,   2), SCORE(   5,   5), SCORE(  10,  10), SCORE(  10,  10), SCORE(   5,   5), SCORE(   2,   2), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   2,   2), SCORE(   5,   5), SCORE(  10,  10), SCORE(  10,  10), SCORE(   5,   5), SCORE(   2,   2), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   0,   0), SCORE(   4,   4), SCORE(   5,   5), SCORE(   5,   5), SCORE(   4,   4), SCORE(   0,   0), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0),
+		SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0)
+	},
+	
+	.rookOnOpen = SCORE(  20,  20),
+	.rookOnSemi = SCORE(  15,  15),
+	.rookOnSeventh = SCORE(  20,  20),
+	.rookBehindPasser = SCORE(  15,  15),
+	.queenOnSeventh = SCORE(  10,  10),
+	
+	// Mobility
+	.pinnedPiece = SCORE(  20,  20),
+	.mobility = SCORE(   1,   1),
+	.mobilitySafe = SCORE(   2,   2),
+	.lowMobility = SCORE(   5,   5),
+	
+	/// The closer the piece is to the opponent's king the better,
+	/// knights score higher than bishops since bishops can attack from afar as well
+	.tropism = {
+		{
+			SCORE(   0,   0), SCORE(   3,   3), SCORE(   3,   3), SCORE(   2,   2), SCORE(   1,   1), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0)
+		},
+		{
+			SCORE(   0,   0), SCORE(   2,   2), SCORE(   2,   2), SCORE(   1,   1), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0)
+		},
+		{
+			SCORE(   0,   0), SCORE(   3,   3), SCORE(   2,   2), SCORE(   1,   1), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0)
+		},
+		{
+			SCORE(   0,   0), SCORE(   4,   4), SCORE(   3,   3), SCORE(   2,   2), SCORE(   1,   1), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0)
+		}
+	},
+	
+	// King safety, it fades out in the ending
+	.kingAttack = {
+		SCORE(   0,   0), SCORE(   2,   0), SCORE(   3,   0), SCORE(   6,   0), SCORE(  12,   0), SCORE(  18,   0), SCORE(  25,   0), SCORE(  37,   0),
+		SCORE(  50,   0), SCORE(  75,   0), SCORE( 100,   0), SCORE( 125,   0), SCORE( 150,   0), SCORE( 175,   0), SCORE( 200,   0), SCORE( 225,   0),
+		SCORE( 250,   0), SCORE( 275,   0), SCORE( 300,   0), SCORE( 325,   0), SCORE( 350,   0), SCORE( 375,   0), SCORE( 400,   0), SCORE( 425,   0),
+		SCORE( 450,   0), SCORE( 475,   0), SCORE( 500,   0), SCORE( 525,   0), SCORE( 550,   0), SCORE( 575,   0), SCORE( 600,   0), SCORE( 600,   0),
+		SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0),
+		SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0),
+		SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0),
+		SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0),
+		SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0),
+		SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0), SCORE( 600,   0)
+	},
+	.kingShelter = {
+		SCORE( -36,   0), SCORE(   0,   0), SCORE( -11,   0), SCORE( -20,   0), SCORE( -27,   0), SCORE( -32,   0), SCORE( -35,   0), SCORE( -36,   0)
+	},
+	.pawnStorm = {
+		SCORE(   0,   0), SCORE(   5,   0), SCORE(  10,   0), SCORE(  15,   0), SCORE(  20,   0), SCORE(  25,   0), SCORE(  30,   0), SCORE(  35,   0)
+	},
+	.fianchetto = SCORE(  20,   0),
+	.kingWeakPawn = SCORE(  10,   0),
+	
+	// Trapped pieces and development
+	.trappedKnight = SCORE( 100, 100),
+	.trappedKnightCorner = SCORE(  50,  50),
+	.trappedBishop = SCORE( 100, 100),
+	.trappedBishopSupported = SCORE(  50,  50),
+	.trappedRook = SCORE(  50,  50),
+	.blockedCenterPawn = SCORE(  20,  20),
+	.blockedBishop = SCORE(  30,  30),
+	
+	.hungPieces = SCORE(  80,  80),
+	.tempo = SCORE(  10,   0),
+	
+	// The piece square tables, the kings move to the center in the ending
+	.pst = {
+		/// Positioning of the pawns
+		[wP - wP] = {
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(   5,   0), SCORE(   5,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(   5,   0), SCORE(   5,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(  15,   0), SCORE(  15,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(  25,   0), SCORE(  25,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(  15,   0), SCORE(  15,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(   5,   0), SCORE(   5,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(   5,   0), SCORE(   5,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0),
+			SCORE( -15,   0), SCORE(  -5,   0), SCORE(   0,   0), SCORE(   5,   0), SCORE(   5,   0), SCORE(   0,   0), SCORE(  -5,   0), SCORE( -15,   0)
+		},
+		/// Positioning of the knights
+		[wN - wP] = {
+			SCORE( -50, -10), SCORE( -40,  -5), SCORE( -30,  -5), SCORE( -25,  -5), SCORE( -25,  -5), SCORE( -30,  -5), SCORE( -40,  -5), SCORE( -50, -10),
+			SCORE( -35,  -5), SCORE( -25,   0), SCORE( -15,   0), SCORE( -10,   0), SCORE( -10,   0), SCORE( -15,   0), SCORE( -25,   0), SCORE( -35,  -5),
+			SCORE( -20,  -5), SCORE( -10,   0), SCORE(   0,   5), SCORE(   5,   5), SCORE(   5,   5), SCORE(   0,   5), SCORE( -10,   0), SCORE( -20,  -5),
+			SCORE( -10,  -5), SCORE(   0,   0), SCORE(  10,   5), SCORE(  15,  10), SCORE(  15,  10), SCORE(  10,   5), SCORE(   0,   0), SCORE( -10,  -5),
+			SCORE(  -5,  -5), SCORE(   5,   0), SCORE(  15,   5), SCORE(  20,  10), SCORE(  20,  10), SCORE(  15,   5), SCORE(   5,   0), SCORE(  -5,  -5),
+			SCORE(  -5,  -5), SCORE(   5,   0), SCORE(  15,   5), SCORE(  20,   5), SCORE(  20,   5), SCORE(  15,   5), SCORE(   5,   0), SCORE(  -5,  -5),
+			SCORE( -20,  -5), SCORE( -10,   0), SCORE(   0,   0), SCORE(   5,   0), SCORE(   5,   0), SCORE(   0,   0), SCORE( -10,   0), SCORE( -20,  -5),
+			SCORE(-135, -10), SCORE( -25,  -5), SCORE( -15,  -5), SCORE( -10,  -5), SCORE( -10,  -5), SCORE( -15,  -5), SCORE( -25,  -5), SCORE(-135, -10)
+		},
+		/// Positioning of the bishops
+		[wB - wP] = {
+			SCORE( -20, -18), SCORE( -15, -12), SCORE( -15,  -9), SCORE( -13,  -6), SCORE( -13,  -6), SCORE( -15,  -9), SCORE( -15, -12), SCORE( -20, -18),
+			SCORE(  -5, -12), SCORE(   0,  -6), SCORE(  -5,  -3), SCORE(   0,   0), SCORE(   0,   0), SCORE(  -5,  -3), SCORE(   0,  -6), SCORE(  -5, -12),
+			SCORE(  -6,  -9), SCORE(  -2,  -3), SCORE(   4,   0), SCORE(   2,   3), SCORE(   2,   3), SCORE(   4,   0), SCORE(  -2,  -3), SCORE(  -6,  -9),
+			SCORE(  -4,  -6), SCORE(   0,   0), SCORE(   2,   3), SCORE(  10,   6), SCORE(  10,   6), SCORE(   2,   3), SCORE(   0,   0), SCORE(  -4,  -6),
+			SCORE(  -4,  -6), SCORE(   0,   0), SCORE(   2,   3), SCORE(  10,   6), SCORE(  10,   6), SCORE(   2,   3), SCORE(   0,   0), SCORE(  -4,  -6),
+			SCORE(  -6,  -9), SCORE(  -2,  -3), SCORE(   4,   0), SCORE(   2,   3), SCORE(   2,   3), SCORE(   4,   0), SCORE(  -2,  -3), SCORE(  -6,  -9),
+			SCORE(  -5, -12), SCORE(   0,  -6), SCORE(  -2,  -3), SCORE(   0,   0), SCORE(   0,   0), SCORE(  -2,  -3), SCORE(   0,  -6), SCORE(  -5, -12),
+			SCORE(  -8, -18), SCORE(  -8, -12), SCORE(  -6,  -9), SCORE(  -4,  -6), SCORE(  -4,  -6), SCORE(  -6,  -9), SCORE(  -8, -12), SCORE(  -8, -18)
+		},
+		/// Positioning of the rooks
+		[wR - wP] = {
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0),
+			SCORE(  -6,   0), SCORE(  -3,   0), SCORE(   0,   0), SCORE(   3,   0), SCORE(   3,   0), SCORE(   0,   0), SCORE(  -3,   0), SCORE(  -6,   0)
+		},
+		/// Positioning of the queens
+		[wQ - wP] = {
+			SCORE( -10, -24), SCORE( -10, -16), SCORE( -10, -12), SCORE( -10,  -8), SCORE( -10,  -8), SCORE( -10, -12), SCORE( -10, -16), SCORE( -10, -24),
+			SCORE(   0, -16), SCORE(   0,  -8), SCORE(   0,  -4), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,  -4), SCORE(   0,  -8), SCORE(   0, -16),
+			SCORE(   0, -12), SCORE(   0,  -4), SCORE(   0,   0), SCORE(   0,   4), SCORE(   0,   4), SCORE(   0,   0), SCORE(   0,  -4), SCORE(   0, -12),
+			SCORE(   0,  -8), SCORE(   0,   0), SCORE(   0,   4), SCORE(   0,   8), SCORE(   0,   8), SCORE(   0,   4), SCORE(   0,   0), SCORE(   0,  -8),
+			SCORE(   0,  -8), SCORE(   0,   0), SCORE(   0,   4), SCORE(   0,   8), SCORE(   0,   8), SCORE(   0,   4), SCORE(   0,   0), SCORE(   0,  -8),
+			SCORE(   0, -12), SCORE(   0,  -4), SCORE(   0,   0), SCORE(   0,   4), SCORE(   0,   4), SCORE(   0,   0), SCORE(   0,  -4), SCORE(   0, -12),
+			SCORE(   0, -16), SCORE(   0,  -8), SCORE(   0,  -4), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,  -4), SCORE(   0,  -8), SCORE(   0, -16),
+			SCORE(   0, -24), SCORE(   0, -16), SCORE(   0, -12), SCORE(   0,  -8), SCORE(   0,  -8), SCORE(   0, -12), SCORE(   0, -16), SCORE(   0, -24)
+		},
+		/// Positioning of the king
+		[wK - wP] = {
+			SCORE(  10, -20), SCORE(  20, -15), SCORE(   0, -10), SCORE(   0, -10), SCORE(   0, -10), SCORE(  10, -10), SCORE(  20, -15), SCORE(  10, -20),
+			SCORE(  10, -15), SCORE(  15,  -5), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(   0,   0), SCORE(  15,  -5), SCORE(  10, -15),
+			SCORE( -10, -10), SCORE( -20,   0), SCORE( -20,   5), SCORE( -25,   5), SCORE( -25,   5), SCORE( -20,   5), SCORE( -20,   0), SCORE( -10, -10),
+			SCORE( -15, -10), SCORE( -25,   0), SCORE( -40,   5), SCORE( -40,  10), SCORE( -40,  10), SCORE( -40,   5), SCORE( -25,   0), SCORE( -15, -10),
+			SCORE( -30, -10), SCORE( -40,   0), SCORE( -40,   5), SCORE( -40,  10), SCORE( -40,  10), SCORE( -40,   5), SCORE( -40,   0), SCORE( -30, -10),
+			SCORE( -40, -10), SCORE( -50,   0), SCORE( -50,   5), SCORE( -50,   5), SCORE( -50,   5), SCORE( -50,   5), SCORE( -50,   0), SCORE( -40, -10),
+			SCORE( -50, -15), SCORE( -50,  -5), SCORE( -50,   0), SCORE( -50,   0), SCORE( -50,   0), SCORE( -50,   0), SCORE( -50,  -5), SCORE( -50, -15),
+			SCORE( -50, -20), SCORE( -50, -15), SCORE( -50, -10), SCORE( -50, -10), SCORE( -50, -10), SCORE( -50, -10), SCORE( -50, -15), SCORE( -50, -20)
+		}
+	}
 };
 
-/// The following two king positions will be used in opening and middle game
-static const s8 wK_POS[] = {
-	
-	 10,  20,   0,   0,   0,  10,  20,  10,    
-	 10,  15,   0,   0,   0,   0,  15,  10,    
-	-10, -20, -20, -25, -25, -20, -20, -10,    
-	-15, -25, -40, -40, -40, -40, -25, -15,    
-	-30, -40, -40, -40, -40, -40, -40, -30,    
-	-40, -50, -50, -50, -50, -50, -50, -40,    
-	-50, -50, -50, -50, -50, -50, -50, -50,    
-	-50, -50, -50, -50, -50, -50, -50, -50
-};		
-
-/// Used to encourage the kings to move to the center in the ending
-static const s8 KING_POS_ENDING[] = {
-	
-	-20, -15, -10, -10, -10, -10, -15, -20,
-	-15,  -5,   0,   0,   0,   0,  -5, -15,
-	-10,   0,   5,   5,   5,   5,   0, -10,
-	-10,   0,   5,  10,  10,   5,   0, -10,
-	-10,   0,   5,  10,  10,   5,   0, -10,
-	-10,   0,   5,   5,   5,   5,   0, -10,
-	-15,  -5,   0,   0,   0,   0,  -5, -15,
-	-20, -15, -10, -10, -10, -10, -15, -20
-};	
-
-//// Marks the outpost squares for knight, do not put outpost values
-//// on the edges since we check for protecting pawns without checking out of pos The position's pointer
-static const s8 wN_OUTPOST[] = {
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   2,   5,  10,  10,   5,   2,   0,    
-	0,   2,   5,  10,  10,   5,   2,   0,    
-	0,   0,   4,   5,   5,   4,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0,    
-	0,   0,   0,   0,   0,   0,   0,   0
-};	
-
-
 /// Straight from Ed Schrِder's site
 static const s8 KING_ATTACK_PATTERN[] = {
 //. P N N R R R R Q Q Q Q Q Q Q Q K K K K K K K K K K K K K K K K
@@ -229,45 +263,6 @@ static const s8 KING_ATTACK_PATTERN[] = {
 };
 
 
-static const s16 KING_ATTACK_EVAL[] = { 
-	0,  2,  3,  6, 12, 18, 25, 37, 50, 75,
-	100,125,150,175,200,225,250,275,300,325,
-	350,375,400,425,450,475,500,525,550,575, 
-	600,600,600,600,600,600,600,600,600,600,
-	600,600,600,600,600,600,600,600,600,600,
-	600,600,600,600,600,600,600,600,600,600,
-	600,600,600,600,600,600,600,600,600,600,
-	600,600,600,600,600,600,600,600,600,600
-};
-
-static const u8 FIRST_BIT_TO_FILE_MASK[] = {
-	8,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	5,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	6,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	5,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	7,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	5,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	6,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	5,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
-	4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0
-};
-
-/// The closer the piece is to the opponent's king the better,
-/// knights score higher than bishops since bishops can attack from afar as well
-static const u8 TROPISM_KNIGHT[]    = {0, 3, 3, 2, 1, 0, 0, 0};
-static const u8 TROPISM_BISHOP[] 	 = {0, 2, 2, 1, 0, 0, 0, 0};
-static const u8 TROPISM_ROOK[]   	 = {0, 3, 2, 1, 0, 0, 0, 0};
-static const u8 TROPISM_QUEEN[]  	 = {0, 4, 3, 2, 1, 0, 0, 0};
-
-static const u8 PASSED_RANK_BONUS[] = {0,10,20,40,60,120,150,0}; 
-
 /**
  * Returns the shortest distance between two squares.
  * 
@@ -282,6 +277,39 @@ static u8 Distance(u8 squareA, u8 squareB){
 	return MAX(abs(FilesBrd[SQ64(squareA)] - FilesBrd[SQ64(squareB)]), abs(RanksBrd[SQ64(squareA)] - RanksBrd[SQ64(squareB)]));
 }
 
+/**
+ * Returns the value of a score at a taper phase, it is interpolated between the middle game value
+ * (PHASE_MAX) and the ending value (0).
+ * 
+ * @param score The score.
+ * @param phase The taper phase.
+ * @return The tapered value.
+ */
+static s16 Taper(const S_SCORE score, const u8 phase){
+	
+	return (SCORE_MG(score) * phase + SCORE_EG(score) * (PHASE_MAX - phase)) / PHASE_MAX;
+}
+
+/// Returns the score multiplied by num / den, the values are scaled one by one since a packed score can't be divided.
+static S_SCORE ScaleScore(const S_SCORE score, const s16 num, const s16 den){
+	return SCORE(SCORE_MG(score) * num / den, SCORE_EG(score) * num / den);
+}
+
+/**
+ * Returns the taper phase of the position by the pieces on the board, the phase goes down
+ * smoothly as the pieces are traded instead of jumping between the game phases.
+ * 
+ * @param pos The position's pointer.
+ * @return The taper phase, from PHASE_MAX down to 0.
+ */
+static u8 TaperPhase(const S_BOARD *pos){
+	
+	u8 phase = pos->pceNum[wN] + pos->pceNum[bN] + pos->pceNum[wB] + pos->pceNum[bB]
+			 + 2 * (pos->pceNum[wR] + pos->pceNum[bR]) + 4 * (pos->pceNum[wQ] + pos->pceNum[bQ]);
+	
+	return MIN(phase, PHASE_MAX);
+}
+
 /**
  * Check if drawn by material or not. 
  *
@@ -322,46 +350,93 @@ static u8 DrawByMaterial(const S_BOARD *pos, u8 side){
 	return TRUE;
 }
 
+/**
+ * Fills the material entry of the position's material configuration, everything
+ * that depends only on the piece counts is computed here once per configuration.
+ * 
+ * @param pos The position's pointer.
+ * @param entry The material entry to be filled.
+ */
+static void MaterialEval(const S_BOARD *pos, S_MATERIALENTRY *entry){
+	
+	u8 side, piece;
+	u8 phase = GetGamePhase(pos);
+	
+	entry->phase = TaperPhase(pos);
+	entry->gamePhase = phase;
+	entry->flags = DrawByMaterial(pos, BOTH) ? MATERIAL_DRAW : 0;
+	
+	for(side = WHITE; side <= BLACK; side++){
+		
+		u8 own = side * (bP - wP);
+		entry->material[side] = 0;
+		
+		// The values of the pieces, the king isn't counted
+		for(piece = wP; piece <= wQ; piece++){
+			entry->material[side] += EvalWeights.pieceValue[piece - wP] * pos->pceNum[piece + own];
+			TRACE(pieceValue[piece - wP], SIGN(side) * pos->pceNum[piece + own]);
+		}
+		
+		// Bishop pair bonus
+		if(pos->pceNum[wB + own] >= 2){
+			entry->material[side] += EvalWeights.bishopPair;
+			TRACE(bishopPair, SIGN(side));
+		}
+		
+		// If the side does not have enough material to win (e.g. only a bishop)
+		// its winning score goes to 0 in the ending
+		entry->scale[side] = (phase == PHASE_ENDING && DrawByMaterial(pos, side)) ? 0 : 100;
+	}
+	
+	// Opposite color bishops
+	// If there is exactly one bishop on both sides and neither side has more that 4 pawns,
+	// the bishops squares decide if the score is reduced
+	if(phase == PHASE_ENDING && pos->pceNum[wB] == 1 && pos->pceNum[bB] == 1 && pos->pceNum[wP] <= 4 && pos->pceNum[bP] <= 4){
+		entry->flags |= MATERIAL_BISHOPS;
+	}
+	
+	// Known endings have their own evaluation or scale factor
+	SetEndgame(pos, entry);
+}
+
 /**
  * Takes the total evaluation and adjusts towards 0 if a draw is likely.
  * 
  * @param pos The position's pointer.
+ * @param entry The material entry of the position.
  * @param totalEval The total evaluation before adjustment.
  * @return adjustedScore The final evaluation after adjustment.
  */
-static s16 DrawProbability(const S_BOARD *pos, s16 totalEval){
+static s16 DrawProbability(const S_BOARD *pos, const S_MATERIALENTRY *entry, s16 totalEval){
 
 	s16 adjustedScore = totalEval;
 	u8 w_rank,w_file,b_rank,b_file;
 	u8 fifty = pos->fiftyMove;
 	
 	
-	if(gamePhase == PHASE_ENDING){
+	// If the score says one side is winning scale it by the material of that side,
+	// e.g. the side does not have enough material to win (only a bishop) so return draw
+	if(adjustedScore > 0) adjustedScore = adjustedScore * entry->scale[WHITE] / 100;
+	else adjustedScore = adjustedScore * entry->scale[BLACK] / 100;
+	
+	if(adjustedScore == 0) return 0;
 	
-		// If the score says one side is winning but that side does not
-		// have enough material to win (e.g. only a bishop) return draw
-		if(adjustedScore > 0 && DrawByMaterial(pos, WHITE)) return 0;
-		if(adjustedScore < 0 && DrawByMaterial(pos, BLACK)) return 0;
+	// Opposite color bishops
+	// If there is exactly one bishop on both sides and they
+	// are of opposite color and neither side has more that 4 pawns,
+	// reduce the score towards 0 with 20%
+	if(entry->flags & MATERIAL_BISHOPS){
 		
-		// Opposite color bishops
-		// If there is exactly one bishop on both sides and they
-		// are of opposite color and neither side has more that 4 pawns,
-		// reduce the score towards 0 with 20%
-		if(pos->pceNum[wB] == 1 && pos->pceNum[bB]  == 1 && pos->pceNum[wP]  <= 4 && pos->pceNum[bP]  <= 4){
-			
-			w_rank = RanksBrd[SQ64(pos->pList[wB][0])];
-			w_file = FilesBrd[SQ64(pos->pList[wB][0])];
-			b_rank = RanksBrd[SQ64(pos->pList[bB][0])];
-			b_file = FilesBrd[SQ64(pos->pList[bB][0])];
-			ASSERT(FileRankValid(w_rank));
-			ASSERT(FileRankValid(b_rank));
-			ASSERT(FileRankValid(b_file));
-			ASSERT(FileRankValid(w_file));
-			
-			if(((w_rank + w_file) & 1) != ((b_rank + b_file) & 1)) adjustedScore = 80 * adjustedScore / 100;
-			
-			
-		}
+		w_rank = RanksBrd[SQ64(pos->pList[wB][0])];
+		w_file = FilesBrd[SQ64(pos->pList[wB][0])];
+		b_rank = RanksBrd[SQ64(pos->pList[bB][0])];
+		b_file = FilesBrd[SQ64(pos->pList[bB][0])];
+		ASSERT(FileRankValid(w_rank));
+		ASSERT(FileRankValid(b_rank));
+		ASSERT(FileRankValid(b_file));
+		ASSERT(FileRankValid(w_file));
+		
+		if(((w_rank + w_file) & 1) != ((b_rank + b_file) & 1)) adjustedScore = 80 * adjustedScore / 100;
 	}
 	
 	// 50 moves rule
@@ -376,6 +451,9 @@ static s16 DrawProbability(const S_BOARD *pos, s16 totalEval){
 }
 
 
+/// Returns a penalty weight of a trapped piece pattern of the side and adds it to the trace.
+#define TRAPPED(weight, side) (TRACE(weight, -SIGN(side)), EvalWeights.weight)
+
 /**
  * Takes a few common trapped piece patterns and checks
  * if any of them exists on the pos The position's pointer.
@@ -387,8 +465,8 @@ static s16 DrawProbability(const S_BOARD *pos, s16 totalEval){
  * @param pos The position's pointer.
  * @return trapped_eval The penalty if one or more patterns exists 0 if no exist.
  */
-static s16 WhiteTrapped(const S_BOARD *pos){
-	s16 trapped_eval = 0;
+static S_SCORE WhiteTrapped(const S_BOARD *pos){
+	S_SCORE trapped_eval = 0;
 	
 	// Knights
 	/* 
@@ -401,13 +479,13 @@ static s16 WhiteTrapped(const S_BOARD *pos){
 	 * * * * * * * *	* * * * * * * *		* * * * * * * *		* * * * * * * *
 	 * * * * * * * *	* * * * * * * *		* * * * * * * *		* * * * * * * *
 	 */
-	if(pos->pieces[A7] == wN && pos->pieces[B7] == bP && pos->pieces[C6] == bP) trapped_eval -= 100;
+	if(pos->pieces[A7] == wN && pos->pieces[B7] == bP && pos->pieces[C6] == bP) trapped_eval -= TRAPPED(trappedKnight, WHITE);
 	
-	if(pos->pieces[H7] == wN && pos->pieces[G7] == bP && pos->pieces[F6] == bP) trapped_eval -= 100;
+	if(pos->pieces[H7] == wN && pos->pieces[G7] == bP && pos->pieces[F6] == bP) trapped_eval -= TRAPPED(trappedKnight, WHITE);
 	
-	if(pos->pieces[A8] == wN && (pos->pieces[A7] == bP || pos->pieces[C7] == bP)) trapped_eval -= 50;
+	if(pos->pieces[A8] == wN && (pos->pieces[A7] == bP || pos->pieces[C7] == bP)) trapped_eval -= TRAPPED(trappedKnightCorner, WHITE);
 	
-	if(pos->pieces[H8] == wN && (pos->pieces[H7] == bP || pos->pieces[F7] == bP)) trapped_eval -= 50;
+	if(pos->pieces[H8] == wN && (pos->pieces[H7] == bP || pos->pieces[F7] == bP)) trapped_eval -= TRAPPED(trappedKnightCorner, WHITE);
 	
 	
 	// Bishops
@@ -422,23 +500,23 @@ static s16 WhiteTrapped(const S_BOARD *pos){
 	 * * * * * * * *	* * * * * * * *		* * * * * * * *		* * * * * * * *
 	 */
 	if(pos->pieces[A7] == wB && pos->pieces[B6] == bP){
-		trapped_eval -= 100;
-		if(pos->pieces[C7] == bP) trapped_eval -= 50; 		// Even more if the trapping pawn is supported
+		trapped_eval -= TRAPPED(trappedBishop, WHITE);
+		if(pos->pieces[C7] == bP) trapped_eval -= TRAPPED(trappedBishopSupported, WHITE); 		// Even more if the trapping pawn is supported
 	}
 	
 	if(pos->pieces[B8] == wB && pos->pieces[C7] == bP){
-		trapped_eval -= 100;
-		if(pos->pieces[B6] == bP) trapped_eval -= 50; 		// Even more if it can't get out via A7
+		trapped_eval -= TRAPPED(trappedBishop, WHITE);
+		if(pos->pieces[B6] == bP) trapped_eval -= TRAPPED(trappedBishopSupported, WHITE); 		// Even more if it can't get out via A7
 	}
 	
 	if(pos->pieces[H7] == wB && pos->pieces[G6] == bP){
-		trapped_eval -= 100;
-		if(pos->pieces[F7] == bP) trapped_eval -= 50; 		// Even more if the trapping pawn is supported
+		trapped_eval -= TRAPPED(trappedBishop, WHITE);
+		if(pos->pieces[F7] == bP) trapped_eval -= TRAPPED(trappedBishopSupported, WHITE); 		// Even more if the trapping pawn is supported
 	}
 	
 	if(pos->pieces[G8] == wB && pos->pieces[F7] == bP){
-		trapped_eval -= 100;
-		if(pos->pieces[G6] == bP) trapped_eval -= 50; 		// Even more if it can't get out via H7
+		trapped_eval -= TRAPPED(trappedBishop, WHITE);
+		if(pos->pieces[G6] == bP) trapped_eval -= TRAPPED(trappedBishopSupported, WHITE); 		// Even more if it can't get out via H7
 	}
 	
 	/* 
@@ -451,15 +529,15 @@ static s16 WhiteTrapped(const S_BOARD *pos){
 	 * * * * * * * *	* * * * * * * *	
 	 * * * * * * * *	* * * * * * * *	
 	 */
-	if(pos->pieces[A6] == wB && pos->pieces[B5] == bP) trapped_eval -= 100;
+	if(pos->pieces[A6] == wB && pos->pieces[B5] == bP) trapped_eval -= TRAPPED(trappedBishop, WHITE);
 	
-	if(pos->pieces[H6] == wB && pos->pieces[G5] == bP) trapped_eval -= 100;
+	if(pos->pieces[H6] == wB && pos->pieces[G5] == bP) trapped_eval -= TRAPPED(trappedBishop, WHITE);
 
 	
 	// Rooks (trapped in the corner by the own king)
-	if((pos->pieces[G1] == wR || pos->pieces[G2] == wR || pos->pieces[H1] == wR || pos->pieces[H2] == wR) && (pos->pieces[G1] == wK || pos->pieces[F1] == wK)) trapped_eval -= 50;
+	if((pos->pieces[G1] == wR || pos->pieces[G2] == wR || pos->pieces[H1] == wR || pos->pieces[H2] == wR) && (pos->pieces[G1] == wK || pos->pieces[F1] == wK)) trapped_eval -= TRAPPED(trappedRook, WHITE);
 	
-	if((pos->pieces[A1] == wR || pos->pieces[A2] == wR || pos->pieces[B1] == wR || pos->pieces[B2] == wR) && (pos->pieces[C1] == wK || pos->pieces[B1] == wK)) trapped_eval -= 50;
+	if((pos->pieces[A1] == wR || pos->pieces[A2] == wR || pos->pieces[B1] == wR || pos->pieces[B2] == wR) && (pos->pieces[C1] == wK || pos->pieces[B1] == wK)) trapped_eval -= TRAPPED(trappedRook, WHITE);
 	
 	
 	// Blocked center pawn
@@ -474,13 +552,13 @@ static s16 WhiteTrapped(const S_BOARD *pos){
 	 * * B * * * * *	* * * * * B * *	
 	 */
 	if(pos->pieces[D2] == wP && pos->pieces[D3] != EMPTY){
-		trapped_eval -= 20;
-		if(pos->pieces[C1] == wB) trapped_eval -= 30; 		// Even more if there is still a bishop on c1
+		trapped_eval -= TRAPPED(blockedCenterPawn, WHITE);
+		if(pos->pieces[C1] == wB) trapped_eval -= TRAPPED(blockedBishop, WHITE); 		// Even more if there is still a bishop on c1
 	}
 	
 	if(pos->pieces[E2] == wP && pos->pieces[E3] != EMPTY){
-		trapped_eval -= 20;
-		if(pos->pieces[F1] == wB) trapped_eval -= 30; 		// Even more if there is still a bishop on f1
+		trapped_eval -= TRAPPED(blockedCenterPawn, WHITE);
+		if(pos->pieces[F1] == wB) trapped_eval -= TRAPPED(blockedBishop, WHITE); 		// Even more if there is still a bishop on f1
 	}
 	
 	
@@ -499,60 +577,60 @@ static s16 WhiteTrapped(const S_BOARD *pos){
  * @param pos The position's pointer.
  * @return trapped_eval The penalty if one or more patterns exists 0 if no exist.
  */
-static s16 BlackTrapped(const S_BOARD *pos){
-	s16 trapped_eval = 0;
+static S_SCORE BlackTrapped(const S_BOARD *pos){
+	S_SCORE trapped_eval = 0;
 	
 	// Knights
-	if(pos->pieces[A2] == bN && pos->pieces[B2] == wP && pos->pieces[C3] == wP) trapped_eval -= 100;
+	if(pos->pieces[A2] == bN && pos->pieces[B2] == wP && pos->pieces[C3] == wP) trapped_eval -= TRAPPED(trappedKnight, BLACK);
 	
-	if(pos->pieces[H2] == bN && pos->pieces[G2] == wP && pos->pieces[F3] == wP) trapped_eval -= 100;
+	if(pos->pieces[H2] == bN && pos->pieces[G2] == wP && pos->pieces[F3] == wP) trapped_eval -= TRAPPED(trappedKnight, BLACK);
 	
-	if(pos->pieces[A1] == bN && (pos->pieces[A2] == wP || pos->pieces[C2] == wP)) trapped_eval -= 50;
+	if(pos->pieces[A1] == bN && (pos->pieces[A2] == wP || pos->pieces[C2] == wP)) trapped_eval -= TRAPPED(trappedKnightCorner, BLACK);
 	
-	if(pos->pieces[H1] == bN && (pos->pieces[H2] == wP || pos->pieces[F2] == wP)) trapped_eval -= 50;
+	if(pos->pieces[H1] == bN && (pos->pieces[H2] == wP || pos->pieces[F2] == wP)) trapped_eval -= TRAPPED(trappedKnightCorner, BLACK);
 	
 	
 	// Bishops
 	if(pos->pieces[A2] == bB && pos->pieces[B3] == wP){
-		trapped_eval -= 100;
-		if(pos->pieces[C2] == wP) trapped_eval -= 50; 		// Even more if the trapping pawn is supported
+		trapped_eval -= TRAPPED(trappedBishop, BLACK);
+		if(pos->pieces[C2] == wP) trapped_eval -= TRAPPED(trappedBishopSupported, BLACK); 		// Even more if the trapping pawn is supported
 	}
 	
 	if(pos->pieces[B1] == bB && pos->pieces[C2] == wP){
-		trapped_eval -= 100;
-		if(pos->pieces[B3] == wP) trapped_eval -= 50; 		// Even more if it can't get out via A7
+		trapped_eval -= TRAPPED(trappedBishop, BLACK);
+		if(pos->pieces[B3] == wP) trapped_eval -= TRAPPED(trappedBishopSupported, BLACK); 		// Even more if it can't get out via A7
 	}
 	
 	if(pos->pieces[H2] == bB && pos->pieces[G3] == wP){
-		trapped_eval -= 100;
-		if(pos->pieces[F2] == wP) trapped_eval -= 50; 		// Even more if the trapping pawn is supported
+		trapped_eval -= TRAPPED(trappedBishop, BLACK);
+		if(pos->pieces[F2] == wP) trapped_eval -= TRAPPED(trappedBishopSupported, BLACK); 		// Even more if the trapping pawn is supported
 	}
 	
 	if(pos->pieces[G1] == bB && pos->pieces[F2] == wP){
-		trapped_eval -= 100;
-		if(pos->pieces[G3] == wP) trapped_eval -= 50; 		// Even more if it can't get out via H7
+		trapped_eval -= TRAPPED(trappedBishop, BLACK);
+		if(pos->pieces[G3] == wP) trapped_eval -= TRAPPED(trappedBishopSupported, BLACK); 		// Even more if it can't get out via H7
 	}		
 	
-	if(pos->pieces[A3] == bB && pos->pieces[B4] == wP) trapped_eval -= 100;
+	if(pos->pieces[A3] == bB && pos->pieces[B4] == wP) trapped_eval -= TRAPPED(trappedBishop, BLACK);
 	
-	if(pos->pieces[H3] == bB && pos->pieces[G4] == wP) trapped_eval -= 100;
+	if(pos->pieces[H3] == bB && pos->pieces[G4] == wP) trapped_eval -= TRAPPED(trappedBishop, BLACK);
 	
 	
 	// Rooks (trapped in the corner by the own king)
-	if((pos->pieces[G8] == bR || pos->pieces[G7] == bR || pos->pieces[H8] == bR || pos->pieces[H7] == bR) && (pos->pieces[G8] == bK || pos->pieces[F8] == bK)) trapped_eval -= 50;
+	if((pos->pieces[G8] == bR || pos->pieces[G7] == bR || pos->pieces[H8] == bR || pos->pieces[H7] == bR) && (pos->pieces[G8] == bK || pos->pieces[F8] == bK)) trapped_eval -= TRAPPED(trappedRook, BLACK);
 	
-	if((pos->pieces[A8] == bR || pos->pieces[A7] == bR || pos->pieces[B8] == bR || pos->pieces[B7] == bR) && (pos->pieces[C8] == bK || pos->pieces[B8] == bK)) trapped_eval -= 50;
+	if((pos->pieces[A8] == bR || pos->pieces[A7] == bR || pos->pieces[B8] == bR || pos->pieces[B7] == bR) && (pos->pieces[C8] == bK || pos->pieces[B8] == bK)) trapped_eval -= TRAPPED(trappedRook, BLACK);
 	
 	
 	// Blocked center pawn
 	if(pos->pieces[D7] == bP && pos->pieces[D6] != EMPTY){
-		trapped_eval -= 20;
-		if(pos->pieces[C8] == bB) trapped_eval -= 30; 		// Even more if there is still a bishop on c1
+		trapped_eval -= TRAPPED(blockedCenterPawn, BLACK);
+		if(pos->pieces[C8] == bB) trapped_eval -= TRAPPED(blockedBishop, BLACK); 		// Even more if there is still a bishop on c1
 	}
 	
 	if(pos->pieces[E7] == bP && pos->pieces[E6] != EMPTY){
-		trapped_eval -= 20;
-		if(pos->pieces[F8] == bB) trapped_eval -= 30; 		// Even more if there is still a bishop on f1
+		trapped_eval -= TRAPPED(blockedCenterPawn, BLACK);
+		if(pos->pieces[F8] == bB) trapped_eval -= TRAPPED(blockedBishop, BLACK); 		// Even more if there is still a bishop on f1
 	}
 	
 	
@@ -562,272 +640,172 @@ static s16 BlackTrapped(const S_BOARD *pos){
 
 
 /**
- * Evaluates the white pawns and adds passed pawn to the array for later analysis.
+ * Fills the bitboard forward for the side, every set bit is spread over the squares in front of it.
  * 
- * @param pos The position's pointer.
- * @return pawnEval The evaluation of the pawn strucutre (without passed pawns).
+ * @param side The side which moves forward.
+ * @param bb The bitboard to be filled.
+ * @return The filled bitboard including the original bits.
  */
-static s8 WhitePawnEval(const S_BOARD *pos){
-	
-	u8 index,file,rank,testIndex;
-	u8 tempWeak;
-	s8 pawnEval = 0;
+static u64 FrontFill(const u8 side, u64 bb){
 	
-	for(u8 i = 0; i < pos->pceNum[wP]; i++){
-		
-		index = pos->pList[wP][i];
-		file = FilesBrd[SQ64(index)];
-		rank = RanksBrd[SQ64(index)];
-		
-		// Check for doubled pawn(detected by the most forward)
-		// If the rank recorded is not the same as this pawn which is
-		// on the same file, there is another pawn on the same file
-		// so the pawns are doubled
-		if((wPPos[file+1] & 0xFF) != rank){
-			pawnEval -= DOUBLED_PAWN;	
-		}
-		
-		// Check for isolated pawn
-		// If the file to the right and left of this file does not contain
-		// any friendly pawns, the pawn is isolated
-		if(wPPos[file+1+1] == 0 && wPPos[file+1-1] == 0){
-			pawnEval -= ISOLATED_PAWN;						
-		}
-		
-		// If it's not isolated it could be backwards/weak
-		// There are two scenarios, either the pawn can be
-		// left behind (backwards) so it can not advance and be protected by other pawns
-		// or it could be pushed too far (weak) so no other pawns can advance and
-		// protect it
-		else if((WB[SQ64(index)] & PAWN_BIT) == 0){ // If no pawn is protecting it
-
-			tempWeak = TRUE;
-			// If the pawn moved atleast two ranks
-			if(rank >= RANK_4){
-				
-				// If the square to two ranks behind to the left is a friendly pawn
-				if(!SQOFFBOARD(index - 21) && pos->pieces[(index -21)] == wP){
-					
-					testIndex = index - 11;
-					
-					// If the friendly pawn is not blocked by a black pawn and the square
-					// it is advancing to is protected by a friendly pawn or not attacked
-					// by an enemy pawn
-					if(!SQOFFBOARD(testIndex) && pos->pieces[testIndex] != bP && (WB[SQ64(testIndex)] & PAWN_BIT) >= (BB[SQ64(testIndex)] & PAWN_BIT)){
-						
-						// The pawn can be supported by a friendly pawn advance
-						// so it is not weak
-						tempWeak = FALSE;							
-					}						
-				}
-				
-				// Same as above but checking for friendly pawn to the right
-				if(!SQOFFBOARD(index - 19) && pos->pieces[(index -19)] == wP){
-					
-					testIndex = index - 9;
-					if(!SQOFFBOARD(testIndex) && pos->pieces[testIndex] != bP && (WB[SQ64(testIndex)] & PAWN_BIT) >= (BB[SQ64(testIndex)] & PAWN_BIT)){
-						
-						// The pawn can be supported by a friendly pawn advance
-						// so it is not weak
-						tempWeak = FALSE;							
-					}						
-				}
-				
-				// The pawn can not be supported by a friendly pawn advancing so check
-				// if it can advance itself and be supported
-				if(tempWeak){
-					
-					testIndex = index + 10;
-					// If the square in front of the pawn is not blocked and the opponent
-					// is not controlling the square with it's pawns, it is not backwards
-					if(!(pos->pieces[testIndex] != wP && pos->pieces[testIndex] != bP && (WB[SQ64(testIndex)] & PAWN_BIT) >= (BB[SQ64(testIndex)] & PAWN_BIT))){
-						pawnEval -= WEAK_PAWN;
-					}
-					
-				}
-				
-				// Give penalty for the weak/backwards pawn
-				// if(tempWeak) pawnEval -= WEAK_PAWN;
-			
-				
-			}
-		}
-		
-		// TODO: Doubled passed pawns are valued too high
-		// Check if the pawn is passed	
-		if(((wPPos[file+1] & 0xFF00) >> 8) == rank){ 									// Make sure it is the most forward pawn we're checking
-		
-			if((bPPos[file+1] == 0 || (bPPos[file+1] & 0xFF) < rank) && 				// Either no enemy pawn on same file, or behind the pawn
-				(bPPos[file+1+1] == 0 || (bPPos[file+1+1] & 0xFF) <= rank) && 			// Either no enemy pawn to the front right, or next to or behind the pawn
-				(bPPos[file+1-1] == 0 || (bPPos[file+1-1] & 0xFF) <= rank))  			// Either no enemy pawn to the front left, or next to or behind the pawn
-			{
-				passers = passers | FILE_TO_BIT_MASK[file];
-			}
-		}
+	if(side == WHITE){
+		bb |= bb << 8;
+		bb |= bb << 16;
+		bb |= bb << 32;
+	}else{
+		bb |= bb >> 8;
+		bb |= bb >> 16;
+		bb |= bb >> 32;
 	}
-	return pawnEval;
 	
+	return bb;
 }
 
+/**
+ * Returns the squares attacked by a set of pawns.
+ * 
+ * @param side The side of the pawns.
+ * @param pawns The squares of the pawns.
+ * @return The attacked squares.
+ */
+static u64 PawnAttacks(const u8 side, const u64 pawns){
+	
+	if(side == WHITE) return ((pawns << 9) & ~FILE_A_BB) | ((pawns << 7) & ~FILE_H_BB);
+	else return ((pawns >> 7) & ~FILE_A_BB) | ((pawns >> 9) & ~FILE_H_BB);
+}
 
 /**
- * Evaluates the black pawns and adds passed pawn to the array for later analysis.
+ * Evaluates the pawns of the side and records its passed pawns and king shelter in the pawn entry,
+ * the pawn attacks and attack spans of both sides must be already in the entry.
  * 
  * @param pos The position's pointer.
+ * @param side The side of the pawns.
+ * @param entry The pawn structure entry being filled.
  * @return pawnEval The evaluation of the pawn strucutre (without passed pawns).
  */
-static s8 BlackPawnEval(const S_BOARD *pos){
-	
-	u8 index,file,rank,testIndex;
-	u8 tempWeak;
-	s8 pawnEval = 0;
-	
-	for(u8 i = 0; i < pos->pceNum[bP]; i++){
-		index = pos->pList[bP][i];
-		file = FilesBrd[SQ64(index)];
-		rank = RanksBrd[SQ64(index)];
-		
-		// Check for doubled pawn
-		// If the rank recorded is not the same as this pawn which is
-		// on the same file, there is another pawn on the same file
-		// so the pawns are doubled
-		if((bPPos[file+1] & 0xFF) != rank){
-			pawnEval -= DOUBLED_PAWN;
-		}
-		
-		// Check for isolated pawn
-		// If the file to the right and left of this file does not contain
-		// any friendly pawns, the pawn is isolated
-		if(bPPos[file+1+1] == 0 && bPPos[file+1-1] == 0){
-			pawnEval -= ISOLATED_PAWN;						
-		}
-		
-		// If it's not isolated it could be backwards/weak
-		// There are two scenarios, either the pawn can be
-		// left behind (backwards) so it can not advance and be protected by other pawns
-		// or it could be pushed too far (weak) so no other pawns can advance and
-		// protect it
-		else if((BB[SQ64(index)] & PAWN_BIT) == 0){ // If no pawn is protecting it
-		
-			tempWeak = TRUE;
-			
-			// If the pawn moved atleast two ranks
-			if(rank <= RANK_5){
-				
-				// If the square to two ranks behind to the left is a friendly pawn
-				if(!SQOFFBOARD(index + 21) && pos->pieces[(index + 21)] == bP){
-					
-					testIndex = index + 11;
-					// If the friendly pawn is not blocked by a black pawn and the square
-					// it is advancing to is protected by a friendly pawn or not attacked
-					// by an enemy pawn
-					if(!SQOFFBOARD(testIndex) && pos->pieces[testIndex] != wP && (BB[SQ64(testIndex)] & PAWN_BIT) >= (WB[SQ64(testIndex)] & PAWN_BIT)){
-						
-						// The pawn can be supported by a friendly pawn advance
-						// so it is not weak
-						tempWeak = FALSE;							
-					}						
-				}
-				
-				// Same as above but checking for friendly pawn to the right
-				if(!SQOFFBOARD(index + 19) && pos->pieces[(index +19)] == bP){
-				
-					testIndex = index + 9;
-					
-					if(!SQOFFBOARD(testIndex) && pos->pieces[testIndex] != wP && (BB[SQ64(testIndex)] & PAWN_BIT) >= (WB[SQ64(testIndex)] & PAWN_BIT)){
-					
-						// The pawn can be supported by a friendly pawn advance
-						// so it is not weak
-						tempWeak = FALSE;							
-					}						
-				}
-				
-				// The pawn can not be supported by a friendly pawn advancing so check
-				// if it can advance itself and be supported
-				if(tempWeak){
-					
-					testIndex = index - 10;
-					// If the square in front of the pawn is not blocked and the opponent
-					// is not controlling the square with it's pawns, it is not backwards
-					if(!(pos->pieces[testIndex] != wP && pos->pieces[testIndex] != bP && (BB[SQ64(testIndex)] & PAWN_BIT) >= (WB[SQ64(testIndex)] & PAWN_BIT))){
-						pawnEval -= WEAK_PAWN;
-					}
-					
-				}
-				
-				// Give penalty for the weak/backwards pawn
-				// if(tempWeak) pawnEval -= WEAK_PAWN;
-			}
-		}
-		
-		if(((bPPos[file+1] & 0xFF00) >> 8) == rank){ 									// Make sure it is the most forward pawn we're checking
-		
-			// Check if the pawn is passed	(see white for comments)		
-			if((wPPos[file+1] == 0 || (wPPos[file+1] & 0xFF) > rank) && 				// Either no enemy pawn on same rank, or behind the pawn
-				(wPPos[file+1+1] == 0 || (wPPos[file+1+1] & 0xFF) >= rank) && 			// Either no enemy pawn to the right, or next to or behind the pawn
-				(wPPos[file+1-1] == 0 || (wPPos[file+1-1] & 0xFF) >= rank))   			// Either no enemy pawn to the left, or next to or behind the pawn
-			{
-				passers = passers | (FILE_TO_BIT_MASK[file] << 8);				
-			}
-		}			
-	}
+static S_SCORE PawnEval(const S_BOARD *pos, const u8 side, S_PAWNENTRY *entry){
+	
+	u8 enemy = side ^ 1;
+	u64 own = pos->pawns[side];
+	u64 theirs = pos->pawns[enemy];
+	u64 files, isolated, weak;
+	S_SCORE pawnEval = 0;
+	u8 count;
+	
+	// Squares controlled by the enemy pawns, they attack them and no own pawn defends them
+	u64 controlled = entry->attacks[enemy] & ~entry->attacks[side];
+	
+	// Check for doubled pawns, every pawn in front of a friendly pawn on the same file is
+	// doubled so only the most backward pawn of a file is not, and it shelters the king
+	u64 doubled = own & FrontFill(side, PAWN_PUSH(side, own));
+	count = POPCOUNT(doubled);
+	pawnEval -= EvalWeights.doubledPawn * count;
+	TRACE(doubledPawn, -SIGN(side) * count);
+	entry->shelter[side] = own & ~doubled;
+	
+	// Check for isolated pawns
+	// If the file to the right and left of the pawn file does not contain
+	// any friendly pawns, the pawn is isolated
+	files = FrontFill(WHITE, FrontFill(BLACK, own));
+	isolated = own & ~(((files << 1) & ~FILE_A_BB) | ((files >> 1) & ~FILE_H_BB));
+	count = POPCOUNT(isolated);
+	pawnEval -= EvalWeights.isolatedPawn * count;
+	TRACE(isolatedPawn, -SIGN(side) * count);
+	
+	// If it's not isolated it could be backwards/weak
+	// There are two scenarios, either the pawn can be left behind (backwards) so it can not
+	// advance and be protected by other pawns or it could be pushed too far (weak) so no other
+	// pawns can advance and protect it. The pawn is supported by a friendly pawn advance if a pawn
+	// two ranks behind on the next file can push to a square not blocked by an enemy pawn nor
+	// controlled by the enemy pawns
+	weak = own & ~isolated & ~entry->attacks[side] & WEAK_PAWN_RANKS[side];
+	weak &= ~PawnAttacks(side, PAWN_PUSH(side, own) & ~theirs & ~controlled);
+	
+	// The weak pawn can not be supported so give the penalty if it can not advance itself either,
+	// the square in front of it is blocked by a pawn or controlled by the enemy pawns
+	count = POPCOUNT(PAWN_PUSH(side, weak) & (own | theirs | controlled));
+	pawnEval -= EvalWeights.weakPawn * count;
+	TRACE(weakPawn, -SIGN(side) * count);
+	
+	// The pawn is passed if it is the most forward pawn of its file, and no enemy pawn is in front
+	// of it on the same file or can attack it on the way to promotion
+	entry->passed[side] = own & ~FrontFill(enemy, PAWN_PUSH(enemy, own | theirs)) & ~entry->attackSpan[enemy];
+	
 	return pawnEval;
+}
+
+/**
+ * Fills the pawn structure entry of the position, the pawn attacks and attack spans of each side
+ * then the pawn structure evaluation, passed pawns and king shelter.
+ * 
+ * @param pos The position's pointer.
+ * @param entry The pawn structure entry to be filled.
+ */
+static void PawnStructure(const S_BOARD *pos, S_PAWNENTRY *entry){
+	
+	for(u8 side = WHITE; side <= BLACK; side++){
+		entry->attacks[side] = PawnAttacks(side, pos->pawns[side]);
+		entry->attackSpan[side] = FrontFill(side, entry->attacks[side]);
+	}
 	
+	entry->structure[WHITE] = PawnEval(pos, WHITE, entry);
+	entry->structure[BLACK] = PawnEval(pos, BLACK, entry);
 }
 
 /**
  * Evaluates the passsed pawns.
  * 
  * @param pos The position's pointer.
+ * @param entry The pawn structure entry of the position.
  * @return passerEval The evaluation of the passed pawns.
  */
-static s16 EvaluatePassers(const S_BOARD *pos){
-	s16 passerEval = 0;
-	u8 whitePassers = passers & 0xFF;
-	u8 blackPassers = (passers & 0xFF00) >> 8;
-	
-	u8 index, file, rank;
-	u8 rankBonus;
-	s16 whiteEval = 0;
-	s16 blackEval = 0;
+static S_SCORE EvaluatePassers(const S_BOARD *pos, const S_PAWNENTRY *entry){
+	S_SCORE passerEval = 0;
+	u64 whitePassers = entry->passed[WHITE];
+	u64 blackPassers = entry->passed[BLACK];
+	
+	u8 sq, index, file, rank, distance;
+	S_SCORE rankBonus;
+	float coef;
+	S_SCORE whiteEval = 0;
+	S_SCORE blackEval = 0;
 	u8 promDist;
 	
 	// White
 	while(whitePassers != 0){
 		
-		file = FIRST_BIT_TO_FILE_MASK[whitePassers];
-		rank = (wPPos[file+1] & 0xFF00) >> 8;
-		index = FR2SQ(file, rank);
+		sq = LSB(whitePassers);
+		whitePassers &= whitePassers - 1;
+		file = FilesBrd[sq];
+		rank = RanksBrd[sq];
+		index = SQ120(sq);
 		
-		rankBonus = (gamePhase >= PHASE_ENDING) ? PASSED_RANK_BONUS[rank] : PASSED_RANK_BONUS[rank] / 2;
+		rankBonus = EvalWeights.passedRank[rank];
+		coef = 1;
 		
 		whiteEval += rankBonus;
 		
-		if((wPPos[file+1] & 0xFF) != rank){
-			whiteEval += (gamePhase >= PHASE_ENDING) ? PASSED_RANK_BONUS[wPPos[file+1] & 0xFF] : PASSED_RANK_BONUS[wPPos[file+1] & 0xFF] / 2;
-		}
-		
 		// The passer is blocked so remove half the bonus
 		if(pos->pieces[index + 10] != EMPTY){
-			whiteEval -= rankBonus / 2;
+			whiteEval -= ScaleScore(rankBonus, 1, 2);
+			coef -= 0.5f;
 		}
 		
 		// Protected passer
-		if((WB[SQ64(index)] & PAWN_BIT) != 0){
-			whiteEval += rankBonus / 2;
+		if((entry->attacks[WHITE] >> sq) & 1){
+			whiteEval += ScaleScore(rankBonus, 1, 2);
+			coef += 0.5f;
 		}
 		
 		// Check how far the passed pawn is from the enemy king
-		// the farther the better, and more is given if it is an ending
-		if(gamePhase <= PHASE_MIDDLE){
-			whiteEval += (rankBonus * abs(FilesBrd[SQ64(pos->kingSq[BLACK])] - file)) / 14;
-		}
-		else{ // Ending
-			whiteEval += (rankBonus * abs(FilesBrd[SQ64(pos->kingSq[BLACK])] - file)) / 10;					
-		}
+		// the farther the better, and more is given in the ending
+		distance = abs(FilesBrd[SQ64(pos->kingSq[BLACK])] - file);
+		whiteEval += SCORE(SCORE_MG(rankBonus) * distance / 14, SCORE_EG(rankBonus) * distance / 10);
+		
+		TRACE_PAIR(passedRank[rank], coef + distance / 14.0f, coef + distance / 10.0f);
 		
 		// If no pieces left (i.e. pawn ending) check if the opponent
-		// king can catch the passer, do not do this if this is the least advanced of a doubled passer
+		// king can catch the passer
 		if(gamePhase == PHASE_PAWN_ENDING){
 			
 			promDist = 7 - rank; // Moves to promotion
@@ -854,39 +832,36 @@ static s16 EvaluatePassers(const S_BOARD *pos){
 			}
 			
 		}
-		
-		whitePassers ^= FILE_TO_BIT_MASK[file];
 	}
 	
 	// Black
 	while(blackPassers != 0){
 		
-		file = FIRST_BIT_TO_FILE_MASK[blackPassers];
-		rank = (bPPos[file+1] & 0xFF00) >> 8;
-		index = FR2SQ(file, rank);
+		sq = LSB(blackPassers);
+		blackPassers &= blackPassers - 1;
+		file = FilesBrd[sq];
+		rank = RanksBrd[sq];
+		index = SQ120(sq);
 		
-		rankBonus = (gamePhase >= PHASE_ENDING) ? PASSED_RANK_BONUS[7 - rank] : PASSED_RANK_BONUS[7 - rank] / 2;
+		rankBonus = EvalWeights.passedRank[7 - rank];
+		coef = 1;
 		
 		blackEval += rankBonus;
 		
-		if((bPPos[file+1] & 0xFF) != rank){
-			blackEval += (gamePhase >= PHASE_ENDING) ? PASSED_RANK_BONUS[7 - (bPPos[file+1] & 0xFF)] : PASSED_RANK_BONUS[7 - (bPPos[file+1] & 0xFF)] / 2;
-		}
-		
 		if(pos->pieces[index - 10] != EMPTY){
-			blackEval -= rankBonus / 2;
+			blackEval -= ScaleScore(rankBonus, 1, 2);
+			coef -= 0.5f;
 		}
 		
-		if((BB[SQ64(index)] & PAWN_BIT) != 0){
-			blackEval += rankBonus / 2;
+		if((entry->attacks[BLACK] >> sq) & 1){
+			blackEval += ScaleScore(rankBonus, 1, 2);
+			coef += 0.5f;
 		}
 		
-		if(gamePhase <= PHASE_MIDDLE){
-			blackEval += (rankBonus * abs(FilesBrd[SQ64(pos->kingSq[WHITE])] - file)) / 14;
-		}
-		else{
-			blackEval += (rankBonus * abs(FilesBrd[SQ64(pos->kingSq[WHITE])] - file)) / 10;					
-		}
+		distance = abs(FilesBrd[SQ64(pos->kingSq[WHITE])] - file);
+		blackEval += SCORE(SCORE_MG(rankBonus) * distance / 14, SCORE_EG(rankBonus) * distance / 10);
+		
+		TRACE_PAIR(passedRank[7 - rank], -coef - distance / 14.0f, -coef - distance / 10.0f);
 		
 		
 		if(gamePhase == PHASE_PAWN_ENDING){
@@ -902,8 +877,6 @@ static s16 EvaluatePassers(const S_BOARD *pos){
 				b_bestPromDist = MIN(b_bestPromDist, promDist);
 			}
 		}
-		
-		blackPassers ^= FILE_TO_BIT_MASK[file];
 	}
 	
 	passerEval = whiteEval - blackEval;
@@ -912,944 +885,295 @@ static s16 EvaluatePassers(const S_BOARD *pos){
 }
 
 /**
- * Fills the WB array with attacks from the white knight and
- * calculates and returns the mobility of the piece.
+ * Fills the piece bitboards and the occupancy from the piece lists and clears the attack maps.
  * 
- * @param pos The position's pointer the white knight is in.
- * @param square The square it is on.
- * @return mobility_total The total mobility value of the piece.
+ * @param pos The position's pointer.
  */
-static s8 GenerateAttackWhiteKnight(const S_BOARD *pos, u8 square){
+static void InitEvalBitboards(const S_BOARD *pos){
 	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == wN);
+	u8 piece, index;
 	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s8 mobility_total = 0;
-	u8 attackedSquare;
+	Occupied[WHITE] = pos->pawns[WHITE];
+	Occupied[BLACK] = pos->pawns[BLACK];
+	PieceBB[wP] = pos->pawns[WHITE];
+	PieceBB[bP] = pos->pawns[BLACK];
 	
-	// Loop through the 8 different deltas
-	for(u8 i = 0; i < 8; i++){
+	for(piece = wN; piece <= bK; piece++){
 		
-		attackedSquare = square + KnDir[i];
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			// Add the attack
-			WB[SQ64(attackedSquare)] |= MINOR_BIT;
-			WB[SQ64(attackedSquare)]++;
-			
-			// If square is empty add mobility
-			if(pos->pieces[attackedSquare] == EMPTY){
-			
-				mobility_all++;
-				if((BB[SQ64(attackedSquare)] & PAWN_BIT) == 0){
-					mobility_safe++;
-				}
-			}
-		}				
-	}
-	
-	// The total mobility is 2 times the safe mobility plus the unsafe mobility
-	mobility_total = (2 * mobility_safe + mobility_all);
-	
-	// If the piece only can move to one safe square it's mobility is so restricted
-	// that it is likely to be trapped so penalize this
-	if(mobility_safe == 1){
+		if(piece == bP) continue;
 		
-		// A 'trapped' piece further up on the board is worse than closer to home
-		// since it risks being captured further up
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5) /2;
+		PieceBB[piece] = 0ULL;
+		for(index = 0; index < pos->pceNum[piece]; index++) SETBIT(PieceBB[piece], SQ64(pos->pList[piece][index]));
+		Occupied[PieceCol[piece]] |= PieceBB[piece];
 	}
 	
-	// If the piece have no safe squares it is just as good as trapped so penalize
-	// this even harder
-	else if(mobility_safe == 0){
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5);
-	}
+	Occupied[BOTH] = Occupied[WHITE] | Occupied[BLACK];
 	
-	return mobility_total;
+	for(index = 0; index < 7; index++) AttackMap[WHITE][index] = AttackMap[BLACK][index] = 0ULL;
 }
 
+/*
+ *  The piece square scores of all pieces are summed at once. PieceSquare[][] is the table of every
+ *  piece (the black scores are negative and mirrored, and EMPTY is 0) so the sum of the table over
+ *  the 64 squares of the board is the score of white minus black. The AVX2 version reads a rank of
+ *  the board (8 pieces) at a time and gathers the scores of the table by the pieces and the squares,
+ *  a packed score is two int16 values so the lanes add the middle game and ending values together.
+ *  The scalar version sums the pieces one by one from the piece bitboards, it is the version of any
+ *  CPU and the only one that adds the coefficients to the trace.
+ */
+
 /**
- * Fills the BB array with attacks from the black knight and
- * calculates and returns the mobility of the piece.
- * 
- * @param pos The position's pointer the black knight is in.
- * @param square The square it is on
- * @return mobility_total The total mobility value of the piece
+ * Builds the piece square table of every piece from the weights, it must be called whenever the weights change.
  */
-static s8 GenerateAttackBlackKnight(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == bN);
-	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s8 mobility_total = 0;
-	u8 attackedSquare;
+void InitPieceSquare(){
 	
-	for(u8 i = 0; i < 8; i++){
+	u8 piece, sq;
 	
-		attackedSquare = square + KnDir[i];
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			BB[SQ64(attackedSquare)] |= MINOR_BIT;
-			BB[SQ64(attackedSquare)]++;
-			
-			if(pos->pieces[(attackedSquare)] == EMPTY){
-			
-				mobility_all++;
-				if((WB[SQ64(attackedSquare)] & PAWN_BIT) == 0){
-				
-					mobility_safe++;
-				}
-			}
+	for(sq = 0; sq < 64; sq++){
+		PieceSquare[EMPTY][sq] = 0;
+		for(piece = wP; piece <= wK; piece++){
+			PieceSquare[piece][sq] = EvalWeights.pst[piece - wP][sq];
+			PieceSquare[piece + bP - wP][sq] = -EvalWeights.pst[piece - wP][MIRROR64(sq)];
 		}
 	}
-	
-	// The total mobility is 2 times the safe mobility plus the unsafe mobility
-	mobility_total = (2 * mobility_safe + mobility_all);
-	
-	// If the piece only can move to one safe square it's mobility is so restricted
-	// that it is likely to be trapped so penalize this
-	if(mobility_safe == 1){
-	
-		// A 'trapped' piece further up on the board is worse than closer to home
-		// since it risks being captured further up
-		mobility_total -= ((7 - RanksBrd[SQ64(square)] + 1) * 5) / 2;
-	}
-	
-	// If the piece have no safe squares it is just as good as trapped so penalize
-	// this even harder
-	else if(mobility_safe == 0){
-		mobility_total -= ((7 - RanksBrd[SQ64(square)] + 1) * 5);
-	}
-	
-	return mobility_total;
 }
 
 /**
- * Works same as for knights but check all squares in the direction of the delta.
+ * Sums the piece square scores of the pieces one by one.
  * 
- * It also detects pinned piecess.
- * 
- * @param pos The position's pointer the piece is in.
- * @param square The square the piece is on.
- * @return mobility_total The total mobility score of the piece.
+ * @param pos The position's pointer.
+ * @return The piece square score of white minus black.
  */
-static s16 GenerateAttackWhiteBishop(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == wB);
-	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s16 mobility_total = 0;
-	u8 attackedSquare;
-	u8 attackedPiece;
+static S_SCORE PieceSquareScalar(const S_BOARD *pos){
 	
-	for(u8 i = 0; i < 4; i++){
+	S_SCORE score = 0;
+	u8 type, sq;
+	u64 bb;
 	
-		attackedSquare = square + BiDir[i];
-		while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
+	for(type = wP; type <= wK; type++){
 		
-			WB[SQ64(attackedSquare)] |= MINOR_BIT;
-			WB[SQ64(attackedSquare)]++;
-			mobility_all++;
-			
-			if((BB[SQ64(attackedSquare)] & PAWN_BIT) == 0) mobility_safe++;
-			
-			attackedSquare += BiDir[i];
+		for(bb = PieceBB[type]; bb; bb &= bb - 1){
+			sq = LSB(bb);
+			score += EvalWeights.pst[type - wP][sq];
+			TRACE(pst[type - wP][sq], 1);
 		}
 		
-		// We exited the loop so check if we are still on the board
-		// if we are we ran into a piece and can add the final attack
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			WB[SQ64(attackedSquare)] |= MINOR_BIT;
-			WB[SQ64(attackedSquare)]++;
-			
-			
-			attackedPiece = pos->pieces[attackedSquare];
-			
-			// X-ray attack. If we ran into an own queen we keep checking squares behind it
-			// and add attacks to all empty squares. However we don't add mobility or attacks
-			// on opponent pieces since the piece can not actually reach there yet.
-			if(attackedPiece == wQ){
-			
-				attackedSquare += BiDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					WB[SQ64(attackedSquare)] |= MINOR_BIT;
-					WB[SQ64(attackedSquare)]++;
-					attackedSquare += BiDir[i];
-				}					
-			}
-			
-			// If the attacked piece is a enemy knight, rook or queen
-			// these are the type of pieces that can be pinned by a bishop
-			else if(attackedPiece == bN || attackedPiece == bR || attackedPiece == bQ){
-			
-				// Keep on going and see if we run in to the enemy king
-				// If we do the piece is pinned
-				attackedSquare += BiDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					attackedSquare += BiDir[i];
-				}
-				
-				if(!SQOFFBOARD(attackedSquare)){
-				
-					attackedPiece = pos->pieces[attackedSquare];
-					// If the attacked piece is a king queen or rook (less value than the bishop)
-					// the previous attacked piece is pinned
-					if(attackedPiece == bK || attackedPiece == bQ || attackedPiece == bR)	{				
-					
-						// Since this is the bishop pinning, we add a bonus to mobility
-						// which translate to negative for the side with the pinned piece
-						mobility_total += PINNED_PIECE;							
-					}
-				}	
-			}
+		for(bb = FLIP(PieceBB[type + bP - wP]); bb; bb &= bb - 1){
+			sq = LSB(bb);
+			score -= EvalWeights.pst[type - wP][sq];
+			TRACE(pst[type - wP][sq], -1);
 		}
 	}
 	
-	// The total mobility is 2 times the safe mobility plus the unsafe mobility
-	mobility_total += (2 * mobility_safe + mobility_all);
+	return score;
+}
+
+#ifdef USE_SIMD
+/**
+ * Sums the piece square scores of the board by AVX2, a rank at a time.
+ * 
+ * @param pos The position's pointer.
+ * @return The piece square score of white minus black.
+ */
+__attribute__((target("avx2")))
+static S_SCORE PieceSquareAVX2(const S_BOARD *pos){
 	
-	// If the piece only can move to one safe square it's mobility is so restricted
-	// that it is likely to be trapped so penalize this
-	if(mobility_safe == 1){
+	const __m256i files = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i sum = _mm256_setzero_si256(), index;
+	__m128i half;
+	u8 rank;
 	
-		// A 'trapped' piece further up on the board is worse than closer to home
-		// since it risks being captured further up
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5) / 2;
+	for(rank = RANK_1; rank <= RANK_8; rank++){
+		// The index of the table is piece * 64 + square
+		index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) &pos->pieces[FR2SQ(FILE_A, rank)]));
+		index = _mm256_add_epi32(_mm256_slli_epi32(index, 6), _mm256_add_epi32(files, _mm256_set1_epi32(8 * rank)));
+		sum = _mm256_add_epi32(sum, _mm256_i32gather_epi32((const int *) PieceSquare, index, sizeof(S_SCORE)));
 	}
 	
-	// If the piece have no safe squares it is just as good as trapped so penalize
-	// this even harder
-	else if(mobility_safe == 0){
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5);
-	}
+	half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
 	
-	return mobility_total;
+	return _mm_cvtsi128_si32(half);
+}
+#endif
+
+/**
+ * Adds the squares attacked by a piece (or by a set of pawns) to the attack maps of its side.
+ * 
+ * @param side The side of the attacker.
+ * @param type The ATTACK_* index of the attacker type.
+ * @param attacks The attacked squares.
+ */
+static void AddAttacks(const u8 side, const u8 type, const u64 attacks){
 	
+	AttackMap[side][ATTACK_TWICE] |= AttackMap[side][ATTACK_ALL] & attacks;
+	AttackMap[side][ATTACK_ALL] |= attacks;
+	AttackMap[side][type] |= attacks;
 }
 
+/**
+ * Adds the attacks of a knight, bishop, rook or queen to the attack maps and calculates its mobility.
+ * 
+ * The mobility counts the empty squares the piece can move to, and the safe ones (not attacked by a
+ * lesser enemy piece) count more. A piece that has only one safe square or none is likely to be
+ * trapped, so it is penalized more the further up the board it is. The x-ray attacks behind own
+ * sliders are added to the attack maps but not to the mobility since the piece can't reach them yet.
+ * 
+ * Bishops and rooks also get the pinnedPiece weight for every enemy piece they pin to a more valuable one, the
+ * pinned piece must be of a type that can't capture back along the line.
+ * 
+ * @param side The side of the piece.
+ * @param piece The white piece of the same type (wN, wB, wR or wQ).
+ * @param sq The square (64) the piece is on.
+ * @return mobility The mobility value of the piece.
+ */
+static S_SCORE PieceAttacks(const u8 side, const u8 piece, const u8 sq){
+	
+	u8 own = side * (bP - wP);
+	u8 enemy = (side ^ 1) * (bP - wP);
+	u64 *enemyAttacks = AttackMap[side ^ 1];
+	u64 occupied = Occupied[BOTH];
+	u64 reach, attacks, xray, unsafe, diagonal, straight, pinned = 0ULL, targets = 0ULL;
+	S_SCORE mobility = 0;
+	u8 type;
+	
+	switch(piece){
+		case wN:
+			reach = attacks = KnightAttacks[sq];
+			unsafe = enemyAttacks[ATTACK_PAWN];
+			type = ATTACK_MINOR;
+			break;
+		
+		case wB:
+			reach = attacks = BishopAttacks(sq, occupied);
+			if((xray = attacks & PieceBB[wQ + own])) attacks |= BishopAttacks(sq, occupied ^ xray);
+			pinned = reach & (PieceBB[wN + enemy] | PieceBB[wR + enemy] | PieceBB[wQ + enemy]);
+			if(pinned) targets = BishopAttacks(sq, occupied ^ pinned) & ~reach & (PieceBB[wK + enemy] | PieceBB[wQ + enemy] | PieceBB[wR + enemy]);
+			unsafe = enemyAttacks[ATTACK_PAWN];
+			type = ATTACK_MINOR;
+			break;
+		
+		case wR:
+			reach = attacks = RookAttacks(sq, occupied);
+			if((xray = attacks & (PieceBB[wR + own] | PieceBB[wQ + own]))) attacks |= RookAttacks(sq, occupied ^ xray);
+			pinned = reach & (PieceBB[wN + enemy] | PieceBB[wB + enemy] | PieceBB[wQ + enemy]);
+			if(pinned) targets = RookAttacks(sq, occupied ^ pinned) & ~reach & (PieceBB[wK + enemy] | PieceBB[wQ + enemy]);
+			unsafe = enemyAttacks[ATTACK_PAWN] | enemyAttacks[ATTACK_MINOR];
+			type = ATTACK_ROOK;
+			break;
+		
+		default:
+			diagonal = BishopAttacks(sq, occupied);
+			straight = RookAttacks(sq, occupied);
+			reach = attacks = diagonal | straight;
+			if((xray = diagonal & (PieceBB[wQ + own] | PieceBB[wB + own]))) attacks |= BishopAttacks(sq, occupied ^ xray);
+			if((xray = straight & (PieceBB[wQ + own] | PieceBB[wR + own]))) attacks |= RookAttacks(sq, occupied ^ xray);
+			unsafe = enemyAttacks[ATTACK_PAWN] | enemyAttacks[ATTACK_MINOR] | enemyAttacks[ATTACK_ROOK];
+			type = ATTACK_QUEEN;
+			break;
+	}
+	
+	AddAttacks(side, type, attacks);
+	
+	// Since this is the piece pinning, we add a bonus to mobility
+	// which translate to negative for the side with the pinned piece
+	mobility += EvalWeights.pinnedPiece * POPCOUNT(targets);
+	TRACE(pinnedPiece, SIGN(side) * POPCOUNT(targets));
+	
+	// The total mobility is the safe mobility plus the unsafe mobility, the safe squares count more
+	reach &= ~occupied;
+	u8 mobilitySafe = POPCOUNT(reach & ~unsafe);
+	mobility += EvalWeights.mobilitySafe * mobilitySafe + EvalWeights.mobility * POPCOUNT(reach);
+	TRACE(mobilitySafe, SIGN(side) * mobilitySafe);
+	TRACE(mobility, SIGN(side) * POPCOUNT(reach));
+	
+	// A 'trapped' piece further up on the board is worse than closer to home
+	// since it risks being captured further up
+	u8 rank = side == WHITE ? RanksBrd[sq] : RANK_8 - RanksBrd[sq];
+	if(mobilitySafe == 1){
+		mobility -= ScaleScore(EvalWeights.lowMobility, rank + 1, 2);
+		TRACE(lowMobility, -SIGN(side) * (rank + 1) / 2.0f);
+	}else if(mobilitySafe == 0){
+		mobility -= (rank + 1) * EvalWeights.lowMobility;
+		TRACE(lowMobility, -SIGN(side) * (rank + 1));
+	}
+	
+	return mobility;
+}
 
 /**
- * Works same as for knights but check all squares in the direction of the delta.
+ * Counts the enemy pieces attacking the squares around the king of the side.
  * 
- * It also detects pinned pieces.
+ * Every square next to the king that is attacked adds one count, and one more if it is only protected
+ * by the king. The squares in front of the king add another count if no own piece stands there. The
+ * types of the attackers of these squares and of the three squares two ranks in front of the king make
+ * the pattern that gives the extra count of the dangerous combinations from KING_ATTACK_PATTERN.
  * 
- * @param pos The position's pointer the piece is in.
- * @param square The square the piece is on.
- * @return mobility_total The total mobility score of the piece.
+ * @param pos The position's pointer to check.
+ * @param side The side of the king.
+ * @return totalAttack The total value from the attacking pieces (is negated before returned so it can be added to kingSafety).
  */
-static s16 GenerateAttackBlackBishop(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == bB);
+static S_SCORE KingAttack(const S_BOARD *pos, const u8 side){
 	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s16 mobility_total = 0;
-	u8 attackedSquare;
-	u8 attackedPiece;
+	u8 king = SQ64(pos->kingSq[side]);
+	u64 *enemyAttacks = AttackMap[side ^ 1];
+	u64 zone = KingAttacks[king];
 	
-	for(u8 i = 0; i < 4; i++){
-	
-		attackedSquare = square + BiDir[i];
-		while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-		
-			BB[SQ64(attackedSquare)] |= MINOR_BIT;
-			BB[SQ64(attackedSquare)]++;
-			mobility_all++;
-			
-			if((WB[SQ64(attackedSquare)] & PAWN_BIT) == 0) mobility_safe++;
-			
-			attackedSquare += BiDir[i];
-		}
-		
-		// We exited the loop so check if we are still on the board
-		// if we are we ran into a piece and can add the final attack
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			BB[SQ64(attackedSquare)] |= MINOR_BIT;
-			BB[SQ64(attackedSquare)]++;
-			
-
-			attackedPiece = pos->pieces[attackedSquare];
-			
-			// X-ray attack
-			if(attackedPiece == bQ){
-			
-				attackedSquare += BiDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					BB[SQ64(attackedSquare)] |= MINOR_BIT;
-					BB[SQ64(attackedSquare)]++;
-					attackedSquare += BiDir[i];
-				}
-			}
-			
-			// SEE if the attacked piece is a enemy knight, rook or queen
-			// these are the type of pieces that can be pinned by a bishop				
-			else if(attackedPiece == wN || attackedPiece == wR || attackedPiece == wQ){
-			
-				// Keep on going and see if we run in to the enemy king
-				// If we do the piece is pinned
-				attackedSquare += BiDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-					attackedSquare += BiDir[i];
-				}
-				
-				if(!SQOFFBOARD(attackedSquare)){
-				
-					attackedPiece = pos->pieces[attackedSquare];
-					// If the attacked piece is a king, queen or rook (less value than the bishop)
-					// the previous attacked piece is pinned
-					if(attackedPiece == wK || attackedPiece == wQ || attackedPiece == wR){				
-					
-						// Since this is the bishop pinning, we add a bonus to mobility
-						// which translate to negative for the side with the pinned piece
-						mobility_total += PINNED_PIECE;							
-					}
-				}	
-			}
-		}
-	}
+	ASSERT(pos->pieces[pos->kingSq[side]] == (side == WHITE ? wK : bK));
 	
-	// The total mobility is 2 times the safe mobility plus the unsafe mobility
-	mobility_total += (2 * mobility_safe + mobility_all);
+	// The three squares in front of the king and the three squares two ranks in front of it
+	u64 row = (1ULL << king) | ((1ULL << king) << 1 & ~FILE_A_BB) | ((1ULL << king) >> 1 & ~FILE_H_BB);
+	u64 front = side == WHITE ? row << 8 : row >> 8;
+	u64 far = side == WHITE ? row << 16 : row >> 16;
 	
-	// If the piece only can move to one safe square it's mobility is so restricted
-	// that it is likely to be trapped so penalize this
-	if(mobility_safe == 1){
+	u64 attacked = zone & enemyAttacks[ATTACK_ALL];
+	u64 onlyKing = AttackMap[side][ATTACK_KING] & ~AttackMap[side][ATTACK_TWICE];
 	
-		// A 'trapped' piece further up on the board is worse than closer to home
-		// since it risks being captured further up
-		mobility_total -= ((7 - RanksBrd[SQ64(square)] + 1) * 5) / 2;
-	}
+	u8 attackedCount = POPCOUNT(attacked) + POPCOUNT(attacked & onlyKing) + POPCOUNT(attacked & front & ~Occupied[side]);
 	
-	// If the piece have no safe squares it is just as good as trapped so penalize
-	// this even harder
-	else if(mobility_safe == 0){
-		mobility_total -= ((7 - RanksBrd[SQ64(square)] + 1) * 5);
+	u8 type, pattern = 0;
+	for(type = ATTACK_PAWN; type <= ATTACK_KING; type++){
+		if(enemyAttacks[type] & (zone | far)) pattern |= 1 << type;
 	}
 	
-	return mobility_total;
+	attackedCount += KING_ATTACK_PATTERN[pattern];
 	
+	TRACE(kingAttack[attackedCount], -SIGN(side));
+	return -EvalWeights.kingAttack[attackedCount];
 }
 
 /**
- * Works same as for knights but check all squares in the direction of the delta.
- * 
- * It also detects pinned piecess.
+ * Returns the rank of the most backward pawn of the side on a file, that is the pawn which
+ * shelters a king on the file.
  * 
- * @param pos The position's pointer the piece is in.
- * @param square The square the piece is on.
- * @return mobility_total The total mobility score of the piece.
+ * @param entry The pawn structure entry of the position.
+ * @param side The side of the pawn.
+ * @param file The file of the pawn.
+ * @return The rank of the pawn, 0 if there is no pawn on the file.
  */
-static s16 GenerateAttackWhiteRook(const S_BOARD *pos, u8 square){
+static u8 ShelterRank(const S_PAWNENTRY *entry, const u8 side, const u8 file){
 	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == wR);
+	u64 pawn = entry->shelter[side] & (FILE_A_BB << file);
 	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s16 mobility_total = 0;
-	u8 attackedSquare;
-	u8 attackedPiece;
+	return pawn ? RanksBrd[LSB(pawn)] : 0;
+}
+
+/**
+ * Returns the rank of the most forward pawn of the side on a file, that is the pawn which
+ * storms the enemy king on the file.
+ * 
+ * @param pos The position's pointer.
+ * @param side The side of the pawn.
+ * @param file The file of the pawn.
+ * @return The rank of the pawn, 0 if there is no pawn on the file.
+ */
+static u8 StormRank(const S_BOARD *pos, const u8 side, const u8 file){
 	
-	for(u8 i = 0; i < 4; i++){
+	u64 pawns = pos->pawns[side] & (FILE_A_BB << file);
 	
-		attackedSquare = square + RkDir[i];
-		while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-		
-			WB[SQ64(attackedSquare)] |= ROOK_BIT;
-			WB[SQ64(attackedSquare)]++;
-			mobility_all++;
-			
-			if((BB[SQ64(attackedSquare)] & (PAWN_BIT | MINOR_BIT)) == 0) mobility_safe++;
-			
-			attackedSquare += RkDir[i];
-		}
-		
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			WB[SQ64(attackedSquare)] |= ROOK_BIT;
-			WB[SQ64(attackedSquare)]++;
-			
-			attackedPiece = pos->pieces[attackedSquare];
-			
-			if(attackedPiece == wR || attackedPiece == wQ){
-			
-				attackedSquare += RkDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					WB[SQ64(attackedSquare)] |= ROOK_BIT;
-					WB[SQ64(attackedSquare)]++;
-					attackedSquare += RkDir[i];
-				}
-				
-			}else if(attackedPiece == bN || attackedPiece == bB || attackedPiece == bQ){
-				
-				attackedSquare += RkDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-					attackedSquare += RkDir[i];
-				}
-				
-				if(!SQOFFBOARD(attackedSquare)){
-				
-					attackedPiece = pos->pieces[attackedSquare];
-					if(attackedPiece == bK || attackedPiece == bQ) mobility_total += PINNED_PIECE;							
-					
-				}	
-			}
-		}
-	}
-	
-	mobility_total += (2 * mobility_safe + mobility_all);
-	
-	if(mobility_safe == 1){
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5) / 2;
-	}else if(mobility_safe == 0){
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1)* 5);
-	}
-	
-	return mobility_total;
-	
-}
-
-/**
- * Works same as for knights but check all squares in the direction of the delta.
- * 
- * It also detects pinned piecess.
- * 
- * @param pos The position's pointer the piece is in.
- * @param square The square the piece is on.
- * @return mobility_total The total mobility score of the piece.
- */
-static s16 GenerateAttackBlackRook(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == bR);
-	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s16 mobility_total = 0;
-	u8 attackedSquare;
-	u8 attackedPiece;
-	
-	for(s32 i = 0; i < 4; i++){
-		
-		attackedSquare = square + RkDir[i];
-		while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-		
-			BB[SQ64(attackedSquare)] |= ROOK_BIT;
-			BB[SQ64(attackedSquare)]++;
-			mobility_all++;
-			
-			if((WB[SQ64(attackedSquare)] & (PAWN_BIT | MINOR_BIT)) == 0) mobility_safe++;
-			
-			attackedSquare += RkDir[i];
-		}
-		
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			BB[SQ64(attackedSquare)] |= ROOK_BIT;
-			BB[SQ64(attackedSquare)]++;
-			
-			attackedPiece = pos->pieces[attackedSquare];
-			
-			if(attackedPiece == bR || attackedPiece == bQ){
-			
-				attackedSquare += RkDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					BB[SQ64(attackedSquare)] |= ROOK_BIT;
-					BB[SQ64(attackedSquare)]++;	
-					attackedSquare += RkDir[i];
-				}
-				
-			}else if(attackedPiece == wN || attackedPiece == wB || attackedPiece == wQ){
-				
-				attackedSquare += RkDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-					attackedSquare += RkDir[i];
-				}
-				
-				if(!SQOFFBOARD(attackedSquare)){
-				
-					attackedPiece = pos->pieces[attackedSquare];
-					if(attackedPiece == wK || attackedPiece == wQ) mobility_total += PINNED_PIECE;							
-					
-				}	
-			}
-		}
-	}
-	
-	mobility_total += (2 * mobility_safe + mobility_all);
-	
-	if(mobility_safe == 1){
-		mobility_total -= (( 7 - RanksBrd[SQ64(square)] + 1) * 5) / 2;
-	}
-	else if(mobility_safe == 0){
-		mobility_total -= (( 7 - RanksBrd[SQ64(square)] + 1) * 5);
-	}
-	
-	return mobility_total;
-	
-}
-
-/**
- * Works same as for knights but check all squares in the direction of the delta.
- * 
- * No detection for pinned pieces for queens (only thing they can pin against is
- * king and this should be quite uncommon, temporary and not very dangerous).
- * 
- * @param pos The position's pointer the piece is in.
- * @param square The square the piece is on.
- * @return mobility_total The total mobility score of the piece.
- */
-static s16 GenerateAttackWhiteQueen(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == wQ);
-	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s16 mobility_total = 0;
-	u8 attackedSquare;
-	u8 attackedPiece;
-	
-	for(u8 i = 0; i < 8; i++){
-		
-		attackedSquare = square + KiDir[i];    // Queen has the same deltals of King but it is a sliding piece
-		while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-		
-			WB[SQ64(attackedSquare)] |= QUEEN_BIT;
-			WB[SQ64(attackedSquare)]++;
-			mobility_all++;
-			
-			if((BB[SQ64(attackedSquare)] & (PAWN_BIT | MINOR_BIT | ROOK_BIT)) == 0 ){
-			
-				mobility_safe++;
-			}	
-			
-			attackedSquare += KiDir[i];
-		}
-		
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			WB[SQ64(attackedSquare)] |= QUEEN_BIT;
-			WB[SQ64(attackedSquare)]++;
-			
-			attackedPiece = pos->pieces[attackedSquare];
-			
-			if(attackedPiece == wQ || (attackedPiece == wR && i <= 3) || (attackedPiece == wB && i >= 4)){
-			
-				attackedSquare += KiDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					WB[SQ64(attackedSquare)] |= QUEEN_BIT;
-					WB[SQ64(attackedSquare)]++;
-					attackedSquare += KiDir[i];
-				}
-			}
-		}
-	}
-	
-	mobility_total += (2 * mobility_safe + mobility_all);
-	
-	if(mobility_safe == 1){
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5) / 2;
-	}
-	else if(mobility_safe == 0){
-		mobility_total -= ((RanksBrd[SQ64(square)] + 1) * 5);
-	}
-	
-	return mobility_total;
-	
-}
-
-/**
- * Works same as for knights but check all squares in the direction of the delta.
- * 
- * No detection for pinned pieces for queens (only thing they can pin against is
- * king and this should be quite uncommon, temporary and not very dangerous).
- * 
- * @param pos The position's pointer the piece is in.
- * @param square The square the piece is on.
- * @return mobility_total The total mobility score of the piece.
- */
-static s16 GenerateAttackBlackQueen(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == bQ);
-	
-	u8 mobility_all = 0;
-	u8 mobility_safe = 0;
-	s16 mobility_total = 0;
-	u8 attackedSquare;
-	u8 attackedPiece;
-	
-	for(u8 i = 0; i < 8; i++){
-	
-		attackedSquare = square + KiDir[i];  // Queen has the same deltals of King but it is a sliding piece
-		while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-		
-			BB[SQ64(attackedSquare)] |= QUEEN_BIT;
-			BB[SQ64(attackedSquare)]++;
-			mobility_all++;
-			
-			if((WB[SQ64(attackedSquare)] & (PAWN_BIT | MINOR_BIT | ROOK_BIT)) == 0){
-				mobility_safe++;
-			}	
-			
-			attackedSquare += KiDir[i];
-		}
-		
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			BB[SQ64(attackedSquare)] |= QUEEN_BIT;
-			BB[SQ64(attackedSquare)]++;
-			
-			attackedPiece = pos->pieces[attackedSquare];
-			
-			// if(attackedPiece == bR || attackedPiece == bQ)
-			if(attackedPiece == bQ || (attackedPiece == bB && i >= 4) || (attackedPiece == bR && i <= 3)){
-			
-				attackedSquare += KiDir[i];
-				while(!SQOFFBOARD(attackedSquare) && pos->pieces[attackedSquare] == EMPTY){
-				
-					BB[SQ64(attackedSquare)] |= QUEEN_BIT;
-					BB[SQ64(attackedSquare)]++;
-					attackedSquare += KiDir[i];
-				}
-			}
-		}
-	}
-	
-	mobility_total += (2 * mobility_safe + mobility_all);
-	
-	if(mobility_safe == 1){
-		mobility_total -= ((7 - RanksBrd[SQ64(square)] + 1) * 5) / 2;
-	}else if(mobility_safe == 0){
-		mobility_total -= ((7 - RanksBrd[SQ64(square)] + 1) * 5);
-	}
-	
-	return mobility_total;
-	
-}
-
-/**
- * Fills the WB array with attacks from the white king.
- * 
- * @param pos The position's pointer the white king is in.
- * @param square The square it is on.
- * @return mobility_total The total mobility value of the piece.
- */
-static void GenerateAttackWhiteKing(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == wK);
-	
-	u8 attackedSquare;
-	
-	// Loop through the 8 different deltas
-	for(u8 i = 0; i < 8; i++){
-	
-		attackedSquare = square + KiDir[i];
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			// Add the attack
-			WB[SQ64(attackedSquare)] |= KING_BIT;
-			WB[SQ64(attackedSquare)]++;
-		}				
-	}
-}
-
-/**
- * Fills the BB array with attacks from the black king.
- * 
- * @param pos The position's pointer the black king is in.
- * @param square The square it is on.
- * @return mobility_total The total mobility value of the piece.
- */
-static void GenerateAttackBlackKing(const S_BOARD *pos, u8 square){
-	
-	ASSERT(SqIs120(square));
-	ASSERT(SqOnBoard(square));
-	ASSERT(pos->pieces[square] == bK);
-	
-	u8 attackedSquare;
-	
-	// Loop through the 8 different deltas
-	for(u8 i = 0; i < 8; i++){
-	
-		attackedSquare = square + KiDir[i];
-		if(!SQOFFBOARD(attackedSquare)){
-		
-			// Add the attack
-			BB[SQ64(attackedSquare)] |= KING_BIT;
-			BB[SQ64(attackedSquare)]++;
-		}				
-	}
-}
-
-/**
- * Counts the pieces attacking the squares around the white king.
- * 
- * @param pos The position's pointer to check.
- * @return totalAttack The total value from the attacking pieces (is negated before returned so it can be added to kingSafety).
- */
-static s16 WhiteKingAttack(const S_BOARD *pos){
-
-	s16 totalAttack = 0;
-	u8 attackedCount = 0;
-	u8 flag = 0;
-	u8 kingIndex = pos->kingSq[WHITE];
-	u8 attackedIndex;
-	
-	ASSERT(SqIs120(kingIndex));
-	ASSERT(SqOnBoard(kingIndex));
-	ASSERT(pos->pieces[kingIndex] == wK);
-
-	// Inital attack count depending on where the king is located is not needed
-	// in MCHE since this is handled by the piecetables
-	
-	// Start with squares two squares in front of the king
-	// Here we only gather what type of pieces is attacking, we
-	// do not increase the attackers count
-	attackedIndex = kingIndex + 19;
-	if(!SQOFFBOARD(attackedIndex)) flag |= BB[SQ64(attackedIndex)];
-	
-	attackedIndex = kingIndex + 20;
-	if(!SQOFFBOARD(attackedIndex)) flag |= BB[SQ64(attackedIndex)];
-	
-	attackedIndex = kingIndex + 21;
-	if(!SQOFFBOARD(attackedIndex)) flag |= BB[SQ64(attackedIndex)];
-	
-	
-	// Now we check the squares to the left, right and behind the king
-	// Here we increase the attackedCount for every square that is attacked
-	// and one more if it is also only protected by the own king
-	attackedIndex = kingIndex + 1;	// Right
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 1;	// Left
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 9;	// Left behind
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 10;	// Behind
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 11;	// Right behind
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	// Now we do the squares just in front of the king, it works
-	// the same as before but we also add one count if no own piece is placed there
-	attackedIndex = kingIndex + 9;	// Left front
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(pos->pieces[attackedIndex] == EMPTY || PieceCol[pos->pieces[attackedIndex]] == BLACK) attackedCount++; 	// Empty square or enemy piece just in front of the king
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex + 10;	// Front
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(pos->pieces[attackedIndex] == EMPTY || PieceCol[pos->pieces[attackedIndex]] == BLACK) attackedCount++; 	// Empty square or enemy piece just in front of the king
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex + 11;	// Right front
-	if(!SQOFFBOARD(attackedIndex) && BB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= BB[SQ64(attackedIndex)];
-		if(pos->pieces[attackedIndex] == EMPTY || PieceCol[pos->pieces[attackedIndex]] == BLACK) attackedCount++; 	// Empty square or enemy piece just in front of the king
-		if(WB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	// We now have all the information about the pieces attacking the squares
-	// around the king so time to evaluate
-	
-	// We get the attack pattern by shifting three steps in 'flag' so we
-	// only have the attacking pieces pattern left, then use the attackers mask
-	// to mask out anything 'left' of the piece bits 
-	// 
-	// The king_attack_pattern is built so the number we get from a certain set of pieces
-	//(the pattern) gives us an extra count, some combinations of pieces are
-	// more dangerous than others
-	attackedCount += KING_ATTACK_PATTERN[((flag >> 3) & ATTACKERS_MASK)]; 
-	
-	// Now we have the attacked count and can simply get the value of the
-	// attack from the KING_ATTACK_EVAL table
-	
-	totalAttack = KING_ATTACK_EVAL[attackedCount];
-	
-	
-	return -totalAttack;
-}
-
-/**
- * Counts the pieces attacking the squares around the black king.
- * 
- * @param pos The position's pointer to check.
- * @return totalAttack The total value from the attacking pieces (is negated before returned so it can be added to kingSafety).
- */
-static s16 BlackKingAttack(const S_BOARD *pos){
-	
-	
-	s16 totalAttack = 0;
-	u8 attackedCount = 0;
-	u8 flag = 0;
-	u8 kingIndex = pos->kingSq[BLACK];
-	u8 attackedIndex;
-	
-	ASSERT(SqIs120(kingIndex));
-	ASSERT(SqOnBoard(kingIndex));
-	ASSERT(pos->pieces[kingIndex] == bK);
-
-	// Inital attack count depending on where the king is located is not needed
-	// in MCHE since this is handled by the piecetables
-	
-	// Start with squares two squares in front of the king
-	// Here we only gather what type of pieces is attacking, we
-	// do not increase the attackers count
-	attackedIndex = kingIndex - 19;
-	if(!SQOFFBOARD(attackedIndex)) flag |= WB[SQ64(attackedIndex)];
-	
-	
-	attackedIndex = kingIndex - 20;
-	if(!SQOFFBOARD(attackedIndex)) flag |= WB[SQ64(attackedIndex)];
-	
-	
-	attackedIndex = kingIndex - 21;
-	if(!SQOFFBOARD(attackedIndex)) flag |= WB[SQ64(attackedIndex)];
-	
-	
-	// Now we check the squares to the left, right and behind the king
-	// Here we increase the attackedCount for every square that is attacked
-	// and one more if it is also only protected by the own king
-	attackedIndex = kingIndex + 1;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 1;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex + 9;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex + 10;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex + 11;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	// Now we do the squares just in front of the king, it works
-	// the same as before but we also add one count if no own piece is placed there
-	attackedIndex = kingIndex - 9;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(pos->pieces[attackedIndex] == EMPTY || PieceCol[pos->pieces[attackedIndex]] == WHITE) attackedCount++; 	// Empty square or enemy piece just in front of the king
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 10;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(pos->pieces[attackedIndex] == EMPTY || PieceCol[pos->pieces[attackedIndex]] == WHITE) attackedCount++; 	// Empty square or enemy piece just in front of the king
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedIndex = kingIndex - 11;
-	if(!SQOFFBOARD(attackedIndex) && WB[SQ64(attackedIndex)] != 0){
-	
-		attackedCount++;
-		flag |= WB[SQ64(attackedIndex)];
-		if(pos->pieces[attackedIndex] == EMPTY || PieceCol[pos->pieces[attackedIndex]] == WHITE) attackedCount++; 	// Empty square or enemy piece just in front of the king
-		if(BB[SQ64(attackedIndex)] == 129) attackedCount++; 	// 129 translates to 10000001 in binary form, meaning only one attacker, and that attacker is the king 
-	}
-	
-	attackedCount += KING_ATTACK_PATTERN[((flag >> 3) & ATTACKERS_MASK)];
-	totalAttack = KING_ATTACK_EVAL[attackedCount];
-	
-	
-	return -totalAttack;
+	if(!pawns) return 0;
+	return (side == WHITE) ? RanksBrd[MSB(pawns)] : RanksBrd[LSB(pawns)];
 }
 
 /**
@@ -1859,10 +1183,10 @@ static s16 BlackKingAttack(const S_BOARD *pos){
  * @param pos The position's pointer we're examining.
  * @return totalDefense The total defense value of the white king.
  */
-static s16 WhiteKingDefense(const S_BOARD *pos){
+static S_SCORE WhiteKingDefense(const S_BOARD *pos, const S_PAWNENTRY *entry){
 
-	s16 totalDefense = 0;
-	u8 pawnRank;
+	S_SCORE totalDefense = 0;
+	u8 pawnRank, file;
 	u8 king_index = pos->kingSq[WHITE];
 	u8 king_file  = FilesBrd[SQ64(king_index)];
 	u8 oking_file = FilesBrd[SQ64(pos->kingSq[BLACK])]; // Opponent's king
@@ -1870,33 +1194,27 @@ static s16 WhiteKingDefense(const S_BOARD *pos){
 	// White pawn shield
 
 	// Find the rank the pawn in front of the king is on
-	pawnRank = (wPPos[king_file+1] & 0xFF);
-	
-	// If there is no pawn in front of the king, penalize with 36
-	if(pawnRank == 0) totalDefense -= 36;
-	
-	// If there is a pawn in front of the king penalize with the number
-	// of ranks it has advanced
-	// e.g. advanced 2 ranks (on rank 4 (=3 on tboard))
-	// 36 - (7-3)*(7-3) = 20 penalty 
-	else totalDefense -= 36 - ((7 - pawnRank) * (7 - pawnRank));
-	
+	// If there is no pawn in front of the king the penalty is the highest,
+	// else the penalty grows with the number of ranks the pawn has advanced
+	// e.g. advanced 2 ranks (on rank 4 (=3 on the board)) the penalty is 20
+	pawnRank = ShelterRank(entry, WHITE, king_file);
+	totalDefense += EvalWeights.kingShelter[pawnRank];
+	TRACE(kingShelter[pawnRank], 1);
 	
 	// Look for the pawn to the right in front of the king, make sure
 	// we are not off board and do the same thing as above
 	if(king_file < FILE_H){
 	
-		pawnRank = (wPPos[king_file+1+1] & 0xFF);
-		if(pawnRank == 0) totalDefense -= 36;
-		else totalDefense -= 36 - ((7 - pawnRank) * (7 - pawnRank));
-		
+		pawnRank = ShelterRank(entry, WHITE, king_file + 1);
+		totalDefense += EvalWeights.kingShelter[pawnRank];
+		TRACE(kingShelter[pawnRank], 1);
 	}
 	
 	if(king_file > FILE_A){
 		
-		pawnRank = (wPPos[king_file] & 0xFF);
-		if(pawnRank == 0) totalDefense -= 36;
-		else totalDefense -= 36 - ((7 - pawnRank) * (7 - pawnRank));
+		pawnRank = ShelterRank(entry, WHITE, king_file - 1);
+		totalDefense += EvalWeights.kingShelter[pawnRank];
+		TRACE(kingShelter[pawnRank], 1);
 	}
 	
 	// Encourage proper placement of the bishop in fianchetto pawn structure
@@ -1906,19 +1224,28 @@ static s16 WhiteKingDefense(const S_BOARD *pos){
 	
 		// If the FILE_B pawn is on rank 3 and there is a bishop on B2, award
 		// points for proper fianchetto
-		if((wPPos[2] & 0xFF) == RANK_3 && pos->pieces[B2] == wB) totalDefense += 20;
+		if(ShelterRank(entry, WHITE, FILE_B) == RANK_3 && pos->pieces[B2] == wB){
+			totalDefense += EvalWeights.fianchetto;
+			TRACE(fianchetto, 1);
+		}
 		
 	}else if(king_file > FILE_E){ 							// King on kingside
 	
 		// If the FILE_G pawn is on rank 3 and there is a bishop on G2, award
 		// points for proper fianchetto
-		if((wPPos[7] & 0xFF) == RANK_3 && pos->pieces[G2] == wB) totalDefense += 20;
+		if(ShelterRank(entry, WHITE, FILE_G) == RANK_3 && pos->pieces[G2] == wB){
+			totalDefense += EvalWeights.fianchetto;
+			TRACE(fianchetto, 1);
+		}
 	}
 	
 	
 	// If the king is still on the original square, the F2 square is weak so
 	// the pawn should not be moved
-	if((king_index == E1 && pos->pieces[F2] != wP) || (king_index == D1 && pos->pieces[C2] != wP)) totalDefense -= 10;
+	if((king_index == E1 && pos->pieces[F2] != wP) || (king_index == D1 && pos->pieces[C2] != wP)){
+		totalDefense -= EvalWeights.kingWeakPawn;
+		TRACE(kingWeakPawn, -1);
+	}
 	
 	// If the kings are castled in different directions a pawn storm is benefitial
 	// so reduce the defense score if the opponent has advanced his pawns on that side
@@ -1926,9 +1253,12 @@ static s16 WhiteKingDefense(const S_BOARD *pos){
 	
 		// Since we're using "7-" here we need to make sure there's actually a pawn there
 		//(there was a bug where this check wasn't done and a non-existing pawn would give 5*7-0=35 instead of the correct 0)
-		totalDefense -= 5 * ((((bPPos[king_file+1] & 0xFF00) >> 8)   == 0)? 0 : 7 - ((bPPos[king_file+1] & 0xFF00) >> 8));
-		totalDefense -= 5 * ((((bPPos[king_file+1+1] & 0xFF00) >> 8) == 0)? 0 : 7 - ((bPPos[king_file+1+1] & 0xFF00) >> 8));
-		totalDefense -= 5 * ((((bPPos[king_file] & 0xFF00) >> 8)     == 0)? 0 : 7 - ((bPPos[king_file] & 0xFF00) >> 8));
+		for(file = MAX(king_file, FILE_B) - 1; file <= MIN(king_file + 1, FILE_H); file++){
+			pawnRank = StormRank(pos, BLACK, file);
+			if(pawnRank != 0) pawnRank = 7 - pawnRank;
+			totalDefense -= EvalWeights.pawnStorm[pawnRank];
+			TRACE(pawnStorm[pawnRank], -1);
+		}
 	}
 
 	
@@ -1943,42 +1273,39 @@ static s16 WhiteKingDefense(const S_BOARD *pos){
  * @param pos The position's pointer we're examining.
  * @return totalDefense The total defense value of the black king.
  */
-static s16 BlackKingDefense(const S_BOARD *pos){
+static S_SCORE BlackKingDefense(const S_BOARD *pos, const S_PAWNENTRY *entry){
 
-	s16 totalDefense = 0;
-	u8 pawnRank;
+	S_SCORE totalDefense = 0;
+	u8 pawnRank, file;
 	u8 king_index = pos->kingSq[BLACK];
 	u8 king_file  = FilesBrd[SQ64(king_index)];
 	u8 oking_file = FilesBrd[SQ64(pos->kingSq[WHITE])]; // Opponent's king
 
 	// Black pawn shield
 
-	// Find the rank the pawn in front of the king is on
-	pawnRank = (bPPos[king_file+1] & 0xFF);
-	
-	// If there is no pawn in front of the king, penalize with 36
-	if(pawnRank == 0) totalDefense -= 36;
-	
-	// If there is a pawn in front of the king penalize with the number
-	// of ranks it has advanced
-	// e.g. advanced 2 ranks (on rank 5 (=4 on the board))
-	// 36 - (4)*(4) = 20 penalty 
-	else totalDefense -= 36 - ((pawnRank) * (pawnRank));
+	// Find the rank the pawn in front of the king is on, the shelter is indexed by
+	// the rank from black's point of view
+	// e.g. advanced 2 ranks (on rank 5 (=4 on the board)) the penalty is 20
+	pawnRank = ShelterRank(entry, BLACK, king_file);
+	if(pawnRank != 0) pawnRank = 7 - pawnRank;
+	totalDefense += EvalWeights.kingShelter[pawnRank];
+	TRACE(kingShelter[pawnRank], -1);
 	
 	// Look for the pawn to the right in front of the king, make sure
 	// we are not off the board and do the same thing as above
 	if(king_file < FILE_H){
 	
-		pawnRank = (bPPos[king_file+1+1] & 0xFF);
-		if(pawnRank == 0) totalDefense -= 36;
-		else totalDefense -= 36 - ((pawnRank) * (pawnRank));
-		
+		pawnRank = ShelterRank(entry, BLACK, king_file + 1);
+		if(pawnRank != 0) pawnRank = 7 - pawnRank;
+		totalDefense += EvalWeights.kingShelter[pawnRank];
+		TRACE(kingShelter[pawnRank], -1);
 	}
 	if((king_file) > FILE_A){
 	
-		pawnRank = (bPPos[king_file] & 0xFF);
-		if(pawnRank == 0) totalDefense -= 36;
-		else totalDefense -= 36 - ((pawnRank) * (pawnRank));
+		pawnRank = ShelterRank(entry, BLACK, king_file - 1);
+		if(pawnRank != 0) pawnRank = 7 - pawnRank;
+		totalDefense += EvalWeights.kingShelter[pawnRank];
+		TRACE(kingShelter[pawnRank], -1);
 	}
 	
 	// Encourage proper placement of the bishop in fianchetto pawn structure
@@ -1988,24 +1315,37 @@ static s16 BlackKingDefense(const S_BOARD *pos){
 	
 		// If the FILE_B pawn is on rank 6 and there is a bishop on B2, award
 		// points for proper fianchetto
-		if((bPPos[2] & 0xFF) == RANK_6 && pos->pieces[B7] == bB) totalDefense += 20;
+		if(ShelterRank(entry, BLACK, FILE_B) == RANK_6 && pos->pieces[B7] == bB){
+			totalDefense += EvalWeights.fianchetto;
+			TRACE(fianchetto, -1);
+		}
 		
 	}else if(king_file > FILE_E){						// King on kingside
 	
 		// If the FILE_G pawn is on rank 6 and there is a bishop on G2, award
 		// points for proper fianchetto
-		if((bPPos[7] & 0xFF) == RANK_6 && pos->pieces[G7] == bB) totalDefense += 20;
+		if(ShelterRank(entry, BLACK, FILE_G) == RANK_6 && pos->pieces[G7] == bB){
+			totalDefense += EvalWeights.fianchetto;
+			TRACE(fianchetto, -1);
+		}
 	}
 	
 	// If the king is still on the original square, the F2 square is weak so
 	// the pawn should not be moved
-	if((king_index == E8 && pos->pieces[F7] != bP) || (king_index == D8 && pos->pieces[C7] != bP)) totalDefense -= 10;
+	if((king_index == E8 && pos->pieces[F7] != bP) || (king_index == D8 && pos->pieces[C7] != bP)){
+		totalDefense -= EvalWeights.kingWeakPawn;
+		TRACE(kingWeakPawn, 1);
+	}
 	
 	// If the kings are castled in different directions a pawn storm is benefitial
 	// so reduce the defense score if the opponent has advanced his pawns on that side
 	if(abs(king_file - oking_file) > 2){
 	
-		totalDefense -= 5 * (((wPPos[king_file+1] & 0xFF00) >> 8) + ((wPPos[king_file+1+1] & 0xFF00) >> 8) + ((wPPos[king_file] & 0xFF00) >> 8));
+		for(file = MAX(king_file, FILE_B) - 1; file <= MIN(king_file + 1, FILE_H); file++){
+			pawnRank = StormRank(pos, WHITE, file);
+			totalDefense -= EvalWeights.pawnStorm[pawnRank];
+			TRACE(pawnStorm[pawnRank], 1);
+		}
 	}
 
 	
@@ -2014,259 +1354,164 @@ static s16 BlackKingDefense(const S_BOARD *pos){
 }
 
 /**
- * Determines if two or more pieces are 'hanging' in the position for white,
+ * Determines if two or more pieces are 'hanging' in the position for the side,
  * hanging means either that the piece is not defended or attacked
  * by a lesser valued piece (rook attacked by a pawn for example).
  * 
- * @param pos The position's pointer.
+ * @param side The side of the pieces.
  * @return hungPiecePenalty.
  */
-static s16 WhiteHungPiece(const S_BOARD *pos){
-
-	u8 hungPiecesCount = 0;
-	s16 hungPiecePenalty = 0;
-	u8 square, i;
-	
-	// Knights
-	for(i = 0; i < pos->pceNum[wN]; i++){
+static S_SCORE HungPieces(const u8 side){
 	
-		square = pos->pList[wN][i];
-		if((BB[SQ64(square)] > 0 && WB[SQ64(square)] == 0) || (BB[SQ64(square)] & PAWN_BIT) > 0) hungPiecesCount++; 
-	}
+	u8 own = side * (bP - wP);
+	u64 *enemyAttacks = AttackMap[side ^ 1];
+	u64 threats = (enemyAttacks[ATTACK_ALL] & ~AttackMap[side][ATTACK_ALL]) | enemyAttacks[ATTACK_PAWN];
+	S_SCORE hungPiecePenalty = 0;
 	
-	// Bishops
-	for(i = 0; i < pos->pceNum[wB]; i++){
+	u8 hungPiecesCount = POPCOUNT((PieceBB[wN + own] | PieceBB[wB + own]) & threats);
+	threats |= enemyAttacks[ATTACK_MINOR];
+	hungPiecesCount += POPCOUNT(PieceBB[wR + own] & threats);
+	threats |= enemyAttacks[ATTACK_ROOK];
+	hungPiecesCount += POPCOUNT(PieceBB[wQ + own] & threats);
 	
-		square = pos->pList[wB][i];
-		if((BB[SQ64(square)] > 0 && WB[SQ64(square)] == 0) || (BB[SQ64(square)] & PAWN_BIT) > 0) hungPiecesCount++; 
+	if(hungPiecesCount == 2){
+		hungPiecePenalty -= EvalWeights.hungPieces;
+		TRACE(hungPieces, -SIGN(side));
+	}else if(hungPiecesCount > 2){
+		hungPiecePenalty -= 2*EvalWeights.hungPieces;
+		TRACE(hungPieces, -2 * SIGN(side));
 	}
 	
-	// Rooks
-	for(i = 0; i < pos->pceNum[wR]; i++){
-	
-		square = pos->pList[wR][i];
-		if((BB[SQ64(square)] > 0 && WB[SQ64(square)] == 0) || (BB[SQ64(square)] & PAWN_BIT) > 0 || (BB[SQ64(square)] & MINOR_BIT) > 0) hungPiecesCount++; 
-	}
-	
-	// Queens
-	for(i = 0; i < pos->pceNum[wQ]; i++){
-	
-		square = pos->pList[wQ][i];
-		if((BB[SQ64(square)] > 0 && WB[SQ64(square)] == 0) || (BB[SQ64(square)] & PAWN_BIT) > 0 || (BB[SQ64(square)] & MINOR_BIT) > 0 || (BB[SQ64(square)] & ROOK_BIT) > 0) hungPiecesCount++; 
-	}
-	
-	if(hungPiecesCount == 2) hungPiecePenalty -= HUNG_PIECE_PENALTY;
-	else if(hungPiecesCount > 2) hungPiecePenalty -= 2*HUNG_PIECE_PENALTY;
-	
 	return hungPiecePenalty;
 }
 
 /**
- * Determines if two or more pieces are 'hanging' in the position for black,
- * hanging means either that the piece is not defended or attacked
- * by a lesser valued piece (rook attacked by a pawn for example).
+ * Caculate the total evaluation value for a given board position.
  * 
  * @param pos The position's pointer.
- * @return hungPiecePenalty.
+ * @return finalEval
  */
-static s16 BlackHungPiece(const S_BOARD *pos){
-
-	u8 hungPiecesCount = 0;
-	s16 hungPiecePenalty = 0;
-	u8 square, i;
-	
-	// Knights
-	for(i = 0; i < pos->pceNum[bN]; i++){
+s16 EvalPosition(S_BOARD *pos){
 	
-		square = pos->pList[bN][i];
-		if((WB[SQ64(square)] > 0 && BB[SQ64(square)] == 0) || (WB[SQ64(square)] & PAWN_BIT) > 0) hungPiecesCount++; 
-	}
+	u64 profileTime = (EvalProfile != NULL) ? CYCLES() : 0;
 	
-	// Bishops
-	for(i = 0; i < pos->pceNum[bB]; i++){
+	// Everything that depends only on the piece counts is in the material entry,
+	// the tables are skipped while tracing since every term must add to the trace
+	S_MATERIALENTRY *materialEntry, traceMaterial;
 	
-		square = pos->pList[bB][i];
-		if((WB[SQ64(square)] > 0 && BB[SQ64(square)] == 0) || (WB[SQ64(square)] & PAWN_BIT) > 0) hungPiecesCount++; 
+	STAT_INC(pos->EvalTable->materialprobes);
+	if(EvalTrace != NULL){
+		materialEntry = &traceMaterial;
+		MaterialEval(pos, materialEntry);
+	}else if(!ProbeMaterial(pos, &materialEntry)){
+		MaterialEval(pos, materialEntry);
+		StoreMaterial(pos, materialEntry);
+	}else{
+		STAT_INC(pos->EvalTable->materialhits);
 	}
 	
-	// Rooks
-	for(i = 0; i < pos->pceNum[bR]; i++){
-	
-		square = pos->pList[bR][i];
-		if((WB[SQ64(square)] > 0 && BB[SQ64(square)] == 0) || (WB[SQ64(square)] & PAWN_BIT) > 0 || (WB[SQ64(square)] & MINOR_BIT) > 0) hungPiecesCount++; 
+	// The evaluations below don't depend on the weights, so nothing is traced for them
+	if(EvalTrace != NULL && ((materialEntry->flags & MATERIAL_DRAW) || materialEntry->evaluate != NULL)){
+		memset(EvalTrace, 0, EVAL_TRACE_SIZE * sizeof(float));
 	}
 	
-	// Queens
-	for(i = 0; i < pos->pceNum[bQ]; i++){
+	if(materialEntry->flags & MATERIAL_DRAW) return 0;
 	
-		square = pos->pList[bQ][i];
-		if((WB[SQ64(square)] > 0 && BB[SQ64(square)] == 0) || (WB[SQ64(square)] & PAWN_BIT) > 0 || (WB[SQ64(square)] & MINOR_BIT) > 0 || (WB[SQ64(square)] & ROOK_BIT) > 0) hungPiecesCount++; 
+	// The material configuration has its own evaluation
+	if(materialEntry->evaluate != NULL){
+		return (pos->side == WHITE) ? materialEntry->evaluate(pos) : -materialEntry->evaluate(pos);
 	}
 	
-	if(hungPiecesCount == 2) hungPiecePenalty -= HUNG_PIECE_PENALTY;
-	else if(hungPiecesCount >2) hungPiecePenalty -= 2*HUNG_PIECE_PENALTY;
-	
-	return hungPiecePenalty;
-}
-
-/**
- * Caculate the total evaluation value for a given board position.
- * 
- * @param pos The position's pointer.
- * @return finalEval
- */
-s16 EvalPosition(S_BOARD *pos){
-	
-	if(DrawByMaterial(pos,BOTH)) return 0;
-	
 	s16 finalEval = 0;
-	if(ProbeEval(pos, &finalEval)){
-		pos->EvalTable->evalhits++;
+	#ifdef USE_EVAL_TABLE
+	// An evaluation table of no entries disables the cache (e.g. to measure the evaluation speed)
+	u8 useTable = EvalTrace == NULL && pos->EvalTable->numEntriesEval != 0;
+	STAT_INC(pos->EvalTable->evalprobes);
+	if(useTable && ProbeEval(pos, &finalEval)){
+		STAT_INC(pos->EvalTable->evalhits);
 		return finalEval;
 	}
+	#endif
 	
-	u8 attackedSquare, i;
+	u8 i;
 	
-	for(i = 0; i < 64; i++) WB[i] = BB[i] = 0;
+	InitEvalBitboards(pos);
+	PROFILE(EVAL_PROF_MATERIAL);
 	
-	for(i = 0; i < 10; i++) wPPos[i] = bPPos[i] = 0;
+	// SEE if we have the pawn structure in the pawn hash, else evaluate
+	// the pawns and keep the bitboards of the pawn structure in the entry
+	S_PAWNENTRY *pawnEntry, tracePawns;
+	
+	STAT_INC(pos->EvalTable->pawnprobes);
+	if(EvalTrace != NULL){
+		pawnEntry = &tracePawns;
+		PawnStructure(pos, pawnEntry);
+	}else if(!ProbePawnEval(pos, &pawnEntry)){
+		PawnStructure(pos, pawnEntry);
+		StorePawnEval(pos, pawnEntry);
+	}else{
+		STAT_INC(pos->EvalTable->pawnhits);
+		#ifdef DEBUG
+		S_PAWNENTRY check;
+		PawnStructure(pos, &check);
+		ASSERT(check.structure[WHITE] == pawnEntry->structure[WHITE] && check.structure[BLACK] == pawnEntry->structure[BLACK]);
+		ASSERT(check.passed[WHITE] == pawnEntry->passed[WHITE] && check.passed[BLACK] == pawnEntry->passed[BLACK]);
+		#endif
+	}
 	
-	passers = 0;
+	// Record where the pawns attack
+	AddAttacks(WHITE, ATTACK_PAWN, pawnEntry->attacks[WHITE]);
+	AddAttacks(BLACK, ATTACK_PAWN, pawnEntry->attacks[BLACK]);
+	PROFILE(EVAL_PROF_PAWNS);
 	
 	w_bestPromDist = 100; // Initialize to a high value so we can change easily below
 	b_bestPromDist = 100;
 
-	s8 w_mobility = 0;
-	s8 b_mobility = 0;
-	s16 w_material = pos->material[WHITE]; // TODO: Handle material incrementally in makeMove and unmakeMove
-	s16 b_material = pos->material[BLACK];
-	s8 w_piecePos = 0;
-	s8 b_piecePos = 0;
-	s8 w_tropism = 0;
-	s8 b_tropism = 0;
-	s8 tempo = 0;
+	// Every term is a score of its middle game and ending values, the
+	// sum of all terms is tapered by the phase of the position at the end
+	S_SCORE w_mobility = 0;
+	S_SCORE b_mobility = 0;
+	S_SCORE w_material = materialEntry->material[WHITE];
+	S_SCORE b_material = materialEntry->material[BLACK];
+	S_SCORE w_piecePos = 0;
+	S_SCORE b_piecePos = 0;
+	S_SCORE w_tropism = 0;
+	S_SCORE b_tropism = 0;
+	S_SCORE tempo = 0;
 	
 	// Remember if there was a pawn on 2nd/7th rank,
 	// used to determine if placing a rook on 7th should be rewarded
-	u8 wPawnOnSecond = FALSE;
-	u8 bPawnOnSeventh = FALSE;
+	u8 wPawnOnSecond = (pos->pawns[WHITE] & 0x000000000000FF00ULL) != 0;
+	u8 bPawnOnSeventh = (pos->pawns[BLACK] & 0x00FF000000000000ULL) != 0;
 
-	u8 index,file,rank;
+	u8 index,file,rank,sq;
 	
 	// Get the phase the game is in
-	// TODO: Handle this incrementally in makeMove and unmakeMove
-	gamePhase = GetGamePhase(pos);
+	gamePhase = materialEntry->gamePhase;
+	u8 phase = materialEntry->phase;
 	
-	// Decide if we should use ordinary piece tables or endgame tables for evaluating piece positions
-	u8 useEndingTables;
-	if(gamePhase <= PHASE_MIDDLE) useEndingTables = FALSE;
-	else useEndingTables = TRUE;
+	// The piece square scores of all pieces, the tuner needs the coefficients of the scalar sums
+	S_SCORE pieceSquare = (EvalTrace != NULL) ? PieceSquareScalar(pos) : PieceSquareSum(pos);
+	PROFILE(EVAL_PROF_PIECESQ);
 	
 	// Evaluate trapped pieces
-	s16 w_trappedEval = WhiteTrapped(pos);
-	s16 b_trappedEval = BlackTrapped(pos);
-	
-	// Pawns
-	for(i = 0; i < pos->pceNum[wP]; i++){
-		
-		index = pos->pList[wP][i];
-		ASSERT(SqIs120(index));
-		ASSERT(SqOnBoard(index));
-		ASSERT(pos->pieces[index] == wP);
-		
-		// w_material += PAWN_VALUE; 													// Collect value
-		if(gamePhase >= PHASE_ENDING) w_material += 20; 								// Pawns are worth a bit extra in the ending
-		
-		if(!useEndingTables) w_piecePos += wP_POS[SQ64(index)]; 						// Evaluate its position
-		else w_piecePos += 0; 															// Position if it is an ending
-		
-		attackedSquare = index + 11; 													// Record where the pawn attacks
-		if(!SQOFFBOARD(attackedSquare)){
-			WB[SQ64(attackedSquare)]++;
-			WB[SQ64(attackedSquare)] |= PAWN_BIT;			
-		}
-		
-		attackedSquare = index + 9;
-		if(!SQOFFBOARD(attackedSquare)){
-			WB[SQ64(attackedSquare)]++;
-			WB[SQ64(attackedSquare)] |= PAWN_BIT;			
-		}
-		
-		rank = RanksBrd[SQ64(index)];
-		file = FilesBrd[SQ64(index)];
-		
-		// Add it to the pawn array for more pawn evaluation later
-		
-		// No pawn on this file so far, so add it as both most forward and most backward pawn on the file
-		if(wPPos[file + 1] == 0)wPPos[file+1] = 0 | rank | (rank << 8);
-		
-		// The new pawn is more backward then the old most backward pawn so add it
-		else if((wPPos[file+1] & 0xFF) > rank) wPPos[file+1] = (wPPos[file+1] & 0xFF00) | rank;
-		
-		// The new pawn is more forward than the old most forward pawn so add it
-		else if(((wPPos[file+1] & 0xFF00) >> 8) < rank) wPPos[file+1] = (wPPos[file+1] & 0xFF) | (rank << 8);
-		
-		if(rank == RANK_2) wPawnOnSecond = TRUE; // Atleast one pawn on the second rank so placing a rook/queen there might be worth it 
-	}
+	S_SCORE w_trappedEval = WhiteTrapped(pos);
+	S_SCORE b_trappedEval = BlackTrapped(pos);
+	PROFILE(EVAL_PROF_TRAPPED);
 	
-	for(i = 0; i < pos->pceNum[bP]; i++){
-		
-		index = pos->pList[bP][i];
-		ASSERT(SqIs120(index));
-		ASSERT(SqOnBoard(index));
-		ASSERT(pos->pieces[index] == bP);
-		
-		// b_material += PAWN_VALUE;
-		if(gamePhase >= PHASE_ENDING) b_material += 20; // Pawns are worth a bit extra in the ending
-		
-		if(!useEndingTables) b_piecePos += wP_POS[MIRROR64(SQ64(index))];
-		else b_piecePos += 0;
-		
-		attackedSquare = index - 11;
-		if(!SQOFFBOARD(attackedSquare)) {
-			BB[SQ64(attackedSquare)]++;
-			BB[SQ64(attackedSquare)] |= PAWN_BIT;			
-		}
-		
-		attackedSquare = index - 9;
-		if(!SQOFFBOARD(attackedSquare)) {
-			BB[SQ64(attackedSquare)]++;
-			BB[SQ64(attackedSquare)] |= PAWN_BIT;			
-		}
-		
-		rank = RanksBrd[SQ64(index)];
-		file = FilesBrd[SQ64(index)];
-		
-		if(bPPos[file + 1] == 0) bPPos[file+1] = 0 | rank | (rank << 8); 
-		else if((bPPos[file+1] & 0xFF) < rank) bPPos[file+1] = (bPPos[file+1] & 0xFF00) | rank;
-		else if(((bPPos[file+1] & 0xFF00) >> 8) > rank) bPPos[file+1] = (bPPos[file+1] & 0xFF) | (rank << 8);
-		
-		if(rank == RANK_7) bPawnOnSeventh = TRUE; // Atleast one pawn on the seventh rank so placing a rook/queen there might be worth it
-	}
-	
-	// The pawnPos arrays are now filled so we can evaluate the pawns
-	
-	// SEE if we have any information in the pawn hash
-	// Don't probe if no pawns (i.e. pawn zobrist = 0)
-	s8 wPStructure = 0;
-	s8 bPStructure = 0;
-	s16 passerEval = 0;
-	
-	if(!ProbePawnEval(pos, &wPStructure, &bPStructure, &passers)){
-		wPStructure = WhitePawnEval(pos);
-		bPStructure = BlackPawnEval(pos);
-		StorePawnEval(pos, wPStructure, bPStructure, passers);
-	}else{
-		pos->EvalTable->pawnhits++;
-		ASSERT(wPStructure == WhitePawnEval(pos));
-		ASSERT(bPStructure == BlackPawnEval(pos));
-	}
-	
-	passerEval = EvaluatePassers(pos);
+	S_SCORE wPStructure = pawnEntry->structure[WHITE];
+	S_SCORE bPStructure = pawnEntry->structure[BLACK];
+	S_SCORE passerEval = EvaluatePassers(pos, pawnEntry);
 	
 	// We now know if either side has an unstoppable passer so reward it
-	if(w_bestPromDist < b_bestPromDist) passerEval += 600;
-	else if(b_bestPromDist < w_bestPromDist) passerEval -= 600;
+	if(w_bestPromDist < b_bestPromDist){
+		passerEval += EvalWeights.unstoppablePasser;
+		TRACE(unstoppablePasser, 1);
+	}else if(b_bestPromDist < w_bestPromDist){
+		passerEval -= EvalWeights.unstoppablePasser;
+		TRACE(unstoppablePasser, -1);
+	}
+	PROFILE(EVAL_PROF_PASSERS);
 	
 	
 	// Knights
@@ -2277,23 +1522,23 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == wN);
 		
-		// w_material += KNIGHT_VALUE;
-		if(!useEndingTables) w_piecePos += wN_POS[SQ64(index)];
-		else w_piecePos += KNIGHT_POS_ENDING[SQ64(index)];
+		sq = SQ64(index);
 		
-		// The knight is placed on one of the outpost squares
-		if(wN_OUTPOST[SQ64(index)] != 0){
+		// The knight is placed on one of the outpost squares and no enemy pawn can ever attack it
+		if(EvalWeights.knightOutpost[sq] != 0 && !((pawnEntry->attackSpan[BLACK] >> sq) & 1)){
 			
 			// If the knight is protected by one pawn award the value in the array,
 			// if protected by two pawns award double the value, and award nothing if it
 			// is not protected by a pawn
 			// Outposts squares arn'nt on the edge of pos The position's pointer so, we don't need to SQOFFBOARD checking
-			if(pos->pieces[index - 9] == wP) w_piecePos += wN_OUTPOST[SQ64(index)];
-			if(pos->pieces[index - 11] == wP) w_piecePos += wN_OUTPOST[SQ64(index)];
+			u8 protectors = (pos->pieces[index - 9] == wP) + (pos->pieces[index - 11] == wP);
+			w_piecePos += protectors * EvalWeights.knightOutpost[sq];
+			TRACE(knightOutpost[sq], protectors);
 		}
 		
-		w_mobility += GenerateAttackWhiteKnight(pos, index);
-		w_tropism += TROPISM_KNIGHT[Distance(pos->kingSq[BLACK], index)];
+		w_mobility += PieceAttacks(WHITE, wN, sq);
+		w_tropism += EvalWeights.tropism[wN - wN][Distance(pos->kingSq[BLACK], index)];
+		TRACE(tropism[wN - wN][Distance(pos->kingSq[BLACK], index)], 1);
 	}
 	
 	for(i = 0; i < pos->pceNum[bN]; i++){
@@ -2303,18 +1548,18 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == bN);
 		
-		// b_material += KNIGHT_VALUE;
-		if(!useEndingTables) b_piecePos += wN_POS[MIRROR64(SQ64(index))];
-		else b_piecePos += KNIGHT_POS_ENDING[SQ64(index)];
+		sq = MIRROR64(SQ64(index));
 		
-		if(wN_OUTPOST[MIRROR64(SQ64(index))] != 0){
-
-			if(pos->pieces[index + 9] == bP) b_piecePos += wN_OUTPOST[MIRROR64(SQ64(index))];
-			if(pos->pieces[index + 11] == bP) b_piecePos += wN_OUTPOST[MIRROR64(SQ64(index))];
+		if(EvalWeights.knightOutpost[sq] != 0 && !((pawnEntry->attackSpan[WHITE] >> SQ64(index)) & 1)){
+			
+			u8 protectors = (pos->pieces[index + 9] == bP) + (pos->pieces[index + 11] == bP);
+			b_piecePos += protectors * EvalWeights.knightOutpost[sq];
+			TRACE(knightOutpost[sq], -protectors);
 		}
 		
-		b_mobility += GenerateAttackBlackKnight(pos, index);
-		b_tropism += TROPISM_KNIGHT[Distance(pos->kingSq[WHITE], index)];
+		b_mobility += PieceAttacks(BLACK, wN, SQ64(index));
+		b_tropism += EvalWeights.tropism[wN - wN][Distance(pos->kingSq[WHITE], index)];
+		TRACE(tropism[wN - wN][Distance(pos->kingSq[WHITE], index)], -1);
 	}
 	
 	
@@ -2326,12 +1571,11 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == wB);
 		
-		// w_material += BISHOP_VALUE;
-		if(!useEndingTables) w_piecePos += wB_POS[SQ64(index)];
-		else w_piecePos += BISHOP_POS_ENDING[SQ64(index)];
+		sq = SQ64(index);
 		
-		w_mobility += GenerateAttackWhiteBishop(pos, index);
-		w_tropism += TROPISM_BISHOP[Distance(pos->kingSq[BLACK], index)];
+		w_mobility += PieceAttacks(WHITE, wB, sq);
+		w_tropism += EvalWeights.tropism[wB - wN][Distance(pos->kingSq[BLACK], index)];
+		TRACE(tropism[wB - wN][Distance(pos->kingSq[BLACK], index)], 1);
 	}
 	
 	for(i = 0; i < pos->pceNum[bB]; i++){
@@ -2341,16 +1585,12 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == bB);
 		
-		// b_material += BISHOP_VALUE;
-		if(!useEndingTables) b_piecePos += wB_POS[MIRROR64(SQ64(index))];
-		else b_piecePos += BISHOP_POS_ENDING[SQ64(index)];
+		sq = MIRROR64(SQ64(index));
 		
-		b_mobility += GenerateAttackBlackBishop(pos, index);
-		b_tropism += TROPISM_BISHOP[Distance(pos->kingSq[WHITE], index)];
+		b_mobility += PieceAttacks(BLACK, wB, SQ64(index));
+		b_tropism += EvalWeights.tropism[wB - wN][Distance(pos->kingSq[WHITE], index)];
+		TRACE(tropism[wB - wN][Distance(pos->kingSq[WHITE], index)], -1);
 	}
-	// Bishop pair bonus
-	if(pos->pceNum[wB] >= 2) w_piecePos += BISHOP_PAIR;
-	if(pos->pceNum[bB] >= 2) b_piecePos += BISHOP_PAIR;
 	
 	
 	// Rooks
@@ -2361,30 +1601,41 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == wR);
 		
-		file = FilesBrd[SQ64(index)];
-		rank = RanksBrd[SQ64(index)];
+		sq = SQ64(index);
+		file = FilesBrd[sq];
+		rank = RanksBrd[sq];
 		ASSERT(FileRankValid(file));
 		ASSERT(FileRankValid(rank));
 		
-		// w_material += ROOK_VALUE;
-		if(!useEndingTables) w_piecePos += wR_POS[SQ64(index)];
-		else w_piecePos += 0;
 		
 		// Rook on file with only enemy pawns
-		if(wPPos[file +1] == 0 && bPPos[file +1] != 0) w_piecePos += ROOK_ON_SEMI;
+		if(!(pos->pawns[WHITE] & (FILE_A_BB << file)) && (pos->pawns[BLACK] & (FILE_A_BB << file))){
+			w_piecePos += EvalWeights.rookOnSemi;
+			TRACE(rookOnSemi, 1);
+		}
 		// Rook on open file
-		else if(wPPos[file +1] == 0) w_piecePos += ROOK_ON_OPEN;
+		else if(!(pos->pawns[WHITE] & (FILE_A_BB << file))){
+			w_piecePos += EvalWeights.rookOnOpen;
+			TRACE(rookOnOpen, 1);
+		}
 		
 		// Rook on seventh rank
-		if(rank == RANK_7 && (bPawnOnSeventh || RanksBrd[SQ64(pos->kingSq[BLACK])] == RANK_8)) w_piecePos += ROOK_ON_SEVENTH;
+		if(rank == RANK_7 && (bPawnOnSeventh || RanksBrd[SQ64(pos->kingSq[BLACK])] == RANK_8)){
+			w_piecePos += EvalWeights.rookOnSeventh;
+			TRACE(rookOnSeventh, 1);
+		}
 		
-		// TODO: Add bonus for rooks behind passed pawns
-		if(((passers & 0xFF00) >> 8) & FILE_TO_BIT_MASK[file]){ // If there is a passer in this file 
-			if((bPPos[file + 1] & 0xFF) < rank) w_piecePos += ROOK_BEHIND_PASSER; // Add bonus if the rook behined the passer
+		// Add bonus if the rook is behind the enemy passer of this file
+		if(pawnEntry->passed[BLACK] & (FILE_A_BB << file)){
+			if(RanksBrd[LSB(pawnEntry->passed[BLACK] & (FILE_A_BB << file))] < rank){
+				w_piecePos += EvalWeights.rookBehindPasser;
+				TRACE(rookBehindPasser, 1);
+			}
 		}
 		
-		w_mobility += GenerateAttackWhiteRook(pos, index);
-		w_tropism += TROPISM_ROOK[Distance(pos->kingSq[BLACK], index)];
+		w_mobility += PieceAttacks(WHITE, wR, sq);
+		w_tropism += EvalWeights.tropism[wR - wN][Distance(pos->kingSq[BLACK], index)];
+		TRACE(tropism[wR - wN][Distance(pos->kingSq[BLACK], index)], 1);
 		
 	}
 	
@@ -2395,26 +1646,35 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == bR);
 		
-		file = FilesBrd[SQ64(index)];
-		rank = RanksBrd[SQ64(index)];
+		sq = SQ64(index);
+		file = FilesBrd[sq];
+		rank = RanksBrd[sq];
 		ASSERT(FileRankValid(file));
 		ASSERT(FileRankValid(rank));
 		
-		// b_material += ROOK_VALUE;
-		if(!useEndingTables) b_piecePos += wR_POS[MIRROR64(SQ64(index))];
-		else b_piecePos += 0;
 		
-		if(bPPos[file +1] == 0 && wPPos[file +1] != 0) b_piecePos += ROOK_ON_SEMI;
-		else if(bPPos[file +1] == 0) b_piecePos += ROOK_ON_OPEN;
-		if(rank == RANK_2 && (wPawnOnSecond || RanksBrd[SQ64(pos->kingSq[WHITE])] == RANK_1)) b_piecePos += ROOK_ON_SEVENTH;
+		if(!(pos->pawns[BLACK] & (FILE_A_BB << file)) && (pos->pawns[WHITE] & (FILE_A_BB << file))){
+			b_piecePos += EvalWeights.rookOnSemi;
+			TRACE(rookOnSemi, -1);
+		}else if(!(pos->pawns[BLACK] & (FILE_A_BB << file))){
+			b_piecePos += EvalWeights.rookOnOpen;
+			TRACE(rookOnOpen, -1);
+		}
+		if(rank == RANK_2 && (wPawnOnSecond || RanksBrd[SQ64(pos->kingSq[WHITE])] == RANK_1)){
+			b_piecePos += EvalWeights.rookOnSeventh;
+			TRACE(rookOnSeventh, -1);
+		}
 		
-		// TODO: Add bonus for rooks behind passed pawns
-		if((passers & 0xFF) & FILE_TO_BIT_MASK[file]){
-			if((wPPos[file + 1] & 0xFF) > rank) b_piecePos += ROOK_BEHIND_PASSER;
+		if(pawnEntry->passed[WHITE] & (FILE_A_BB << file)){
+			if(RanksBrd[LSB(pawnEntry->passed[WHITE] & (FILE_A_BB << file))] > rank){
+				b_piecePos += EvalWeights.rookBehindPasser;
+				TRACE(rookBehindPasser, -1);
+			}
 		}
 		
-		b_mobility += GenerateAttackBlackRook(pos, index);
-		b_tropism += TROPISM_ROOK[Distance(pos->kingSq[WHITE], index)];
+		b_mobility += PieceAttacks(BLACK, wR, sq);
+		b_tropism += EvalWeights.tropism[wR - wN][Distance(pos->kingSq[WHITE], index)];
+		TRACE(tropism[wR - wN][Distance(pos->kingSq[WHITE], index)], -1);
 	}
 	
 	
@@ -2426,15 +1686,17 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == wQ);
 		
-		// w_material += QUEEN_VALUE;
-		if(!useEndingTables) w_piecePos += wQ_POS[SQ64(index)];
-		else w_piecePos += QUEEN_POS_ENDING[SQ64(index)];
+		sq = SQ64(index);
 		
 		// Queen on 7th
-		if(RanksBrd[SQ64(index)] == RANK_7 && (bPawnOnSeventh || RanksBrd[SQ64(pos->kingSq[BLACK])] == RANK_8)) w_piecePos += QUEEN_ON_SEVENTH;
+		if(RanksBrd[sq] == RANK_7 && (bPawnOnSeventh || RanksBrd[SQ64(pos->kingSq[BLACK])] == RANK_8)){
+			w_piecePos += EvalWeights.queenOnSeventh;
+			TRACE(queenOnSeventh, 1);
+		}
 		
-		w_mobility += GenerateAttackWhiteQueen(pos, index);
-		w_tropism += TROPISM_QUEEN[Distance(pos->kingSq[BLACK], index)];
+		w_mobility += PieceAttacks(WHITE, wQ, sq);
+		w_tropism += EvalWeights.tropism[wQ - wN][Distance(pos->kingSq[BLACK], index)];
+		TRACE(tropism[wQ - wN][Distance(pos->kingSq[BLACK], index)], 1);
 	}
 	
 	for(i = 0; i < pos->pceNum[bQ]; i++) {
@@ -2444,103 +1706,114 @@ s16 EvalPosition(S_BOARD *pos){
 		ASSERT(SqOnBoard(index));
 		ASSERT(pos->pieces[index] == bQ);
 		
-		// b_material += QUEEN_VALUE;
-		if(!useEndingTables) b_piecePos += wQ_POS[MIRROR64(SQ64(index))];
-		else b_piecePos += QUEEN_POS_ENDING[SQ64(index)];
+		sq = SQ64(index);
 		
-		if(RanksBrd[SQ64(index)] == RANK_2 && (wPawnOnSecond || RanksBrd[SQ64(pos->kingSq[WHITE])] == RANK_1)) b_piecePos += QUEEN_ON_SEVENTH;
+		if(RanksBrd[sq] == RANK_2 && (wPawnOnSecond || RanksBrd[SQ64(pos->kingSq[WHITE])] == RANK_1)){
+			b_piecePos += EvalWeights.queenOnSeventh;
+			TRACE(queenOnSeventh, -1);
+		}
 		
-		b_mobility += GenerateAttackBlackQueen(pos, index);
-		b_tropism += TROPISM_QUEEN[Distance(pos->kingSq[WHITE], index)];
+		b_mobility += PieceAttacks(BLACK, wQ, sq);
+		b_tropism += EvalWeights.tropism[wQ - wN][Distance(pos->kingSq[WHITE], index)];
+		TRACE(tropism[wQ - wN][Distance(pos->kingSq[WHITE], index)], -1);
 	}
 	
 	
 	// Kings
-	if(!useEndingTables) w_piecePos += wK_POS[SQ64(pos->kingSq[WHITE])];
-	else w_piecePos += KING_POS_ENDING[SQ64(pos->kingSq[WHITE])];
-	GenerateAttackWhiteKing(pos, pos->kingSq[WHITE]);
-
-	if(!useEndingTables) b_piecePos += wK_POS[MIRROR64(SQ64(pos->kingSq[BLACK]))];
-	else b_piecePos += KING_POS_ENDING[SQ64(pos->kingSq[BLACK])];
-	GenerateAttackBlackKing(pos, pos->kingSq[BLACK]);
-	
-	// King safety, only opening and middle game
-	s16 w_kingAttacked;
-	s16 b_kingAttacked;
-	s16 w_kingDefense;
-	s16 b_kingDefense;
-	if(gamePhase <= PHASE_MIDDLE) {
-		w_kingAttacked = WhiteKingAttack(pos); // Check for black pieces attacking the king
-		b_kingAttacked = BlackKingAttack(pos);
-		w_kingDefense = WhiteKingDefense(pos); // Check for general defense measures (pawn shield etc)
-		b_kingDefense = BlackKingDefense(pos);
-		
-		if(pos->side == WHITE){
-			if(b_kingAttacked <= -75) tempo += TEMPO;
-			tempo += TEMPO;
-		}else{
-			if(w_kingAttacked <= -75) tempo -= TEMPO;
-			tempo -= TEMPO;
-		}
-		
+	sq = SQ64(pos->kingSq[WHITE]);
+	AddAttacks(WHITE, ATTACK_KING, KingAttacks[sq]);
+
+	sq = SQ64(pos->kingSq[BLACK]);
+	AddAttacks(BLACK, ATTACK_KING, KingAttacks[sq]);
+	PROFILE(EVAL_PROF_ATTACKS);
+	
+	// King safety, its weights have no ending values so it fades out as the pieces are traded
+	S_SCORE w_kingAttacked = KingAttack(pos, WHITE); // Check for black pieces attacking the king
+	S_SCORE b_kingAttacked = KingAttack(pos, BLACK);
+	S_SCORE w_kingDefense = WhiteKingDefense(pos, pawnEntry); // Check for general defense measures (pawn shield etc)
+	S_SCORE b_kingDefense = BlackKingDefense(pos, pawnEntry);
+	
+	if(pos->side == WHITE){
+		u8 count = (SCORE_MG(b_kingAttacked) <= -75) ? 2 : 1;
+		tempo += count * EvalWeights.tempo;
+		TRACE(tempo, count);
 	}else{
-		w_kingAttacked = 0;
-		b_kingAttacked = 0;
-		w_kingDefense = 0;
-		b_kingDefense = 0;
+		u8 count = (SCORE_MG(w_kingAttacked) <= -75) ? 2 : 1;
+		tempo -= count * EvalWeights.tempo;
+		TRACE(tempo, -count);
 	}
+	PROFILE(EVAL_PROF_KING);
 	
-	s16 w_hungPiece;
-	s16 b_hungPiece;
+	S_SCORE w_hungPiece;
+	S_SCORE b_hungPiece;
 	
 	if(pos->side == WHITE) {
-		w_hungPiece = WhiteHungPiece(pos);
+		w_hungPiece = HungPieces(WHITE);
 		b_hungPiece = 0; // Only penalize the side moving for hung pieces
 	}else{
-		b_hungPiece = BlackHungPiece(pos);
+		b_hungPiece = HungPieces(BLACK);
 		w_hungPiece = 0; // Only penalize the side moving for hung pieces			
 	}
+	PROFILE(EVAL_PROF_HUNG);
 	
-	s16 totalEval = (w_material - b_material) + (w_trappedEval - b_trappedEval) +
-				(w_piecePos - b_piecePos) + (w_mobility - b_mobility) +
+	S_SCORE totalScore = (w_material - b_material) + (w_trappedEval - b_trappedEval) +
+				pieceSquare + (w_piecePos - b_piecePos) + (w_mobility - b_mobility) +
 				(wPStructure - bPStructure) + (w_kingAttacked - b_kingAttacked) +
 				(w_kingDefense - b_kingDefense) + (w_tropism - b_tropism) +
 				(w_hungPiece - b_hungPiece)+ tempo + passerEval;
 	
+	s16 totalEval = Taper(totalScore, phase);
 	
 	// Adjust the score for likelyhood of a draw
-	finalEval = DrawProbability(pos, totalEval);
+	finalEval = DrawProbability(pos, materialEntry, totalEval);
+	
+	// The taper and the adjustment scale all terms of the trace
+	if(EvalTrace != NULL){
+		float scale = (totalEval != 0) ? (float) finalEval / totalEval : 1.0f;
+		float mg = scale * phase / PHASE_MAX;
+		float eg = scale * (PHASE_MAX - phase) / PHASE_MAX;
+		for(u16 weight = 0; weight < EVAL_WEIGHTS_NUM; weight++){
+			EvalTrace[2 * weight] *= mg;
+			EvalTrace[2 * weight + 1] *= eg;
+		}
+	}
 	
 	// printing
 	#ifdef EVAL_DEBUG
+		// The terms are printed at the phase of the position
 		s16 drawProbAdjust = totalEval - finalEval;
 		
-		s16 wTempoEval = tempo < 0? 0 : tempo;
-		s16 bTempoEval = tempo < 0? tempo : 0;
+		S_SCORE wTempoEval = Taper(tempo, phase) < 0 ? 0 : tempo;
+		S_SCORE bTempoEval = Taper(tempo, phase) < 0 ? tempo : 0;
 		
-		s16 totalWhite = w_material + w_trappedEval + w_piecePos + passerEval + w_mobility + wPStructure + w_kingAttacked +
+		S_SCORE totalWhite = w_material + w_trappedEval + w_piecePos + passerEval + w_mobility + wPStructure + w_kingAttacked +
 			w_kingDefense + w_tropism + w_hungPiece + wTempoEval;
-		s16 totalBlack = b_material + b_trappedEval + b_piecePos + passerEval + b_mobility + bPStructure + b_kingAttacked +
+		S_SCORE totalBlack = b_material + b_trappedEval + b_piecePos + passerEval + b_mobility + bPStructure + b_kingAttacked +
 		b_kingDefense + b_tropism + b_hungPiece + bTempoEval;
 
+		printf("Phase............. %5d/%d\n", phase, PHASE_MAX);
 		printf("                   White Black Total\n");
-		printf("Material.......... %5d %5d %5d\n", w_material, b_material, (w_material - b_material));
-		printf("Positioning....... %5d %5d %5d\n", w_piecePos, b_piecePos, (w_piecePos - b_piecePos));
-		printf("Trapped........... %5d %5d %5d\n", w_trappedEval, b_trappedEval, (w_trappedEval - b_trappedEval));
-		printf("Mobility.......... %5d %5d %5d\n", w_mobility, b_mobility, (w_mobility - b_mobility));
-		printf("Pawn structure.... %5d %5d %5d\n", wPStructure, bPStructure, (wPStructure - bPStructure));
-		printf("King attacked..... %5d %5d %5d\n", w_kingAttacked, b_kingAttacked, (w_kingAttacked - b_kingAttacked));
-		printf("King defense...... %5d %5d %5d\n", w_kingDefense, b_kingDefense, (w_kingDefense - b_kingDefense));
-		printf("Tropism........... %5d %5d %5d\n", w_tropism, b_tropism, (w_tropism - b_tropism));
-		printf("Hung pieces....... %5d %5d %5d\n", w_hungPiece, b_hungPiece, (w_hungPiece - b_hungPiece));
-		printf("Tempo............. %5d %5d %5d\n", wTempoEval, bTempoEval, tempo);
-		printf("Passing pawns..... %5d %5d %5d\n", 0, 0, passerEval);
-		printf("\nTotal eval........ %5d %5d %5d\n", totalWhite, totalBlack, totalEval);
+		printf("Material.......... %5d %5d %5d\n", Taper(w_material, phase), Taper(b_material, phase), Taper(w_material - b_material, phase));
+		printf("Piece squares..... %5d %5d %5d\n", 0, 0, Taper(pieceSquare, phase));
+		printf("Positioning....... %5d %5d %5d\n", Taper(w_piecePos, phase), Taper(b_piecePos, phase), Taper(w_piecePos - b_piecePos, phase));
+		printf("Trapped........... %5d %5d %5d\n", Taper(w_trappedEval, phase), Taper(b_trappedEval, phase), Taper(w_trappedEval - b_trappedEval, phase));
+		printf("Mobility.......... %5d %5d %5d\n", Taper(w_mobility, phase), Taper(b_mobility, phase), Taper(w_mobility - b_mobility, phase));
+		printf("Pawn structure.... %5d %5d %5d\n", Taper(wPStructure, phase), Taper(bPStructure, phase), Taper(wPStructure - bPStructure, phase));
+		printf("King attacked..... %5d %5d %5d\n", Taper(w_kingAttacked, phase), Taper(b_kingAttacked, phase), Taper(w_kingAttacked - b_kingAttacked, phase));
+		printf("King defense...... %5d %5d %5d\n", Taper(w_kingDefense, phase), Taper(b_kingDefense, phase), Taper(w_kingDefense - b_kingDefense, phase));
+		printf("Tropism........... %5d %5d %5d\n", Taper(w_tropism, phase), Taper(b_tropism, phase), Taper(w_tropism - b_tropism, phase));
+		printf("Hung pieces....... %5d %5d %5d\n", Taper(w_hungPiece, phase), Taper(b_hungPiece, phase), Taper(w_hungPiece - b_hungPiece, phase));
+		printf("Tempo............. %5d %5d %5d\n", Taper(wTempoEval, phase), Taper(bTempoEval, phase), Taper(tempo, phase));
+		printf("Passing pawns..... %5d %5d %5d\n", 0, 0, Taper(passerEval, phase));
+		printf("\nTotal eval........ %5d %5d %5d\n", Taper(totalWhite, phase), Taper(totalBlack, phase), totalEval);
 		printf("Adjusted to draw..     -     - %5d\n", drawProbAdjust);
 		printf("Final eval........     -     - %5d\n", finalEval);
 	#endif
 
-	StoreEval(pos, finalEval);
+	#ifdef USE_EVAL_TABLE
+	if(useTable) StoreEval(pos, finalEval);
+	#endif
+	PROFILE(EVAL_PROF_DRAW);
 	
 	if(pos->side == WHITE) return finalEval;
 	else return -finalEval;
@@ -2557,27 +1830,70 @@ s16 EvalPosition(S_BOARD *pos){
 s8 EvalMove(const S_BOARD *pos, const u8 from, const u8 to){
 	
 	ASSERT(PieceValid(pos->pieces[from]));
-	gamePhase = GetGamePhase(pos);
-	switch(pos->pieces[from]){
-		case wP: return ((wP_POS[SQ64(to)] - wP_POS[SQ64(from)]) / 10);
-		case bP: return ((wP_POS[MIRROR64(SQ64(to))] - wP_POS[MIRROR64(SQ64(from))]) / 10);
-		case wN: return ((wN_POS[SQ64(to)] - wN_POS[SQ64(from)]) / 10);
-		case bN: return ((wN_POS[MIRROR64(SQ64(to))] - wN_POS[MIRROR64(SQ64(from))]) / 10);
-		case wB: return ((wB_POS[SQ64(to)] - wB_POS[SQ64(from)]) / 10);
-		case bB: return ((wB_POS[MIRROR64(SQ64(to))] - wB_POS[MIRROR64(SQ64(from))]) / 10);
-		case wR: return ((wR_POS[SQ64(to)] - wR_POS[SQ64(from)]) / 10);
-		case bR: return ((wR_POS[MIRROR64(SQ64(to))] - wR_POS[MIRROR64(SQ64(from))]) / 10);
-		case wQ: return ((wQ_POS[SQ64(to)] - wQ_POS[SQ64(from)]) / 10);
-		case bQ: return ((wQ_POS[MIRROR64(SQ64(to))] - wQ_POS[MIRROR64(SQ64(from))]) / 10);
-		case wK: 
-			if(gamePhase > PHASE_MIDDLE) return ((KING_POS_ENDING[SQ64(to)] - KING_POS_ENDING[SQ64(from)]) / 10);
-			else return ((wK_POS[SQ64(to)] - wK_POS[SQ64(from)]) / 10);
-		case bK:
-			if(gamePhase > PHASE_MIDDLE) return ((KING_POS_ENDING[MIRROR64(SQ64(to))] - KING_POS_ENDING[MIRROR64(SQ64(from))]) / 10);
-			else return ((wK_POS[MIRROR64(SQ64(to))] - wK_POS[MIRROR64(SQ64(from))]) / 10);
-		
+	
+	u8 piece = pos->pieces[from];
+	u8 fromSq = SQ64(from);
+	u8 toSq = SQ64(to);
+	
+	// The tables are from white's point of view
+	if(PieceCol[piece] == BLACK){
+		piece -= bP - wP;
+		fromSq = MIRROR64(fromSq);
+		toSq = MIRROR64(toSq);
 	}
-} 
+	
+	// The change of the piece square score is tapered like the evaluation
+	S_SCORE delta = EvalWeights.pst[piece - wP][toSq] - EvalWeights.pst[piece - wP][fromSq];
+	
+	return Taper(delta, TaperPhase(pos)) / 10;
+}
 
+/**
+ * Sets the trace of the evaluations of the calling thread, every evaluation after it adds the
+ * coefficients of every weight it uses to the trace (the evaluation is about the sum of the middle
+ * game and ending values of the weights by their coefficients, from white's point of view). The
+ * coefficients of a weight are [2 * weight] for the middle game value and [2 * weight + 1] for the
+ * ending value, they are already tapered by the phase. The evaluation tables are not used while
+ * tracing. The tuner clears the trace before every evaluation.
+ * 
+ * @param trace The trace of EVAL_TRACE_SIZE coefficients, NULL to stop tracing.
+ */
+void SetEvalTrace(float *trace){
+	
+	EvalTrace = trace;
+}
 
+/**
+ * Selects the instruction set of the piece square sums of the evaluation, it is the best one
+ * that the CPU supports up to the given one. The scalar sums are used on any other CPU.
+ * 
+ * @param simd The best instruction set to use (SIMD_NONE or SIMD_AVX2).
+ * @return The instruction set that is used.
+ */
+u8 SetEvalSimd(const u8 simd){
+	
+	#ifdef USE_SIMD
+	__builtin_cpu_init();
+	
+	if(simd >= SIMD_AVX2 && __builtin_cpu_supports("avx2")){
+		PieceSquareSum = PieceSquareAVX2;
+		return SIMD_AVX2;
+	}
+	
+	#endif
+	
+	PieceSquareSum = PieceSquareScalar;
+	return SIMD_NONE;
+}
 
+/**
+ * Sets the profile of the evaluations of the calling thread, every evaluation after it adds the
+ * cycles (CYCLES()) spent in each group of its terms to the profile. The evaluations that end
+ * early (e.g. a draw by material, a cached evaluation) add only the groups done before.
+ * 
+ * @param profile The cycles of the EVAL_PROF_NUM groups of terms, NULL to stop profiling.
+ */
+void SetEvalProfile(u64 *profile){
+	
+	EvalProfile = profile;
+}
@@ -74,6 +74,24 @@ u64 GeneratePawnKey(const S_BOARD *pos){
 	return finalKey;
 }
 
-
-
-
+/**
+ * Returns a unique key for each material configuration
+ * by using Piece keys array, the keys are indexed by the number
+ * of the pieces instead of the square so the n-th piece of a type
+ * adds the key PieceKeys[piece][n - 1].
+ * 
+ * @param pos The position's pointer.
+ * @return 64bits materialKey
+ */
+u64 GenerateMaterialKey(const S_BOARD *pos){
+	
+	u8 piece, count;
+	u64 finalKey = 0ULL;
+	
+	for(piece = wP; piece <= bK; piece++){
+		for(count = 0; count < pos->pceNum[piece]; count++){
+			finalKey ^= PieceKeys[piece][count];
+		}
+	}
+	return finalKey;
+}
@@ -7,6 +7,7 @@
  */
 
 #include"defs.h"
+#include"string.h"
 
 /**
  * Returns a thinking line depends on prinsiple variation moves
@@ -106,6 +107,57 @@ void InitHashTable(S_HASHTABLE *table, const u8 MB){
 	
 }
 
+/**
+ * Returns TRUE if the score of a hash entry of the position can be used for the given search,
+ * an exact score or a bound outside the window that is searched deep enough.
+ * 
+ * @param pos THe position's pointer.
+ * @param entry The entry of the position.
+ * @param score The pointer of variable to retrieve the score of the entry.
+ * @param alpha The value of alpha for the given search.
+ * @param beta The value of beta for the given search.
+ * @param depth The depth of search, zero for quiescence search.
+ */
+static u8 ProbeBound(S_BOARD *pos, const S_HASHENTRY *entry, s16 *score, const s16 alpha, const s16 beta, const u8 depth){
+	
+	if(entry->depth < depth) return FALSE;
+	
+	pos->HashTable->hit++;
+	
+	ASSERT(entry->depth >= 0 && entry->depth < MAXDEPTH);
+	ASSERT(entry->flag >= HFNONE && entry->flag <= HFEXACT);
+	
+	*score = entry->score;
+	if(*score > TB_WIN_MIN) *score -= pos->ply;
+	else if(*score < -TB_WIN_MIN) *score += pos->ply;
+	
+	ASSERT(*score >= -INFINITY && *score <= INFINITY);
+	
+	switch(entry->flag){
+		
+		case HFEXACT:
+			return TRUE;
+		
+		case HFALPHA:
+			if(*score <= alpha){
+				*score = alpha;
+				return TRUE;
+			}
+			break;
+		
+		case HFBETA:
+			if(*score >= beta){
+				*score = beta;
+				return TRUE;
+			}
+			break;
+		
+		default: ASSERT(FALSE);
+	}
+	
+	return FALSE;
+}
+
 /**
  * Probe a hash entry in the two hash tables and returns entry information of a given position.
  * 
@@ -118,7 +170,7 @@ void InitHashTable(S_HASHTABLE *table, const u8 MB){
  * @param score The pointer of variable to retrieve the score of move.
  * @param alpha The value of alpha for the given search.
  * @param beta The value of beta for the given search.
- * @param depth The depth of search.
+ * @param depth The depth of search, zero for quiescence search.
  * @return TRUE if a stored entry found, FALSE if not.
  */
 u8 ProbeHashEntry(S_BOARD *pos, s32 *move, s16 *score, const s16 alpha, const s16  beta, const u8 depth){
@@ -129,85 +181,19 @@ u8 ProbeHashEntry(S_BOARD *pos, s32 *move, s16 *score, const s16 alpha, const s1
 	ASSERT(alpha < beta);
 	ASSERT(alpha >= -INFINITY && alpha <= INFINITY);
 	ASSERT(beta >= -INFINITY && beta <= INFINITY);
-	ASSERT(depth >= 1 && depth < MAXDEPTH);
+	ASSERT(depth >= 0 && depth < MAXDEPTH);
 	ASSERT(pos->ply >= 0 && pos->ply < MAXDEPTH);
 	
 	if(pos->HashTable->pTableA[index].posKey == pos->posKey){
 		*move = pos->HashTable->pTableA[index].move;
-		
-		if(pos->HashTable->pTableA[index].depth >= depth){
-			pos->HashTable->hit++;
-			
-			ASSERT(pos->HashTable->pTableA[index].depth >= 1 && pos->HashTable->pTableA[index].depth < MAXDEPTH);
-			ASSERT(pos->HashTable->pTableA[index].flag >= HFNONE && pos->HashTable->pTableA[index].flag <= HFEXACT);                                                                        
-			
-			*score = pos->HashTable->pTableA[index].score;
-			if(*score > ISMATE) *score -= pos->ply;
-			else if(*score < -ISMATE) *score += pos->ply;
-			
-			switch(pos->HashTable->pTableA[index].flag){
-				
-				ASSERT(*score >= -INFINITY && *score <= INFINITY);
-				
-				case HFEXACT:
-					return TRUE;
-				
-				case HFALPHA:
-					if(*score <= alpha){
-						*score = alpha;
-						return TRUE;
-					}
-					break;
-				
-				case HFBETA:
-					if(*score >= beta){
-						*score = beta;
-						return TRUE;
-					}
-					break;
-				
-				default: ASSERT(FALSE);
-			}
-			
-		}
-	}else if(pos->HashTable->pTableD[index].posKey == pos->posKey){
-		*move = pos->HashTable->pTableD[index].move;
-		
-		if(pos->HashTable->pTableD[index].depth >= depth){
-			pos->HashTable->hit++;
-			
-			ASSERT(pos->HashTable->pTableD[index].depth >= 1 && pos->HashTable->pTableD[index].depth < MAXDEPTH);
-			ASSERT(pos->HashTable->pTableD[index].flag >= HFNONE && pos->HashTable->pTableD[index].flag <= HFEXACT);                                                                        
-			
-			*score = pos->HashTable->pTableD[index].score;
-			if(*score > ISMATE) *score -= pos->ply;
-			else if(*score < -ISMATE) *score += pos->ply;
-			
-			switch(pos->HashTable->pTableD[index].flag){
-				
-				ASSERT(*score >= -INFINITY && *score <= INFINITY);
-				
-				case HFEXACT:
-					return TRUE;
-				
-				case HFALPHA:
-					if(*score <= alpha){
-						*score = alpha;
-						return TRUE;
-					}
-					break;
-				
-				case HFBETA:
-					if(*score >= beta){
-						*score = beta;
-						return TRUE;
-					}
-					break;
-				
-				default: ASSERT(FALSE);
-			}
-			
-		}
+		if(ProbeBound(pos, &pos->HashTable->pTableA[index], score, alpha, beta, depth)) return TRUE;
+	}
+	
+	// TableA may hold a shallower entry of the same position (e.g. from quiescence search),
+	// so TableD is still checked for a deeper one.
+	if(pos->HashTable->pTableD[index].posKey == pos->posKey){
+		if(pos->HashTable->pTableD[index].move != NOMOVE) *move = pos->HashTable->pTableD[index].move;
+		if(ProbeBound(pos, &pos->HashTable->pTableD[index], score, alpha, beta, depth)) return TRUE;
 	}
 	
 	return FALSE;
@@ -224,22 +210,27 @@ u8 ProbeHashEntry(S_BOARD *pos, s32 *move, s16 *score, const s16 alpha, const s1
  * @param pos THe position's pointer.
  * @param move The move to be stored for the given position.
  * @param score The score of the given move.
+ * @param eval The static evaluation of the position, -INFINITY if it was not evaluated.
  * @param flag The hash table flag related to the given move (HFALPHA, HFBETA, HFEXACT).
- * @param depth The depth of search.
+ * @param depth The depth of search, zero for quiescence search.
  */
-void StoreHashEntry(S_BOARD *pos, const s32 move, s16 score, const u8 flag, const u8 depth){
+void StoreHashEntry(S_BOARD *pos, s32 move, s16 score, const s16 eval, const u8 flag, const u8 depth){
 	
 	u32 index = pos->posKey % pos->HashTable->numEntries;
 	
 	ASSERT(index >= 0 && index <= pos->HashTable->numEntries - 1);
 	ASSERT(score >= -INFINITY && score <= INFINITY);
 	ASSERT(flag >= HFNONE && flag <= HFEXACT);
-	ASSERT(depth >= 1 && depth < MAXDEPTH);
+	ASSERT(depth >= 0 && depth < MAXDEPTH);
 	ASSERT(pos->ply >= 0 && pos->ply < MAXDEPTH);
 	
-	//Reset MATE score to INFINITY so we can adjuxt and use it in shallower search
-	if(score > ISMATE) score += pos->ply;
-	else if(score < -ISMATE) score -= pos->ply;
+	// Don't lose the move of the same position if the new entry has no move
+	if(move == NOMOVE && pos->HashTable->pTableA[index].posKey == pos->posKey) move = pos->HashTable->pTableA[index].move;
+	
+	//Reset MATE score to INFINITY so we can adjuxt and use it in shallower search, the tablebase wins
+	// depend on the ply too
+	if(score > TB_WIN_MIN) score += pos->ply;
+	else if(score < -TB_WIN_MIN) score -= pos->ply;
 	
 	if(pos->HashTable->pTableA[index].posKey == 0ULL){
 		
@@ -248,6 +239,7 @@ void StoreHashEntry(S_BOARD *pos, const s32 move, s16 score, const u8 flag, cons
 		pos->HashTable->pTableD[index].posKey = pos->posKey;
 		pos->HashTable->pTableD[index].move = move;
 		pos->HashTable->pTableD[index].score = score;
+		pos->HashTable->pTableD[index].eval = eval;
 		pos->HashTable->pTableD[index].flag = flag;
 		pos->HashTable->pTableD[index].depth = depth;
 		
@@ -258,6 +250,7 @@ void StoreHashEntry(S_BOARD *pos, const s32 move, s16 score, const u8 flag, cons
 		pos->HashTable->pTableD[index].posKey = pos->posKey;
 		pos->HashTable->pTableD[index].move = move;
 		pos->HashTable->pTableD[index].score = score;
+		pos->HashTable->pTableD[index].eval = eval;
 		pos->HashTable->pTableD[index].flag = flag;
 		pos->HashTable->pTableD[index].depth = depth;
 		
@@ -266,6 +259,7 @@ void StoreHashEntry(S_BOARD *pos, const s32 move, s16 score, const u8 flag, cons
 	pos->HashTable->pTableA[index].posKey = pos->posKey;
 	pos->HashTable->pTableA[index].move = move;
 	pos->HashTable->pTableA[index].score = score;
+	pos->HashTable->pTableA[index].eval = eval;
 	pos->HashTable->pTableA[index].flag = flag;
 	pos->HashTable->pTableA[index].depth = depth;
 	
@@ -294,6 +288,23 @@ s32 ProbePvTable(const S_BOARD *pos){
 	
 }
 
+/**
+ * Returns the deepest hash entry stored for a given position.
+ * 
+ * @param pos THe position's pointer.
+ * @return The pointer of the entry, NULL if the position isn't stored.
+ */
+S_HASHENTRY *GetHashEntry(const S_BOARD *pos){
+	
+	u32 index = pos->posKey % pos->HashTable->numEntries;
+	ASSERT(index >= 0 && index <= pos->HashTable->numEntries - 1);
+	
+	if(pos->HashTable->pTableD[index].posKey == pos->posKey) return &pos->HashTable->pTableD[index];
+	else if(pos->HashTable->pTableA[index].posKey == pos->posKey) return &pos->HashTable->pTableA[index];
+	else return NULL;
+	
+}
+
 /**
  * Clear all the entries of the evaluation table to ensure thers is no garbage.
  * 
@@ -305,10 +316,7 @@ void ClearEvalTable(S_EVALTABLE *table){
 	
 	for(pawnEntry = table->pPawnTable; pawnEntry < table->pPawnTable + table->numEntriesPawn; pawnEntry++){
 		
-		pawnEntry->pawnKey = 0ULL;
-		pawnEntry->whiteStructure   = 0;
-		pawnEntry->blackStructure  = 0;
-		pawnEntry->passers  = 0;
+		memset(pawnEntry, 0, sizeof(S_PAWNENTRY));
 	}
 	
 	S_EVALENTRY *evalEntry;
@@ -319,6 +327,9 @@ void ClearEvalTable(S_EVALTABLE *table){
 		evalEntry->eval   = 0;
 	
 	}
+	
+	// A cleared entry has the key 0, that no material configuration has since the kings are always on the board
+	memset(table->pMaterialTable, 0, MATERIAL_TABLE_SIZE * sizeof(S_MATERIALENTRY));
 
 }
 
@@ -336,15 +347,28 @@ void ClearEvalTable(S_EVALTABLE *table){
 void InitEvalTable(S_EVALTABLE *table, const u8 MB_PAWN, const u8 MB_EVAL){
 	
 	table->numEntriesPawn = (0x100000 * MB_PAWN) / sizeof(S_PAWNENTRY);
-	table->numEntriesEval = (0x100000 * MB_EVAL) / sizeof(S_EVALENTRY);
 	
 	//calling free() twice make a crash.
 	
 	table->pPawnTable = (S_PAWNENTRY *) malloc(table->numEntriesPawn * sizeof(S_PAWNENTRY));
+	table->pMaterialTable = (S_MATERIALENTRY *) malloc(MATERIAL_TABLE_SIZE * sizeof(S_MATERIALENTRY));
+	
+	#ifdef USE_EVAL_TABLE
+	table->numEntriesEval = (0x100000 * MB_EVAL) / sizeof(S_EVALENTRY);
 	table->pEvalTable = (S_EVALENTRY *) malloc(table->numEntriesEval * sizeof(S_EVALENTRY));
+	#else
+	// The hash table keeps the static evaluations, so the position evaluation table isn't allocated.
+	table->numEntriesEval = 0;
+	table->pEvalTable = NULL;
+	#endif
 	
 	SetColor(LIGHT_RED);
-	if(table->pPawnTable == NULL || table->pEvalTable == NULL){
+	#ifdef USE_EVAL_TABLE
+	// An evaluation table of 0 MB disables the cache of the evaluations
+	if(table->pPawnTable == NULL || (table->pEvalTable == NULL && MB_EVAL != 0) || table->pMaterialTable == NULL){
+	#else
+	if(table->pPawnTable == NULL || table->pMaterialTable == NULL){
+	#endif
 		if(MB_PAWN == 1 || MB_EVAL == 1){
 			printf("INFO: EvalTable Allocation Faild, memory isn't enough!!!");
 			exit(1);
@@ -355,7 +379,12 @@ void InitEvalTable(S_EVALTABLE *table, const u8 MB_PAWN, const u8 MB_EVAL){
 	}else{
 		ClearEvalTable(table);
 		printf("INFO: PawnTable Init Complete With %d Entries(%d MB).\n", table->numEntriesPawn, MB_PAWN);
+		printf("INFO: MaterialTable Init Complete With %d Entries.\n", MATERIAL_TABLE_SIZE);
+		#ifdef USE_EVAL_TABLE
 		printf("INFO: EvalTable Init Complete With %d Entries(%d MB).\n\n", table->numEntriesEval, MB_EVAL);
+		#else
+		printf("INFO: EvalTable is disabled, the hash table keeps the static evaluations.\n\n");
+		#endif
 	}
 	SetColor(LIGHT_GRAY);
 	
@@ -369,13 +398,25 @@ void InitEvalTable(S_EVALTABLE *table, const u8 MB_PAWN, const u8 MB_EVAL){
  * @param evalTable The pointer of evluation tables.
  */
 void CleanMemory(S_HASHTABLE *hashTable, S_EVALTABLE *evalTable){
+	FreeTables(hashTable, evalTable);
+	CleanPolyBook();
+	CleanTablebases();
+}
+
+/**
+ * Free all allocated memory of hash tables and evaluation tables, used for
+ * boards that don't own the opening book (e.g. test suite workers).
+ * 
+ * @param hashTable The pointer of hash tables.
+ * @param evalTable The pointer of evluation tables.
+ */
+void FreeTables(S_HASHTABLE *hashTable, S_EVALTABLE *evalTable){
 	free(hashTable->pTableA);
 	free(hashTable->pTableD);
 	
 	free(evalTable->pPawnTable);
 	free(evalTable->pEvalTable);
-	
-	CleanPolyBook();
+	free(evalTable->pMaterialTable);
 }
 
 /**
@@ -401,27 +442,22 @@ u8 ProbeEval(S_BOARD *pos, s16 *eval){
 }
 
 /**
- * Probe a pawn structure evaluation entry in the pawn structure tables and returns entry information of a given position.
+ * Probe a pawn structure entry in the pawn structure tables and returns the entry of a given position.
+ * The entry is returned even if it holds another pawn structure, so the caller can fill it in place
+ * and mark it with StorePawnEval().
  * 
  * @param pos THe position's pointer.
- * @param whiteStructure The pointer of variable to retrieve the white pawn structure evaluation value of the given position.
- * @param blackStructure The pointer of variable to retrieve the black pawn structure evaluation value of the given position.
- * @param passers The pointer of variable to retrieve the passer structure.
+ * @param entry The pointer of variable to retrieve the pointer of the pawn structure entry of the given position.
  * @return TRUE if a stored entry found, FALSE if not.
  */
-u8 ProbePawnEval(S_BOARD *pos, s8 *whiteStructure, s8 *blackStructure, u16 *passers){
+u8 ProbePawnEval(S_BOARD *pos, S_PAWNENTRY **entry){
 	
 	u32 index = pos->pawnKey % pos->EvalTable->numEntriesPawn;
 	ASSERT(index >= 0 && index <= pos->EvalTable->numEntriesPawn - 1);
 	
-	if(pos->EvalTable->pPawnTable[index].pawnKey == pos->pawnKey){
-		*whiteStructure = pos->EvalTable->pPawnTable[index].whiteStructure;
-		*blackStructure = pos->EvalTable->pPawnTable[index].blackStructure;
-		*passers = pos->EvalTable->pPawnTable[index].passers;
-		return TRUE;
-	}
+	*entry = &pos->EvalTable->pPawnTable[index];
 	
-	return FALSE;
+	return (*entry)->pawnKey == pos->pawnKey;
 }
 
 /**
@@ -440,27 +476,45 @@ void StoreEval(S_BOARD *pos, s16 eval){
 }
 
 /**
- * Store the evaluation value of a given position.
+ * Mark a pawn structure entry returned by ProbePawnEval() as the entry of a given position,
+ * after the pawn structure of the position is stored in it.
  *
  * @param pos THe position's pointer.
- * @param whiteStructure The white pawn structure evaluation value of the given position.
- * @param blackStructure The black pawn structure evaluation value of the given position.
- * @param passers The passer structure.
+ * @param entry The pawn structure entry of the given position.
  */
-void StorePawnEval(S_BOARD *pos, s8 whiteStructure, s8 blackStructure, u16 passers){
+void StorePawnEval(S_BOARD *pos, S_PAWNENTRY *entry){
 	
-	u32 index = pos->pawnKey % pos->EvalTable->numEntriesPawn;
-	ASSERT(index >= 0 && index <= pos->EvalTable->numEntriesPawn - 1);
+	ASSERT(entry == &pos->EvalTable->pPawnTable[pos->pawnKey % pos->EvalTable->numEntriesPawn]);
 	
-	pos->EvalTable->pPawnTable[index].pawnKey = pos->pawnKey;
-	pos->EvalTable->pPawnTable[index].whiteStructure = whiteStructure;
-	pos->EvalTable->pPawnTable[index].blackStructure = blackStructure;
-	pos->EvalTable->pPawnTable[index].passers = passers;
+	entry->pawnKey = pos->pawnKey;
 }
 
+/**
+ * Probe a material entry in the material table and returns the entry of a given position.
+ * The entry is returned even if it holds another material configuration, so the caller can
+ * fill it in place and mark it with StoreMaterial().
+ * 
+ * @param pos THe position's pointer.
+ * @param entry The pointer of variable to retrieve the pointer of the material entry of the given position.
+ * @return TRUE if a stored entry found, FALSE if not.
+ */
+u8 ProbeMaterial(S_BOARD *pos, S_MATERIALENTRY **entry){
+	
+	*entry = &pos->EvalTable->pMaterialTable[pos->materialKey % MATERIAL_TABLE_SIZE];
+	
+	return (*entry)->materialKey == pos->materialKey;
+}
 
-
-
-
-
-
+/**
+ * Mark a material entry returned by ProbeMaterial() as the entry of a given position,
+ * after the material information of the position is stored in it.
+ *
+ * @param pos THe position's pointer.
+ * @param entry The material entry of the given position.
+ */
+void StoreMaterial(S_BOARD *pos, S_MATERIALENTRY *entry){
+	
+	ASSERT(entry == &pos->EvalTable->pMaterialTable[pos->materialKey % MATERIAL_TABLE_SIZE]);
+	
+	entry->materialKey = pos->materialKey;
+}
@@ -8,6 +8,7 @@
 
 #include"defs.h"
 #include"stdlib.h"
+#include"math.h"
 
 
 u8 Sq120ToSq64[BRD_SQ_NUM];
@@ -275,6 +276,12 @@ u64 CastleKeys[16] = {
 u8 FilesBrd[64];
 u8 RanksBrd[64];
 
+u8 LmrTable[MAXDEPTH][MAXPOSITIONMOVES];
+
+u64 KnightAttacks[64];
+u64 KingAttacks[64];
+u64 RayMasks[8][64];
+
 S_OPTIONS EngineOptions[1];
 
  
@@ -291,6 +298,52 @@ static void InitFilesRanksBrd(){
 	
 }
 
+/**
+ * Late move reductions grow with the logarithm of both depth and move number,
+ * so the deeper searches reduce the late moves by more plies.
+ */
+static void InitLmrTable(){
+	
+	u16 depth, moveNum;
+	
+	for(depth = 0; depth < MAXDEPTH; depth++){
+		for(moveNum = 0; moveNum < MAXPOSITIONMOVES; moveNum++){
+			if(depth == 0 || moveNum == 0) LmrTable[depth][moveNum] = 0;
+			else LmrTable[depth][moveNum] = (u8)(log(depth) * log(moveNum) / LMR_TABLE_DIVISOR);
+		}
+	}
+	
+}
+
+/**
+ * The attack bitboards are built by walking the same directions as the move generator
+ * on the 120 board, so the board edges are handled by the off board squares.
+ */
+static void InitAttackMasks(){
+	
+	static const s8 RayDir[8] = {10, 1, 11, 9, -10, -1, -11, -9};
+	u8 sq, index, target;
+	
+	for(sq = 0; sq < 64; sq++){
+		
+		KnightAttacks[sq] = KingAttacks[sq] = 0ULL;
+		for(index = 0; index < 8; index++){
+			
+			target = SQ120(sq) + KnDir[index];
+			if(!SQOFFBOARD(target)) SETBIT(KnightAttacks[sq], SQ64(target));
+			
+			target = SQ120(sq) + KiDir[index];
+			if(!SQOFFBOARD(target)) SETBIT(KingAttacks[sq], SQ64(target));
+			
+			RayMasks[index][sq] = 0ULL;
+			for(target = SQ120(sq) + RayDir[index]; !SQOFFBOARD(target); target += RayDir[index]){
+				SETBIT(RayMasks[index][sq], SQ64(target));
+			}
+		}
+	}
+	
+}
+
 static void InitSq120To64(){
 	
 	u8 index = 0;
@@ -313,6 +366,35 @@ static void InitSq120To64(){
 
 }
 
+static void InitEngineOptions(){
+	
+	EngineOptions->UseTables = TRUE;
+	EngineOptions->UseNullMove = TRUE;
+	EngineOptions->UseKillers = TRUE;
+	EngineOptions->UseHistory = TRUE;
+	EngineOptions->UseEvalMove = TRUE;
+	EngineOptions->UseSEE = TRUE;
+	EngineOptions->NullMoveR = DEFAULT_NULLMOVE_R;
+	EngineOptions->LmrMoves = DEFAULT_LMR_MOVES;
+	EngineOptions->LmrDepth = DEFAULT_LMR_DEPTH;
+	EngineOptions->LmrReduction = DEFAULT_LMR_REDUCTION;
+	EngineOptions->UseLmrTable = TRUE;
+	EngineOptions->PawnExtension = DEFAULT_PAWN_EXTENSION;
+	EngineOptions->ThreatExtension = DEFAULT_THREAT_EXTENSION;
+	EngineOptions->UseRFP = TRUE;
+	EngineOptions->UseFutility = TRUE;
+	EngineOptions->UseRazoring = TRUE;
+	EngineOptions->UseLMP = TRUE;
+	EngineOptions->UseIID = TRUE;
+	EngineOptions->UseIIR = TRUE;
+	EngineOptions->UseSingular = TRUE;
+	EngineOptions->MultiPV = 1;
+	EngineOptions->UseCounterMove = TRUE;
+	EngineOptions->UseContHistory = TRUE;
+	EngineOptions->UseCaptureHistory = TRUE;
+	
+}
+
 /**
  * Initializing all used information arrays.
  *
@@ -320,8 +402,17 @@ static void InitSq120To64(){
 void AllInit(){
 	
 	InitSq120To64();
+	InitEngineOptions();
 	InitPolyBook();
 	InitFilesRanksBrd();
+	InitLmrTable();
+	InitAttackMasks();
+	InitEndgames();
+	InitKPKBitbase();
+	InitTablebases(TB_DIR);
+	LoadEvalWeights(WEIGHTS_FILE);
+	InitPieceSquare();
+	SetEvalSimd(SIMD_AVX2);
 	
 }
 
@@ -8,6 +8,8 @@
  */
 
 #include"defs.h"
+#include"string.h"
+#include"ctype.h"
 
 /**
  * A function to take a move in algebric form (ex. e2e4) and convert it to 
@@ -43,7 +45,7 @@ s32 ParseMove(const char *ptrchar, S_BOARD *pos){
 		
 		if(from == FROMSQ(move) && to == TOSQ(move)){
 			
-			promoted = PROMOTED(move);
+			promoted = PROMOTED(move, pos->side);
 			if(promoted != EMPTY){
 				
 				if(IsKn(promoted) && ptrchar[4] == 'n') return move;
@@ -62,6 +64,106 @@ s32 ParseMove(const char *ptrchar, S_BOARD *pos){
 	return NOMOVE;
 }
 
+/**
+ * A function to take a move in standard algebraic notation (ex. Nbd7, exd5, e8=Q+, O-O)
+ * or in coordinate form (ex. e2e4) and convert it to an integer form. It is used for
+ * reading the bm/am operations of EPD test suites.
+ *
+ * @param ptrchar The pinter to string, it ends by a space, ';', ',' or the end of string.
+ * @param pos The position's pointer.
+ * @return move, NOMOVE if the string doesn't match any legal move.
+ */
+s32 ParseSANMove(const char *ptrchar, S_BOARD *pos){
+	
+	ASSERT(CheckBoard(pos));
+	
+	// Copy the move without the capture, check and annotation symbols
+	char san[16];
+	u8 i, length = 0;
+	for(i = 0; ptrchar[i] != '\0' && !isspace((u8)ptrchar[i]) && ptrchar[i] != ';' && ptrchar[i] != ','; i++){
+		if(strchr("x+#!?=-", ptrchar[i]) != NULL) continue;
+		if(length < sizeof(san) - 1) san[length++] = ptrchar[i];
+	}
+	san[length] = '\0';
+	if(length < 2) return NOMOVE;
+	
+	// Coordinate form
+	if(length >= 4 && san[0] >= 'a' && san[0] <= 'h' && san[1] >= '1' && san[1] <= '8' &&
+		san[2] >= 'a' && san[2] <= 'h' && san[3] >= '1' && san[3] <= '8'){
+		if(san[4] != '\0') san[4] = tolower(san[4]);
+		return ParseMove(san, pos);
+	}
+	
+	S_MOVELIST list[1];
+	GenerateAllMoves(pos, list);
+	u8 moveNum;
+	s32 move;
+	
+	// Castling, O-O or 0-0 are reduced to two characters and O-O-O to three. The castling moves are
+	// generated before the king is known to be safe on its destination, so the move is checked like the others.
+	if(san[0] == 'O' || san[0] == '0'){
+		if(length > 3 || strspn(san, "O0") != length) return NOMOVE;
+		u8 toFile = (length == 2) ? FILE_G : FILE_C;
+		for(moveNum = 0; moveNum < list->count; moveNum++){
+			move = list->moves[moveNum].move;
+			if(!IsCA(move) || FilesBrd[TO64(move)] != toFile) continue;
+			if(!MakeMove(pos, move)) return NOMOVE;
+			UnMakeMove(pos);
+			return move;
+		}
+		return NOMOVE;
+	}
+	
+	// Piece type, pawn moves have no piece letter
+	char piece = 'P';
+	u8 start = 0;
+	if(strchr("NBRQK", san[0]) != NULL) piece = san[start++];
+	
+	// Promotion piece
+	char promotion = 0;
+	if(piece == 'P' && strchr("NBRQnbrq", san[length - 1]) != NULL){
+		promotion = toupper(san[--length]);
+		san[length] = '\0';
+	}
+	
+	if(length - start < 2) return NOMOVE;
+	
+	// Destination square and the optional disambiguation file/rank
+	u8 toFile = san[length - 2] - 'a';
+	u8 toRank = san[length - 1] - '1';
+	if(toFile > FILE_H || toRank > RANK_8) return NOMOVE;
+	
+	s8 fromFile = -1, fromRank = -1;
+	for(i = start; i < length - 2; i++){
+		if(san[i] >= 'a' && san[i] <= 'h') fromFile = san[i] - 'a';
+		else if(san[i] >= '1' && san[i] <= '8') fromRank = san[i] - '1';
+		else return NOMOVE;
+	}
+	
+	u8 from, to;
+	for(moveNum = 0; moveNum < list->count; moveNum++){
+		
+		move = list->moves[moveNum].move;
+		from = FROMSQ(move);
+		to = TOSQ(move);
+		
+		if(FilesBrd[SQ64(to)] != toFile || RanksBrd[SQ64(to)] != toRank) continue;
+		if(toupper(PieceChar[pos->pieces[from]]) != piece) continue;
+		if(fromFile != -1 && FilesBrd[SQ64(from)] != fromFile) continue;
+		if(fromRank != -1 && RanksBrd[SQ64(from)] != fromRank) continue;
+		if((move & MFLAGPRO) && toupper(PieceChar[PROMOTED(move, pos->side)]) != promotion) continue;
+		if(!(move & MFLAGPRO) && promotion) continue;
+		
+		// Skip the illegal moves that may share the same notation
+		if(!MakeMove(pos, move)) continue;
+		UnMakeMove(pos);
+		
+		return move;
+	}
+	
+	return NOMOVE;
+}
+
 /**
  * A function to take an integer number which represents a squar on the board,
  * converts it into an algebraic form (ex. a1) as string and returns a pointer
@@ -71,7 +173,7 @@ s32 ParseMove(const char *ptrchar, S_BOARD *pos){
  * @return a pointer to string. 
  */
 char *PrSq(const u8 sq){
-	static char SqStr[3];
+	static THREAD_LOCAL char SqStr[3];
 	
 	u8 file = FilesBrd[SQ64(sq)];
 	u8 rank = RanksBrd[SQ64(sq)];
@@ -91,19 +193,15 @@ char *PrSq(const u8 sq){
  * @return a pointer to string. 
  */
 char *PrMove(const s32 move){
-	static char MvStr[6];
-	
-	u8 ff = FilesBrd[SQ64(FROMSQ(move))];
-	u8 rf = RanksBrd[SQ64(FROMSQ(move))];
-	u8 ft = FilesBrd[SQ64(TOSQ(move))];
-	u8 rt = RanksBrd[SQ64(TOSQ(move))];
-	
-	u8 promoted = PROMOTED(move);
-	if(promoted){
-		char pchar ='q';
-		if(IsKn(promoted)) pchar = 'n';
-		else if(IsRQ(promoted) && !IsBQ(promoted)) pchar = 'r';
-		else if(!IsRQ(promoted) && IsBQ(promoted)) pchar = 'b';
+	static THREAD_LOCAL char MvStr[6];
+	
+	u8 ff = FilesBrd[FROM64(move)];
+	u8 rf = RanksBrd[FROM64(move)];
+	u8 ft = FilesBrd[TO64(move)];
+	u8 rt = RanksBrd[TO64(move)];
+	
+	if(move & MFLAGPRO){
+		char pchar = "nbrq"[PROMOTION(move)];
 		
 		sprintf(MvStr, "%c%c%c%c%c", ('a' + ff), ('1' + rf), ('a' + ft), ('1' + rt), pchar);
 	}
@@ -121,20 +219,19 @@ char *PrMove(const s32 move){
  * @return a pointer to string. 
  */
 char *SpePrMove(const s32 move){
-	static char MvStr[6];
+	static THREAD_LOCAL char MvStr[7];
 	
-	u8 ff = FilesBrd[SQ64(FROMSQ(move))];
-	u8 rf = RanksBrd[SQ64(FROMSQ(move))];
-	u8 ft = FilesBrd[SQ64(TOSQ(move))];
-	u8 rt = RanksBrd[SQ64(TOSQ(move))];
+	u8 ff = FilesBrd[FROM64(move)];
+	u8 rf = RanksBrd[FROM64(move)];
+	u8 ft = FilesBrd[TO64(move)];
+	u8 rt = RanksBrd[TO64(move)];
 	
-	u8 promoted = PROMOTED(move);
 	u8 captured = (move & MFLAGCAP)? 1 : 0 ;
 	
 	char tchar = 'N';
-	if(MFLAGCA & move) tchar = 'C';
-	if(MFLAGEP & move) tchar = 'E';
-	if(promoted) tchar = 'P';
+	if(IsCA(move)) tchar = 'C';
+	if(IsEP(move)) tchar = 'E';
+	if(move & MFLAGPRO) tchar = 'P';
 	
 	sprintf(MvStr, "%c%c%c%c%c%c", captured? 'X':'-', tchar, ('a' + ff), ('1' + rf), ('a' + ft), ('1' + rt));                
 	
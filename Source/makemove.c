@@ -12,6 +12,7 @@
 #define HASH_PCE(pce, sq) (pos->posKey ^= (PieceKeys[(pce)][SQ64(sq)])) ///< Hask the piece key on a specified square on board from the general hash key.             
 #define HASH_WP(sq) (pos->pawnKey ^= (PieceKeys[wP][SQ64(sq)]))			///< Hask the white pawn key on a specified square on board from the general hash key.  
 #define HASH_BP(sq) (pos->pawnKey ^= (PieceKeys[bP][SQ64(sq)]))			///< Hask the black pawn key on a specified square on board from the general hash key.  
+#define HASH_MAT(pce, count) (pos->materialKey ^= (PieceKeys[(pce)][(count)]))	///< Hask the key of the count-th piece of a type from the material key (count from 0).
 #define HASH_CA (pos->posKey ^= CastleKeys[pos->castlePerm])			///< Hask the castling key -depends on castle pernission flag- from the general hash key.  
 #define HASH_SIDE (pos->posKey ^= SideKey)								///< Hask the side key -depends on current turn- from the general hash key.  
 #define HASH_EP (pos->posKey ^= PieceKeys[EMPTY][SQ64(pos->enPass)])	///< Hask tthe square where en passent occurs on board from the general hash key. 
@@ -89,6 +90,7 @@ static void ClearPiece(const u8 sq, S_BOARD *pos){
 	ASSERT(t_pceNum >=0 && t_pceNum < 10);
 	
 	pos->pceNum[pce]--;
+	HASH_MAT(pce, pos->pceNum[pce]);
 	pos->pList[pce][t_pceNum] = pos->pList[pce][pos->pceNum[pce]];  //Put the last piece's place of the pList in the deleted ppiece's place                                               
 	ASSERT(pos->pieces[pos->kingSq[WHITE]] == wK);
 	ASSERT(pos->pieces[pos->kingSq[BLACK]] == bK);
@@ -130,6 +132,7 @@ static void AddPiece(const u8 sq, const u8 pce, S_BOARD *pos){
 		SETBIT(pos->pawns[BOTH], SQ64(sq));
 	}
 	
+	HASH_MAT(pce, pos->pceNum[pce]);
 	pos->pList[pce][pos->pceNum[pce]++] = sq;
 	ASSERT(pos->pieces[pos->kingSq[WHITE]] == wK);
 	ASSERT(pos->pieces[pos->kingSq[BLACK]] == bK);
@@ -226,16 +229,19 @@ u8 MakeMove(S_BOARD *pos, s32 move){
 	pos->history[pos->hisply].fiftyMove = pos->fiftyMove;
 	pos->history[pos->hisply].posKey = pos->posKey;
 	pos->history[pos->hisply].pawnKey = pos->pawnKey;
+	pos->history[pos->hisply].materialKey = pos->materialKey;
+	pos->history[pos->hisply].piece = pos->pieces[from];
+	pos->history[pos->hisply].captured = pos->pieces[to];
 	
 	pos->ply++;
 	pos->hisply++;
 	ASSERT(pos->hisply >= 0 && pos->hisply < MAXGAMEMOVES);
 	ASSERT(pos->ply >= 0 && pos->ply < MAXDEPTH);
 	
-	if(move & MFLAGEP){
+	if(IsEP(move)){
 		if(side == WHITE) ClearPiece(to - 10, pos);
 		else ClearPiece(to + 10, pos);
-	}else if(move & MFLAGCA){
+	}else if(IsCA(move)){
 		
 		#ifdef DEBUG
 			switch(to){
@@ -268,8 +274,8 @@ u8 MakeMove(S_BOARD *pos, s32 move){
 	
 	pos->fiftyMove++;
 	
-	if(CAPTURED(move) != EMPTY){
-		ASSERT(PieceValid(CAPTURED(move)));
+	if(pos->pieces[to] != EMPTY){
+		ASSERT(PieceValid(pos->pieces[to]));
 		ClearPiece(to, pos);
 		pos->fiftyMove = 0;
 	}
@@ -277,7 +283,7 @@ u8 MakeMove(S_BOARD *pos, s32 move){
 	//If the moved piece is a pawn and moved 2 squares, set the enPass square
 	if(!(PieceBig[pos->pieces[from]])){
 		pos->fiftyMove = 0;
-		if(move & MFLAGPS){
+		if(IsPS(move)){
 			if(side == WHITE){
 				pos->enPass = from + 10;
 				ASSERT(RanksBrd[SQ64(pos->enPass)] == RANK_3);
@@ -294,7 +300,7 @@ u8 MakeMove(S_BOARD *pos, s32 move){
 	
 	if(IsKi(pos->pieces[to])) pos->kingSq[side] = to;
 	
-	u8 proPce = PROMOTED(move);
+	u8 proPce = PROMOTED(move, side);
 	if(proPce != EMPTY){
 		ASSERT(PieceValid(proPce) && PieceBig[proPce] && !PieceKing[proPce]);
 		ClearPiece(to, pos);
@@ -349,10 +355,10 @@ void UnMakeMove(S_BOARD *pos){
 	if(pos->enPass != NO_SQ) HASH_EP;
 	HASH_CA;
 	
-	if(move & MFLAGEP){
+	if(IsEP(move)){
 		if(pos->side == WHITE) AddPiece(to - 10, bP, pos);
 		else AddPiece(to + 10, wP, pos);
-	}else if(move & MFLAGCA){
+	}else if(IsCA(move)){
 		switch(to){
 			case C1: MovePiece(D1, A1, pos); break;
 			case C8: MovePiece(D8, A8, pos); break;
@@ -366,14 +372,14 @@ void UnMakeMove(S_BOARD *pos){
 	
 	if(IsKi(pos->pieces[from])) pos->kingSq[pos->side] = from;
 	
-	if(CAPTURED(move) != EMPTY){
-		ASSERT(PieceValid(CAPTURED(move)));
-		AddPiece(to,CAPTURED(move), pos);
+	u8 captured = pos->history[pos->hisply].captured;
+	if(captured != EMPTY){
+		ASSERT(PieceValid(captured));
+		AddPiece(to, captured, pos);
 	}
 	
-	u8 proPce = PROMOTED(move);
-	if(proPce != EMPTY){
-		ASSERT(PieceValid(proPce) && PieceBig[proPce] && !PieceKing[proPce]);
+	if(move & MFLAGPRO){
+		ASSERT(PieceValid(pos->pieces[from]) && PieceBig[pos->pieces[from]] && !PieceKing[pos->pieces[from]]);
 		ClearPiece(from, pos);
 		AddPiece(from, (pos->side == WHITE? wP : bP), pos);
 	}
@@ -399,6 +405,9 @@ void MakeNullMove(S_BOARD *pos){
 	pos->history[pos->hisply].fiftyMove = pos->fiftyMove;
 	pos->history[pos->hisply].posKey = pos->posKey;
 	pos->history[pos->hisply].pawnKey = pos->pawnKey;
+	pos->history[pos->hisply].materialKey = pos->materialKey;
+	pos->history[pos->hisply].piece = EMPTY;
+	pos->history[pos->hisply].captured = EMPTY;
 	
 	pos->ply++;
 	pos->hisply++;
@@ -437,6 +446,7 @@ void UnMakeNullMove(S_BOARD *pos){
 	pos->fiftyMove = pos->history[pos->hisply].fiftyMove;
 	pos->posKey = pos->history[pos->hisply].posKey;
 	pos->pawnKey = pos->history[pos->hisply].pawnKey;
+	pos->materialKey = pos->history[pos->hisply].materialKey;
 	
 	
 	ASSERT(CheckBoard(pos));
@@ -19,6 +19,7 @@
 #else
 	#include"sys/time.h"
 	#include"sys/select.h"
+	#include"time.h"
 #endif
 
 char interrupt_string[INPUTBUFFER];
@@ -69,6 +70,26 @@ s32 GetTimeMs(void){
 
 }
 
+/**
+ * This fuction returns the time of a monotonic clock in nanoseconds, it is used to time
+ * operations that are too short for GetTimeMs().
+ *
+ * @return nanos
+ */
+u64 GetTimeNs(void){
+	#ifdef WIN32
+		LARGE_INTEGER count, frequency;
+		QueryPerformanceCounter(&count);
+		QueryPerformanceFrequency(&frequency);
+		return (u64)(count.QuadPart / frequency.QuadPart) * 1000000000ULL
+			 + (u64)(count.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
+	#else
+		struct timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return (u64)t.tv_sec * 1000000000ULL + t.tv_nsec;
+	#endif
+}
+
 static s32 InputWaiting(){
 	
 	#ifndef WIN32
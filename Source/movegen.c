@@ -8,7 +8,9 @@
 
 #include "defs.h"
 
-#define MOVE(f, t, cap, pro, fl) ((f) | (t << 7) | (cap << 14) | (pro << 20) | (fl))  ///< Combine move elements to get an integer move.
+#define MOVE(f, t, cap, pro, fl) (SQ64(f) | (SQ64(t) << 6) | ((cap) != EMPTY ? MFLAGCAP : 0) | PromotionFlag[pro] | (fl))  ///< Combine move elements to get an integer move.
+
+static const u16 PromotionFlag[13] = {0, 0, 0x8000, 0x9000, 0xA000, 0xB000, 0, 0, 0x8000, 0x9000, 0xA000, 0xB000, 0}; ///< The promotion flags of the move by passing the promoted piece as an index.
 
 static const u8 PieceSlides[13] = {FALSE, FALSE, FALSE, TRUE, TRUE, TRUE, FALSE, FALSE, FALSE, TRUE, TRUE, FALSE, FALSE}; ///< Returns true if the piece passed as an index is a silde piece.                             
 
@@ -38,13 +40,43 @@ static const u8 NumDir[13] = {0, 0, 8, 4, 4, 8, 8, 0, 8, 4, 4, 8, 8};
 
 /* Move Ordering:
  * PV move
- * Captures -> MvvLva
+ * Captures -> SEE or MvvLva + capture history
  * Killers -> Beta cut off
- * HistoryScores -> Beating alpha
+ * Counter move -> Refuted the previous move
+ * HistoryScores -> history + continuation histories
  */
 
+#define CAPTURE_HISTORY_DIV	128		///< Capture history is divided by this value before it is added to a capture score, so it only orders captures of the same class.
+
 const u8 VictimScores[13] = {0, 10, 20, 30, 40, 50, 60, 10, 20, 30, 40, 50, 60};    ///< Socres of piece types.
 
+static THREAD_LOCAL u8 scoreBySEE;		///< Set by the generators, captures are scored by SEE if TRUE and by MVV-LVA if FALSE.
+
+/**
+ * This function returns the history score of a quiet move, it is the sum of the butterfly history
+ * and the continuation histories of the moves one and two plies before.
+ *
+ * @param pos The position's pointer, the move isn't made yet.
+ * @param move The quiet move.
+ * @return The history score.
+ */
+s32 QuietHistory(const S_BOARD *pos, const s32 move){
+	
+	u8 piece = pos->pieces[FROMSQ(move)];
+	u8 to = TO64(move);
+	s32 score = OPT_HISTORY ? pos->searchHistory[piece][to] : 0;
+	
+	if(OPT_CONTHISTORY){
+		u8 index;
+		for(index = 1; index <= 2 && index <= pos->hisply; index++){
+			const S_UNDO *prev = &pos->history[pos->hisply - index];
+			if(prev->move != NOMOVE) score += pos->contHistory[prev->piece][TO64(prev->move)][piece][to];
+		}
+	}
+	
+	return score;
+}
+
 /**
  * This function to check if the given move exists on the current board or not.
  *
@@ -80,15 +112,22 @@ static void AddQuietMove(const S_BOARD *pos, s32 move, S_MOVELIST *list){
 	list->moves[list->count].score = 0;
 	
 	#ifdef USE_KILLERS
-	if(pos->searchKillers[0][pos->ply] == move) list->moves[list->count].score = 900000;
-	else if(pos->searchKillers[1][pos->ply] == move) list->moves[list->count].score = 800000;
+	if(OPT_KILLERS){
+		if(pos->searchKillers[0][pos->ply] == move) list->moves[list->count].score = 900000;
+		else if(pos->searchKillers[1][pos->ply] == move) list->moves[list->count].score = 800000;
+	}
+	if(OPT_COUNTERMOVE && list->moves[list->count].score == 0 && pos->hisply > 0){
+		const S_UNDO *prev = &pos->history[pos->hisply - 1];
+		if(prev->move != NOMOVE && pos->counterMoves[prev->piece][TO64(prev->move)] == move) list->moves[list->count].score = 700000;
+	}
 	#endif
 	#ifdef USE_HISTORY
-	else list->moves[list->count].score = pos->searchHistory[pos->pieces[FROMSQ(move)]][SQ64(TOSQ(move))];
+	if(list->moves[list->count].score == 0)
+		list->moves[list->count].score = QuietHistory(pos, move);
 	#endif
 	
 	#ifdef USE_EVALMOVE
-	if(list->moves[list->count].score == 0)
+	if(OPT_EVALMOVE && list->moves[list->count].score == 0)
 		list->moves[list->count].score = EvalMove(pos, FROMSQ(move), TOSQ(move));
 	#endif
 	
@@ -99,13 +138,18 @@ static void AddCaptureMove(const S_BOARD *pos, s32 move, S_MOVELIST *list){
 	
 	ASSERT(SqOnBoard(FROMSQ(move)));
 	ASSERT(SqOnBoard(TOSQ(move)));
-	ASSERT(PieceValid(CAPTURED(move)));
+	ASSERT(PieceValid(CAPTURED(pos, move)));
 	ASSERT(PieceValid(pos->pieces[FROMSQ(move)]));
 	ASSERT(CheckBoard(pos));
 	
 	list->moves[list->count].move = move;
 	#ifdef USE_SEE
-	list->moves[list->count].score = SEE(pos, move) + 1000000;
+	if(scoreBySEE) list->moves[list->count].score = SEE(pos, move) + 1000000;
+	else
+	#endif
+	list->moves[list->count].score = VictimScores[CAPTURED(pos, move)] * 100 + 6 - VictimScores[pos->pieces[FROMSQ(move)]] / 10 + 1000000;
+	#ifdef USE_HISTORY
+	if(OPT_CAPTUREHISTORY) list->moves[list->count].score += pos->captureHistory[pos->pieces[FROMSQ(move)]][TO64(move)][CAPTURED(pos, move)] / CAPTURE_HISTORY_DIV;
 	#endif
 	list->count++;
 }
@@ -115,11 +159,16 @@ static void AddEnPassantMove(const S_BOARD *pos, s32 move, S_MOVELIST *list){
 	ASSERT(SqOnBoard(FROMSQ(move)));
 	ASSERT(SqOnBoard(TOSQ(move)));
 	ASSERT(CheckBoard(pos));
-	ASSERT((RanksBrd[SQ64(TOSQ(move))] == RANK_6 && pos->side == WHITE) || (RanksBrd[SQ64(TOSQ(move))] == RANK_3 && pos->side == BLACK));
+	ASSERT((RanksBrd[TO64(move)] == RANK_6 && pos->side == WHITE) || (RanksBrd[TO64(move)] == RANK_3 && pos->side == BLACK));
 	
 	list->moves[list->count].move = move;
 	#ifdef USE_SEE
-	list->moves[list->count].score = SEE(pos, move) + 1000000;
+	if(scoreBySEE) list->moves[list->count].score = SEE(pos, move) + 1000000;
+	else
+	#endif
+	list->moves[list->count].score = VictimScores[wP] * 100 + 6 - VictimScores[pos->pieces[FROMSQ(move)]] / 10 + 1000000;
+	#ifdef USE_HISTORY
+	if(OPT_CAPTUREHISTORY) list->moves[list->count].score += pos->captureHistory[pos->pieces[FROMSQ(move)]][TO64(move)][EMPTY] / CAPTURE_HISTORY_DIV;
 	#endif
 	list->count++;
 }
@@ -198,6 +247,7 @@ void GenerateAllMoves(const S_BOARD *pos, S_MOVELIST *list){
 	ASSERT(CheckBoard(pos));
 	
 	list->count = 0;
+	scoreBySEE = OPT_SEE;
 	u8 pceNum, pceIndex, sq, t_sq, pce, index;
 	s8 dir;
 	u8 side = pos->side;
@@ -375,6 +425,9 @@ void GenerateAllMoves(const S_BOARD *pos, S_MOVELIST *list){
 /**
  * This function generates all possible captured moves without filterating.
  *
+ * The captures are always scored by MVV-LVA, the quiescence search calls SEE
+ * itself only for the captures that look losing.
+ *
  * @param pos The position's pointer.
  * @param list The pointer of move list.
  */
@@ -383,6 +436,7 @@ void GenerateAllCaps(const S_BOARD *pos, S_MOVELIST *list){
 	ASSERT(CheckBoard(pos));
 	
 	list->count = 0;
+	scoreBySEE = FALSE;
 	u8 pceNum, pceIndex, sq, t_sq, pce, index;
 	s8 dir;
 	u8 side = pos->side;
@@ -517,6 +571,7 @@ void GenerateMovesForLocation(const S_BOARD *pos, S_MOVELIST *list, const u8 sq)
 	ASSERT(SqOnBoard(sq));
 	
 	list->count = 0;
+	scoreBySEE = OPT_SEE;
 	u8 t_sq, pce, index;
 	s8 dir;
 	u8 side = pos->side;
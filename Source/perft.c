@@ -10,30 +10,38 @@
 
 extern const u8  VictimScores[13];
 extern const u8 piece_values[13];
-static u64 leafNodes;
 
-static void Perft(const u8 depth, S_BOARD *pos){
+/**
+ * Walk the move generation tree of strictly legal moves and count all the leaf nodes
+ * of a certain depth without printing anything.
+ * 
+ * It keeps no state outside the given position, so it is safe to call from several
+ * threads at the same time as long as each thread uses its own board.
+ * 
+ * @param depth 
+ * @param pos The position's pointer.
+ * @return The number of visited leaf nodes.
+ */
+u64 Perft(const u8 depth, S_BOARD *pos){
 	
 	ASSERT(CheckBoard(pos));
 	
-	if(depth == 0){
-		leafNodes++;
-		return;
-	}
+	if(depth == 0) return 1;
 	
 	S_MOVELIST list[1];
 	GenerateAllMoves(pos, list);
 	
+	u64 leafNodes = 0;
 	u8 moveNum;
 	for(moveNum = 0; moveNum < list->count; moveNum++){
 		
 		if(!MakeMove(pos, list->moves[moveNum].move)) continue;
-		Perft(depth - 1, pos);
+		leafNodes += Perft(depth - 1, pos);
 		UnMakeMove(pos);
 		
 	}
 	
-	return;
+	return leafNodes;
 	
 }
 
@@ -52,24 +60,10 @@ u64 PerftTest(const u8 depth, S_BOARD *pos){
 	
 	printf("\nStarting search in depth %d:\n", depth);
 	
-	leafNodes = 0;
 	s32 start = GetTimeMs();
-	S_MOVELIST list[1];
-	GenerateAllMoves(pos, list);
+	u64 leafNodes = Perft(depth, pos);
 	
-	u8 moveNum;
-	
-	for(moveNum = 0; moveNum < list->count; moveNum++){
-		
-		s32 move =list->moves[moveNum].move;
-		if(!MakeMove(pos, move)) continue;
-		long comuNodes = leafNodes;
-		Perft(depth - 1, pos);
-		UnMakeMove(pos);
-		long branNodes = leafNodes - comuNodes;		
-	}
-	
-	printf("Test compelet: %lld visited nodes in %ld ms\n", leafNodes, GetTimeMs() - start);
+	printf("Test compelet: %llu visited nodes in %ld ms\n", (unsigned long long)leafNodes, (long)(GetTimeMs() - start));
 	
 	return leafNodes;
 	
@@ -135,8 +129,6 @@ s32 SEETest(const S_BOARD *pos){
 	
 	printf("\nStarting SEE test:\n");
 	
-	leafNodes = 0;
-	
 	long start = GetTimeMs();
 	S_MOVELIST list[1];
 	GenerateAllCaps(pos, list);
@@ -179,8 +171,8 @@ s32 SEETest(const S_BOARD *pos){
 	
 	for(moveNum = 0; moveNum < indexCounter; moveNum++){
 		s32 move = list->moves[index[moveNum]].move;
-		list->moves[index[moveNum]].score = (VictimScores[CAPTURED(move)]*10) + 6 - (VictimScores[pos->pieces[FROMSQ(move)]]/10);            
-		if(PROMOTED(move) != EMPTY) list->moves[index[moveNum]].score += piece_values[PROMOTED(move)];
+		list->moves[index[moveNum]].score = (VictimScores[CAPTURED(pos, move)]*10) + 6 - (VictimScores[pos->pieces[FROMSQ(move)]]/10);            
+		if(move & MFLAGPRO) list->moves[index[moveNum]].score += piece_values[PROMOTED(move, pos->side)];
 	}
 	
 	if(list->count != 0 && list->count != 1) QuickSort(list, 0, list->count - 1);
@@ -7,9 +7,33 @@
  */
 
 #include"defs.h"
+#include"string.h"
 
 #define MATE (pos->ply - INFINITY)        ///< Constant value represents mate state after plys.
-extern const u8 piece_values[13];
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))	///< Returns the minimum number.
+
+#define RFP_DEPTH		7					///< Reverse futility pruning is tried below this depth.
+#define FUTILITY_DEPTH	4					///< Futility pruning is tried below this depth.
+#define RAZOR_DEPTH		4					///< Razoring is tried below this depth.
+#define LMP_DEPTH		5					///< Late move pruning is tried below this depth.
+
+static const s16 RFPMargin[RFP_DEPTH] = {0, 120, 240, 360, 480, 600, 720};	///< Margins of reverse futility pruning indexed by depth.
+static const s16 FutilityMargin[FUTILITY_DEPTH] = {0, 200, 300, 500};		///< Margins of futility pruning indexed by depth.
+static const s16 RazorMargin[RAZOR_DEPTH] = {0, 300, 450, 600};			///< Margins of razoring indexed by depth.
+#define NULL_DEPTH_DIV		6				///< The null-move reduction grows one ply every this number of plies of depth.
+#define NULL_EVAL_DIV		200				///< The null-move reduction grows one ply every this margin of static evaluation above beta.
+#define NULL_VERIFY_DEPTH	8				///< A null-move cutoff is verified by a reduced normal search from this depth.
+
+#define IID_DEPTH			5				///< Internal iterative deepening is tried in PV nodes from this depth.
+#define IID_REDUCTION		2				///< Depth reduction of the internal iterative deepening search.
+#define IIR_DEPTH			4				///< Internal iterative reduction is tried in non-PV nodes from this depth.
+#define SINGULAR_DEPTH		8				///< Singular extension is tried from this depth.
+#define SINGULAR_MARGIN		2				///< The margin per ply of depth below the hash score that the other moves must fail low to.
+#define HISTORY_BONUS_MAX	1600			///< The largest history bonus, the bonus of a move is 16 * depth * depth below it.
+#define HISTORY_TRIED		64				///< The number of tried quiet moves and captures of a node that get a history malus.
+#define CURRMOVE_TIME		1000			///< The root move being searched is reported in UCI mode after this time of search in milliseconds.
+
+static const u8 LMPCount[LMP_DEPTH] = {0, 6, 10, 16, 24};					///< The number of legal moves searched before late quiet moves are pruned indexed by depth.
 extern void QuickSort(S_MOVELIST *list, s16 first, s16 last);
 
 /**
@@ -64,8 +88,9 @@ static void PickNextMove(u8 moveNum, S_MOVELIST *list){
 }
 
 static void CheckUp(S_SEARCHINFO *info){
-	// Checking time up, interrupts from GUI
+	// Checking time up, node limit, interrupts from GUI
 	if(info->timeset == TRUE && GetTimeMs() > info->stoptime) info->stopped = TRUE;
+	if(info->nodeLimit && info->nodes >= info->nodeLimit) info->stopped = TRUE;
 	if(info->ponder == TRUE) ReadInput(info);
 }
 
@@ -87,11 +112,19 @@ static void ClearForSearch(S_BOARD *pos, S_SEARCHINFO *info){
 	
 	u8 index, index2;
 	
-	// Clear serach history values.
-	for(index = 0; index < 13; index++){
-		for(index2 = 0; index2 < 64; index2++)
-			pos->searchHistory[index][index2] = 0;
-	}
+	// Age the history tables instead of clearing them, so what was learned in the last search still orders
+	// the moves of this one but the new results outweigh it soon. The counter moves are kept as they are.
+	s16 *entry = &pos->searchHistory[0][0];
+	s32 count;
+	for(count = 0; count < 13 * 64; count++) entry[count] /= 2;
+	entry = &pos->captureHistory[0][0][0];
+	for(count = 0; count < 13 * 64 * 13; count++) entry[count] /= 2;
+	entry = &pos->contHistory[0][0][0][0];
+	for(count = 0; count < 13 * 64 * 13 * 64; count++) entry[count] /= 2;
+	
+	// Clear the excluded moves of singular extension search and MultiPV.
+	for(index = 0; index < MAXDEPTH; index++) pos->excludedMove[index] = NOMOVE;
+	pos->multiPvCount = 0;
 	
 	// Clear serach killers values.
 	for(index = 0; index < 2; index++){
@@ -113,13 +146,190 @@ static void ClearForSearch(S_BOARD *pos, S_SEARCHINFO *info){
 	info->nodes = 0;
 	info->fhf = 0;
 	info->fh = 0;
+	info->nullCut = 0;
 	
 	// Reset evaluation tables feedback valiables.
 	pos->EvalTable->evalhits = 0;
 	pos->EvalTable->pawnhits = 0;
+	pos->EvalTable->materialhits = 0;
+	pos->EvalTable->evalprobes = 0;
+	pos->EvalTable->pawnprobes = 0;
+	pos->EvalTable->materialprobes = 0;
+	
+	#ifdef USE_SEARCH_STATS
+	memset(&info->stats, 0, sizeof(S_SEARCHSTATS));
+	#endif
 	
 }
 
+/**
+ * This function checks if a root move is the first move of one of the MultiPV lines found
+ * in the current iteration.
+ *
+ * @param pos The position's pointer.
+ * @param move The root move.
+ * @return TRUE if the move is excluded from the search of the next line, FALSE if not.
+ */
+static u8 IsMultiPvMove(const S_BOARD *pos, const s32 move){
+	
+	u8 index;
+	for(index = 0; index < pos->multiPvCount; index++){
+		if(pos->multiPvMoves[index] == move) return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * This function wipes the move ordering tables, it is called for a new game
+ * since the histories of the last game don't fit the new one.
+ *
+ * @param pos The position's pointer.
+ */
+void ClearHistory(S_BOARD *pos){
+	
+	memset(pos->searchHistory, 0, sizeof(pos->searchHistory));
+	memset(pos->captureHistory, 0, sizeof(pos->captureHistory));
+	memset(pos->contHistory, 0, sizeof(pos->contHistory));
+	memset(pos->counterMoves, 0, sizeof(pos->counterMoves));
+	memset(pos->searchKillers, 0, sizeof(pos->searchKillers));
+}
+
+/**
+ * This function adds a bonus (or a malus if it is negative) to a history entry, the update is scaled down
+ * as the entry gets closer to HISTORY_MAX in the bonus direction, so the entry saturates instead of overflowing.
+ *
+ * @param entry The pointer of the history entry.
+ * @param bonus The bonus, its absolute value must not be above HISTORY_MAX.
+ */
+static void UpdateHistoryEntry(s16 *entry, const s16 bonus){
+	*entry += bonus - *entry * abs(bonus) / HISTORY_MAX;
+}
+
+/**
+ * This function updates the history and the continuation histories of a quiet move.
+ *
+ * @param pos The position's pointer, the move isn't made.
+ * @param move The quiet move.
+ * @param bonus The bonus, negative for a malus.
+ */
+static void UpdateQuietHistory(S_BOARD *pos, const s32 move, const s16 bonus){
+	
+	u8 piece = pos->pieces[FROMSQ(move)];
+	u8 to = TO64(move);
+	
+	if(OPT_HISTORY) UpdateHistoryEntry(&pos->searchHistory[piece][to], bonus);
+	
+	if(OPT_CONTHISTORY){
+		u8 index;
+		for(index = 1; index <= 2 && index <= pos->hisply; index++){
+			const S_UNDO *prev = &pos->history[pos->hisply - index];
+			if(prev->move != NOMOVE) UpdateHistoryEntry(&pos->contHistory[prev->piece][TO64(prev->move)][piece][to], bonus);
+		}
+	}
+}
+
+/**
+ * This function updates the move ordering tables after the best move of a node is found. The best move gains
+ * a bonus, the quiet moves tried before it lose the same amount if it is quiet, and the tried captures always lose.
+ * A quiet best move becomes the counter move of the previous move.
+ *
+ * @param pos The position's pointer.
+ * @param bestMove The move that failed high or improved alpha.
+ * @param depth The depth of the node.
+ * @param quiets The tried quiet moves, it may hold the best move.
+ * @param quietCount The number of tried quiet moves.
+ * @param captures The tried captures, it may hold the best move.
+ * @param captureCount The number of tried captures.
+ */
+static void UpdateHistories(S_BOARD *pos, const s32 bestMove, const u8 depth, const s32 *quiets, const u8 quietCount, const s32 *captures, const u8 captureCount){
+	
+	s16 bonus = depth >= 10 ? HISTORY_BONUS_MAX : 16 * depth * depth;
+	u8 index;
+	
+	if(!(bestMove & MFLAGCAP)){
+		
+		UpdateQuietHistory(pos, bestMove, bonus);
+		for(index = 0; index < quietCount; index++){
+			if(quiets[index] != bestMove) UpdateQuietHistory(pos, quiets[index], -bonus);
+		}
+		
+		if(OPT_COUNTERMOVE && pos->hisply > 0){
+			const S_UNDO *prev = &pos->history[pos->hisply - 1];
+			if(prev->move != NOMOVE) pos->counterMoves[prev->piece][TO64(prev->move)] = bestMove;
+		}
+		
+	}else if(OPT_CAPTUREHISTORY){
+		UpdateHistoryEntry(&pos->captureHistory[pos->pieces[FROMSQ(bestMove)]][TO64(bestMove)][CAPTURED(pos, bestMove)], bonus);
+	}
+	
+	if(OPT_CAPTUREHISTORY){
+		for(index = 0; index < captureCount; index++){
+			if(captures[index] != bestMove)
+				UpdateHistoryEntry(&pos->captureHistory[pos->pieces[FROMSQ(captures[index])]][TO64(captures[index])][CAPTURED(pos, captures[index])], -bonus);
+		}
+	}
+}
+
+#ifdef USE_SEARCH_STATS
+/**
+ * Divides two counters for the rates of the statistics dump.
+ * 
+ * @param part The counted events.
+ * @param total The counted chances.
+ * @return The rate, zero if there was no chance.
+ */
+static double Rate(const u64 part, const u64 total){
+	return total ? (double)part / total : 0.0;
+}
+
+/**
+ * Dumps the statistics of the finished search as one JSON object in one line.
+ * 
+ * The line is sent as "info string" in UCI mode and as a comment in XBoard mode
+ * so GUIs ignore it.
+ * 
+ * @param pos The position's pointer.
+ * @param info The pinter of the engine information stucture.
+ */
+static void PrintSearchStats(const S_BOARD *pos, const S_SEARCHINFO *info){
+	
+	const S_SEARCHSTATS *stats = &info->stats;
+	s32 time = GetTimeMs() - info->starttime;
+	u8 depth;
+	
+	if(info->GAME_MODE == UCI_MODE) printf("info string ");
+	else if(info->GAME_MODE == XBOARD_MODE) printf("# ");
+	
+	printf("{\"nodes\": %llu, \"main_nodes\": %llu, \"qnodes\": %llu, \"time_ms\": %d, \"nps\": %llu, \"iterations\": [",
+		(unsigned long long)info->nodes, (unsigned long long)(info->nodes - stats->qnodes), (unsigned long long)stats->qnodes,
+		time, (unsigned long long)(time > 0 ? info->nodes * 1000 / time : 0));
+	
+	for(depth = 1; depth <= stats->iterations; depth++){
+		printf("%s{\"depth\": %d, \"nodes\": %llu, \"time_ms\": %u, \"ebf\": %.2f}", depth > 1 ? ", " : "", depth,
+			(unsigned long long)stats->iterNodes[depth], stats->iterTime[depth],
+			depth > 1 ? Rate(stats->iterNodes[depth], stats->iterNodes[depth - 1]) : 0.0);
+	}
+	
+	printf("], \"first_move_cutoff\": %.4f", Rate(info->fhf, info->fh));
+	printf(", \"tt\": {\"probes\": %llu, \"hit_rate\": %.4f, \"cut_rate\": %.4f, \"pv_moves\": %u, \"evals\": %llu}",
+		(unsigned long long)stats->ttProbes, Rate(pos->HashTable->hit, stats->ttProbes), Rate(pos->HashTable->cut, stats->ttProbes), pos->HashTable->pv,
+		(unsigned long long)stats->ttEvals);
+	printf(", \"null_move\": {\"tries\": %llu, \"success_rate\": %.4f}", (unsigned long long)stats->nullTries, Rate(info->nullCut, stats->nullTries));
+	printf(", \"null_verify\": {\"searches\": %llu, \"fails\": %llu}, \"threat_extensions\": %llu",
+		(unsigned long long)stats->nullVerifies, (unsigned long long)stats->nullVerifyFails, (unsigned long long)stats->threatExtensions);
+	printf(", \"iid_searches\": %llu, \"iir_reductions\": %llu", (unsigned long long)stats->iidSearches, (unsigned long long)stats->iirReductions);
+	printf(", \"singular\": {\"searches\": %llu, \"extensions\": %llu, \"multi_cuts\": %llu}",
+		(unsigned long long)stats->singularSearches, (unsigned long long)stats->singularExtensions, (unsigned long long)stats->multiCuts);
+	printf(", \"lmr\": {\"tries\": %llu, \"success_rate\": %.4f}", (unsigned long long)stats->lmrTries, Rate(stats->lmrTries - stats->lmrFails, stats->lmrTries));
+	printf(", \"pruning\": {\"rfp_cuts\": %llu, \"razor_tries\": %llu, \"razor_cuts\": %llu, \"futility_prunes\": %llu, \"lmp_prunes\": %llu}",
+		(unsigned long long)stats->rfpCuts, (unsigned long long)stats->razorTries, (unsigned long long)stats->razorCuts,
+		(unsigned long long)stats->futilityPrunes, (unsigned long long)stats->lmpPrunes);
+	printf(", \"eval_cache\": {\"probes\": %llu, \"hit_rate\": %.4f}", (unsigned long long)pos->EvalTable->evalprobes, Rate(pos->EvalTable->evalhits, pos->EvalTable->evalprobes));
+	printf(", \"pawn_cache\": {\"probes\": %llu, \"hit_rate\": %.4f}", (unsigned long long)pos->EvalTable->pawnprobes, Rate(pos->EvalTable->pawnhits, pos->EvalTable->pawnprobes));
+	printf(", \"material_cache\": {\"probes\": %llu, \"hit_rate\": %.4f}}\n", (unsigned long long)pos->EvalTable->materialprobes, Rate(pos->EvalTable->materialhits, pos->EvalTable->materialprobes));
+}
+#endif
+
 /**
  *  Quiescent search, looks at captures passed the search depth.
  *
@@ -135,9 +345,10 @@ static s16 Quiescence(s16 alpha, s16 beta, S_BOARD *pos, S_SEARCHINFO *info, u8
 	ASSERT(CheckBoard(pos));
 	ASSERT(beta > alpha);
 
-	if(!(info->nodes & 2047)) CheckUp(info);                               		// check if search time is out or not every 2048 nodes
+	if(!(info->nodes & 2047) || info->nodes == info->nodeLimit) CheckUp(info);		// check if search time is out every 2048 nodes or the node limit is reached
 	
 	info->nodes++;
+	STAT_INC(info->stats.qnodes);
 	
 	if((IsRepetition(pos) || pos->fiftyMove >= 100) && pos->ply){               // Check if there is repetition or fifty move rule is broken out which leads to draw                                        
 		if(pos->ply % 2 == 0) return -contemptFactor;
@@ -146,37 +357,69 @@ static s16 Quiescence(s16 alpha, s16 beta, S_BOARD *pos, S_SEARCHINFO *info, u8
 	
 	if(pos->ply > MAXDEPTH - 1) return EvalPosition(pos);
 	
-	s16 score = EvalPosition(pos);
-	ASSERT(score >= -INFINITY && score <= INFINITY);
+	s16 score = -INFINITY;
+	s32 pvMove = NOMOVE;
+	S_HASHENTRY *entry = NULL;
+	
+	#ifdef USE_TABLES
+	if(OPT_TABLES){
+		STAT_INC(info->stats.ttProbes);
+		if(ProbeHashEntry(pos, &pvMove, &score, alpha, beta, 0)){
+			pos->HashTable->cut ++;
+			return score;
+		}
+		entry = GetHashEntry(pos);
+	}
+	#endif
 	
-	if(score >= beta) return beta;
-	if(score > alpha) alpha = score;
+	// The stand pat score is the static evaluation, it is taken from the hash entry if there is one.
+	s16 standPat;
+	if(entry != NULL && entry->eval != -INFINITY){
+		standPat = entry->eval;
+		STAT_INC(info->stats.ttEvals);
+	}else standPat = EvalPosition(pos);
+	ASSERT(standPat >= -INFINITY && standPat <= INFINITY);
 	
-	// Generate all capture moves 
+	if(standPat >= beta) return beta;
+	
+	s16 oldAlpha = alpha;
+	if(standPat > alpha) alpha = standPat;
+	
+	// Generate all capture moves, they are scored by MVV-LVA
 	S_MOVELIST list[1];
 	GenerateAllCaps(pos,list);
 	ASSERT(CapturesListOk(list, pos));
 	
 	u8 moveNum, legal = 0;
-	score = -INFINITY;
+	s32 move, bestMove = NOMOVE;
 	
-	// Evaluate each capture move using Static Exchange Evaluation
-	// to neglect all bad capture moves that cost more search time.
-	for(moveNum = 0; moveNum < list->count; moveNum++){
-		s32 move = list->moves[moveNum].move;
-		list->moves[moveNum].score = SEE(pos, move);
-		if(PROMOTED(move) != EMPTY) list->moves[moveNum].score += piece_values[PROMOTED(move)];
+	// If we have a hash move, search it first.
+	if(pvMove != NOMOVE){
+		for(moveNum = 0; moveNum < list->count; moveNum++){
+			if(pvMove == list->moves[moveNum].move){
+				list->moves[moveNum].score = 2000000;
+				break;
+			}
+		}
 	}
 	
-	// Sort move depending on moves scores.
-	if(list->count != 0 && list->count != 1) QuickSort(list, 0, list->count - 1);
-	
 	for(moveNum = 0; moveNum < list->count; moveNum++){
 		
-		// Neglect all bad moves that cost more time.
-		if(list->moves[moveNum].score < 0) continue;
+		// Most of the nodes cut off after the first few captures, so pick
+		// the best capture one by one instead of sorting the whole list.
+		PickNextMove(moveNum, list);
+		move = list->moves[moveNum].move;
 		
-		if(!MakeMove(pos, list->moves[moveNum].move)) continue;
+		if(!(move & MFLAGPRO)){
+			
+			// Delta pruning: neglect the captures that can't raise alpha even if the captured piece is won for free.
+			if(standPat + PieceVal[IsEP(move) ? wP : CAPTURED(pos, move)] + DELTA_MARGIN <= alpha) continue;
+			
+			// Neglect the captures of cheaper pieces that lose material, SEE is only called for these ones.
+			if(PieceVal[CAPTURED(pos, move)] < PieceVal[pos->pieces[FROMSQ(move)]] && !IsEP(move) && SEE(pos, move) < 0) continue;
+		}
+		
+		if(!MakeMove(pos, move)) continue;
 		
 		legal++;
 		
@@ -190,12 +433,23 @@ static s16 Quiescence(s16 alpha, s16 beta, S_BOARD *pos, S_SEARCHINFO *info, u8
 			if(score >= beta){
 				if(legal == 1) info->fhf++;
 				info->fh++;
+				#ifdef USE_TABLES
+				if(OPT_TABLES) StoreHashEntry(pos, move, beta, standPat, HFBETA, 0);
+				#endif
 				return beta;
 			}
 			alpha = score;
+			bestMove = move;
 		}
 	}
-
+	
+	#ifdef USE_TABLES
+	if(OPT_TABLES){
+		if(alpha != oldAlpha) StoreHashEntry(pos, bestMove, alpha, standPat, HFEXACT, 0);
+		else StoreHashEntry(pos, bestMove, alpha, standPat, HFALPHA, 0);
+	}
+	#endif
+	
 	return alpha;
 }
 
@@ -209,7 +463,7 @@ static s16 AlphaBeta(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *
 		return Quiescence(alpha, beta, pos, info, contemptFactor);
 	}
 	
-	if(!(info->nodes & 2047)) CheckUp(info);                               // check if search time is out or not every 2048 nodes
+	if(!(info->nodes & 2047) || info->nodes == info->nodeLimit) CheckUp(info);		// check if search time is out every 2048 nodes or the node limit is reached
 	
 	info->nodes++;
 	
@@ -230,37 +484,183 @@ static s16 AlphaBeta(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *
 		else return contemptFactor;
 	}
 	
+	// King and pawn against king (the only material with a single pawn) is an exact draw if the bitbase says so
+	if(pos->ply && pos->material[WHITE] + pos->material[BLACK] == PieceVal[wP] && !ProbeKPK(pos)) return 0;
+	
+	// The tablebases are exact, a win is scored below the mate scores and the shorter way to it is preferred
+	s8 wdl;
+	if(pos->ply && ProbeWDL(pos, &wdl)){
+		if(wdl == 0) return 0;
+		return wdl > 0 ? TB_WIN - pos->ply : pos->ply - TB_WIN;
+	}
+	
 	// if we get the maximum depth, return the evaluation value of the position
 	if(pos->ply > MAXDEPTH - 1) return EvalPosition(pos);
 	
 	s16 score = -INFINITY;
 	s32 pvMove = NOMOVE;
+	S_HASHENTRY *entry = NULL;
+	
+	// The singular extension search excludes the hash move of the position, so the stored
+	// entry of the position isn't used or overwritten by that search.
+	s32 excluded = pos->excludedMove[pos->ply];
 	
 	#ifdef USE_TABLES
-	if(ProbeHashEntry(pos, &pvMove, &score, alpha, beta, depth)){
-		pos->HashTable->cut ++;
-		return score;
+	if(OPT_TABLES && excluded == NOMOVE){
+		STAT_INC(info->stats.ttProbes);
+		if(ProbeHashEntry(pos, &pvMove, &score, alpha, beta, depth)){
+			pos->HashTable->cut ++;
+			return score;
+		}
+		entry = GetHashEntry(pos);
 	}
 	#endif
 	
+	// The static evaluation is compared with the one two plies ago to know if the side to move is improving.
+	// It is taken from the hash entry if the position was searched before, and the singular extension
+	// search takes it from its parent node which is the same position.
+	u8 pvNode = (beta - alpha > 1);
+	s16 staticEval = -INFINITY;
+	if(!InCheck){
+		if(excluded != NOMOVE) staticEval = pos->staticEval[pos->ply];
+		else if(entry != NULL && entry->eval != -INFINITY){
+			staticEval = entry->eval;
+			STAT_INC(info->stats.ttEvals);
+		}else staticEval = EvalPosition(pos);
+	}
+	u8 improving = !InCheck && pos->ply >= 2 && staticEval > pos->staticEval[pos->ply - 2];
+	pos->staticEval[pos->ply] = staticEval;
+	
+	// Forward pruning is only tried in the non-PV nodes (null window) where the side to move isn't in check.
+	if(!InCheck && !pvNode && pos->ply){
+		
+		// Reverse futility pruning: the static evaluation is so far above beta that a quiet move will still fail high.
+		if(OPT_RFP && depth < RFP_DEPTH && abs(beta) < ISMATE && staticEval - RFPMargin[depth] >= beta){
+			STAT_INC(info->stats.rfpCuts);
+			return beta;
+		}
+		
+		// Razoring: the static evaluation is so far below alpha that only captures may save the node.
+		if(OPT_RAZORING && depth < RAZOR_DEPTH && staticEval + RazorMargin[depth] <= alpha){
+			STAT_INC(info->stats.razorTries);
+			score = Quiescence(alpha, beta, pos, info, contemptFactor);
+			
+			if(info->stopped == TRUE) return 0;
+			
+			if(score <= alpha){
+				STAT_INC(info->stats.razorCuts);
+				return alpha;
+			}
+		}
+	}
+	
+	// Futility pruning: the quiet moves can't raise alpha.
+	u8 futile = (OPT_FUTILITY && !InCheck && !pvNode && depth < FUTILITY_DEPTH && abs(alpha) < ISMATE && staticEval + FutilityMargin[depth] <= alpha);
+	
 	u8 mateThreat = FALSE;
 	
 	#ifdef USE_NULLMOVE
-	if(DoNull && !InCheck && pos->ply && (pos->bigPce[pos->side] > 1) && depth >= 4){
+	// Null move is only tried if the static evaluation is already above beta, and
+	// the reduction grows with depth and with the margin of static evaluation above beta.
+	if(OPT_NULLMOVE && DoNull && !InCheck && !pvNode && pos->ply && (pos->bigPce[pos->side] > 1) && depth >= OPT_NULLMOVE_R && staticEval >= beta){
+		
+		s16 reduction = OPT_NULLMOVE_R + depth / NULL_DEPTH_DIV + ((staticEval - beta) / NULL_EVAL_DIV < 3 ? (staticEval - beta) / NULL_EVAL_DIV : 3);
+		u8 nullDepth = depth > reduction ? depth - reduction : 0;
 		
+		STAT_INC(info->stats.nullTries);
 		MakeNullMove(pos);
-		score = -AlphaBeta(-beta, -beta + 1, depth - 4, pos, info, FALSE, contemptFactor);
+		score = -AlphaBeta(-beta, -beta + 1, nullDepth, pos, info, FALSE, contemptFactor);
 		UnMakeNullMove(pos);
 		
 		if(info->stopped == TRUE) return 0;
 		
 		if(score >= beta && abs(score) < ISMATE){
-			info->nullCut++;
-			return beta;
+			
+			// In zugzwang passing is the best move, so at high depth the cutoff is
+			// verified by a search of the same reduced depth without null move.
+			if(depth >= NULL_VERIFY_DEPTH){
+				STAT_INC(info->stats.nullVerifies);
+				score = AlphaBeta(beta - 1, beta, nullDepth, pos, info, FALSE, contemptFactor);
+				
+				if(info->stopped == TRUE) return 0;
+			}
+			
+			if(score >= beta){
+				info->nullCut++;
+				return beta;
+			}
+			
+			STAT_INC(info->stats.nullVerifyFails);
+		}
+		
+		// If passing gets us mated, there is a threat that the moves should be searched deeper for. The search
+		// above is fail-hard around beta so it can't tell a mate, the null move is searched again with a window
+		// at the mate scores. The extension is limited to the plies below twice the root depth.
+		if(OPT_THREAT_EXTENSION && score < beta && beta > -ISMATE && pos->ply < 2 * info->rootDepth){
+			
+			MakeNullMove(pos);
+			score = -AlphaBeta(ISMATE - 1, ISMATE, nullDepth, pos, info, FALSE, contemptFactor);
+			UnMakeNullMove(pos);
+			
+			if(info->stopped == TRUE) return 0;
+			
+			if(score <= -ISMATE){
+				STAT_INC(info->stats.threatExtensions);
+				mateThreat = TRUE;
+			}
+		}
+		
+	}
+	#endif
+	
+	#ifdef USE_TABLES
+	// Without a hash move the move ordering is poor, so in PV nodes a reduced search is done first
+	// to find a move in the hash table, and non-PV nodes are searched one ply less (they'll be
+	// searched again with a hash move if they matter).
+	if(OPT_TABLES && pvMove == NOMOVE && excluded == NOMOVE){
+		if(OPT_IID && pvNode && depth >= IID_DEPTH){
+			
+			STAT_INC(info->stats.iidSearches);
+			AlphaBeta(alpha, beta, depth - IID_REDUCTION, pos, info, TRUE, contemptFactor);
+			
+			if(info->stopped == TRUE) return 0;
+			
+			pvMove = ProbePvTable(pos);
+		}else if(OPT_IIR && !pvNode && depth >= IIR_DEPTH){
+			STAT_INC(info->stats.iirReductions);
+			depth--;
 		}
+	}
+	#endif
+	
+	u8 singular = FALSE;
+	
+	#ifdef USE_TABLES
+	// Singular extension: if the hash move has a deep enough lower bound and all the other moves
+	// fail low against a margin below it, the hash move is singular and it is extended. If the
+	// other moves fail high against beta too, there are several good moves so the node is cut (multi-cut).
+	// The entry is taken again since the searches above may have replaced it.
+	if(entry != NULL) entry = GetHashEntry(pos);
+	
+	if(OPT_SINGULAR && entry != NULL && pvMove != NOMOVE && pos->ply && depth >= SINGULAR_DEPTH && entry->move == pvMove
+		&& entry->depth + 3 >= depth && (entry->flag == HFBETA || entry->flag == HFEXACT) && abs(entry->score) < ISMATE){
+		
+		s16 singularBeta = entry->score - SINGULAR_MARGIN * depth;
 		
-		if(abs(score) >= ISMATE) mateThreat = TRUE;
+		STAT_INC(info->stats.singularSearches);
+		pos->excludedMove[pos->ply] = pvMove;
+		score = AlphaBeta(singularBeta - 1, singularBeta, (depth - 1) / 2, pos, info, FALSE, contemptFactor);
+		pos->excludedMove[pos->ply] = NOMOVE;
 		
+		if(info->stopped == TRUE) return 0;
+		
+		if(score < singularBeta){
+			STAT_INC(info->stats.singularExtensions);
+			singular = TRUE;
+		}else if(singularBeta >= beta){
+			STAT_INC(info->stats.multiCuts);
+			return beta;
+		}
 	}
 	#endif
 	
@@ -274,6 +674,10 @@ static s16 AlphaBeta(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *
 	score = -INFINITY;
 	s16 oldAlpha = alpha;
 	
+	// The moves searched so far, they get a history malus when another move turns out to be the best.
+	s32 quietsTried[HISTORY_TRIED], capturesTried[HISTORY_TRIED];
+	u8 quietCount = 0, captureCount = 0;
+	
 	// If we have a pv move, give it the highest score to be search first.
  	if(pvMove != NOMOVE){
 		for(moveNum = 0; moveNum < list->count; moveNum++){
@@ -290,30 +694,75 @@ static s16 AlphaBeta(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *
 	
 	for(moveNum = 0; moveNum < list->count; moveNum++){
 		
-		if(!MakeMove(pos, list->moves[moveNum].move)) continue;
-
+		// The pawn push extension must look at the board before the move is made
+		s32 move = list->moves[moveNum].move;
+		if(move == excluded) continue;
+		
+		u8 quiet = !(move & MFLAGCAP);
+		s32 history = quiet ? QuietHistory(pos, move) : 0;
+		
 		u8 extend = 0;
-		// if(mateThreat) extend++;
-		if(pos->pieces[FROMSQ(list->moves[moveNum].move)] == wP && RanksBrd[SQ64(FROMSQ(list->moves[moveNum].move))] == RANK_7) extend++;
-		else if(pos->pieces[FROMSQ(list->moves[moveNum].move)] == bP && RanksBrd[SQ64(FROMSQ(list->moves[moveNum].move))] == RANK_2) extend++;
+		if(mateThreat) extend++;
+		if(singular && !extend && list->moves[moveNum].move == pvMove) extend++;
+		if(OPT_PAWN_EXTENSION && !extend){
+			if(pos->pieces[FROMSQ(list->moves[moveNum].move)] == wP && RanksBrd[FROM64(list->moves[moveNum].move)] == RANK_7) extend++;
+			else if(pos->pieces[FROMSQ(list->moves[moveNum].move)] == bP && RanksBrd[FROM64(list->moves[moveNum].move)] == RANK_2) extend++;
+		}
+		
+		if(!MakeMove(pos, list->moves[moveNum].move)) continue;
+		
+		// A move that gives check is extended by the check extension, so it doesn't get the threat extension too
+		if(mateThreat && IsSqAttacked(pos->kingSq[pos->side], pos->side ^ 1, pos)) extend--;
+		
+		// Prune the late quiet moves that don't give check in the shallow non-PV nodes.
+		if(legal > 0 && !InCheck && !pvNode && extend == 0 && !(list->moves[moveNum].move & (MFLAGCAP | MFLAGPRO))
+			&& (futile || (OPT_LMP && depth < LMP_DEPTH && legal >= LMPCount[depth]))
+			&& !IsSqAttacked(pos->kingSq[pos->side], pos->side ^ 1, pos)){
+			
+			if(futile) STAT_INC(info->stats.futilityPrunes);
+			else STAT_INC(info->stats.lmpPrunes);
+			
+			UnMakeMove(pos);
+			continue;
+		}
 		
 		if(legal > 0){
 			
 			// Late Move Reduction
-			if(legal >= 4 && !InCheck && extend == 0 && CAPTURED(list->moves[moveNum].move) == EMPTY && depth >= 3){
+			if(legal >= OPT_LMR_MOVES && !InCheck && extend == 0 && (quiet || IsEP(move)) && depth >= OPT_LMR_DEPTH){
 				
-				score = -AlphaBeta(-alpha - 1, -alpha, depth - 2, pos, info, TRUE, contemptFactor);
+				u8 reduction = OPT_LMR_REDUCTION;
+				
+				if(OPT_LMR_TABLE){
+					// The reduction grows with depth and move number, and it is one ply less if the static evaluation
+					// is improving, in PV nodes, for killers and counter moves, and for every LMR_HISTORY_DIVISOR of history.
+					// The extensions can take the depth beyond the table, so the indices are clamped
+					s16 r = LmrTable[MIN(depth, MAXDEPTH - 1)][MIN(legal, MAXPOSITIONMOVES - 1)];
+					if(improving) r--;
+					if(pvNode) r--;
+					if(list->moves[moveNum].score >= 700000 && list->moves[moveNum].score < 1000000) r--;
+					r -= history / LMR_HISTORY_DIVISOR;
+					
+					reduction = r > 0 ? r : 0;
+				}
+				
+				if(reduction > depth - 1) reduction = depth - 1;
+				
+				if(reduction){
+					score = -AlphaBeta(-alpha - 1, -alpha, depth - 1 - reduction, pos, info, TRUE, contemptFactor);
+					
+					STAT_INC(info->stats.lmrTries);
+					if(score > alpha) STAT_INC(info->stats.lmrFails);
+				}else score = alpha + 1;
 				
 			}else score = alpha + 1; // If the move was not reduced make sure we enter the ordinary searches below
 			
 			if(score > alpha){
-				info->nodes--;
 				
 				// PVs serach
 				score = -AlphaBeta(-alpha - 1, -alpha, depth - 1 + extend, pos, info, TRUE, contemptFactor);
 				
 				if(score > alpha && score < beta){
-					info->nodes--;
 					
 					// Full depth search
 					score = -AlphaBeta(-beta, -alpha, depth - 1 + extend, pos, info, TRUE, contemptFactor);
@@ -331,7 +780,7 @@ static s16 AlphaBeta(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *
 		
 		if(score > bestScore){
 			bestScore = score;
-			bestMove = list->moves[moveNum].move;
+			bestMove = move;
 			
 			if(score > alpha){				
 				if(score >= beta){
@@ -339,33 +788,206 @@ static s16 AlphaBeta(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *
 					if(legal == 1) info->fhf++;
 					info->fh++;
 					
-					if(!(bestMove & MFLAGCAP)){
+					if(OPT_KILLERS && quiet){
 						pos->searchKillers[1][pos->ply] = pos->searchKillers[0][pos->ply];
 						pos->searchKillers[0][pos->ply] = bestMove;
 					}
 					
-					StoreHashEntry(pos, bestMove, beta, HFBETA,depth);
+					UpdateHistories(pos, bestMove, depth, quietsTried, quietCount, capturesTried, captureCount);
+					
+					if(excluded == NOMOVE) StoreHashEntry(pos, bestMove, beta, staticEval, HFBETA, depth);
 					
 					return beta;
 					
 				}
 				
-				if(!(bestMove & MFLAGCAP)){
-					pos->searchHistory[pos->pieces[FROMSQ(bestMove)]][SQ64(TOSQ(bestMove))] += depth; 
-				} 
-				
 				alpha = score;
 			}
 		}
+		
+		if(quiet && quietCount < HISTORY_TRIED) quietsTried[quietCount++] = move;
+		else if(!quiet && captureCount < HISTORY_TRIED) capturesTried[captureCount++] = move;
 	}
 	
 	if(legal == 0){
-		if(InCheck) return MATE;   // Mate
-		else return 0;             // Stalemate
+		if(excluded != NOMOVE) return alpha;	// The excluded move is the only move
+		else if(InCheck) return MATE;   		// Mate
+		else return 0;             				// Stalemate
 	}
 	
-	if(alpha != oldAlpha) StoreHashEntry(pos, bestMove, bestScore, HFEXACT, depth);
-	else StoreHashEntry(pos, bestMove, alpha, HFALPHA, depth);
+	if(alpha != oldAlpha) UpdateHistories(pos, bestMove, depth, quietsTried, quietCount, capturesTried, captureCount);
+	
+	if(excluded != NOMOVE) return alpha;
+	
+	if(alpha != oldAlpha) StoreHashEntry(pos, bestMove, bestScore, staticEval, HFEXACT, depth);
+	else StoreHashEntry(pos, bestMove, alpha, staticEval, HFALPHA, depth);
+	
+	return alpha;
+}
+
+/**
+ * This function fills the root move list with the legal moves of the position, only the moves of
+ * "go searchmoves" are kept if it was given. The list is ordered like the moves of the other nodes
+ * with the hash move first, the later iterations reorder it by the results of the last one.
+ *
+ * @param pos The position's pointer.
+ * @param info The pinter of the engine information stucture.
+ * @param rootMoves The root move list to fill.
+ * @return The number of root moves.
+ */
+static u8 InitRootMoves(S_BOARD *pos, const S_SEARCHINFO *info, S_ROOTMOVE *rootMoves){
+	
+	S_MOVELIST list[1];
+	GenerateAllMoves(pos, list);
+	
+	s32 pvMove = ProbePvTable(pos);
+	u8 moveNum, index, count = 0;
+	
+	for(moveNum = 0; moveNum < list->count; moveNum++){
+		if(list->moves[moveNum].move == pvMove) list->moves[moveNum].score = 2000000;
+	}
+	if(list->count > 1) QuickSort(list, 0, list->count - 1);
+	
+	for(moveNum = 0; moveNum < list->count; moveNum++){
+		
+		s32 move = list->moves[moveNum].move;
+		if(!MakeMove(pos, move)) continue;
+		UnMakeMove(pos);
+		
+		if(info->searchMovesCount > 0){
+			for(index = 0; index < info->searchMovesCount && info->searchMoves[index] != move; index++);
+			if(index == info->searchMovesCount) continue;
+		}
+		
+		rootMoves[count].move = move;
+		rootMoves[count].score = -INFINITY;
+		rootMoves[count].nodes = 0;
+		count++;
+	}
+	
+	return count;
+}
+
+/**
+ * This function reorders the root move list after an iteration. The moves that improved alpha come first
+ * by their scores, so the best move and the MultiPV lines lead, and the rest follow by the nodes of
+ * their subtrees since a move that needed a big tree to be refuted is the most likely to become the best.
+ *
+ * @param rootMoves The root move list.
+ * @param count The number of root moves.
+ */
+static void SortRootMoves(S_ROOTMOVE *rootMoves, const u8 count){
+	
+	s16 index, index2;
+	
+	for(index = 1; index < count; index++){
+		S_ROOTMOVE temp = rootMoves[index];
+		for(index2 = index - 1; index2 >= 0; index2--){
+			if(rootMoves[index2].score > temp.score) break;
+			if(rootMoves[index2].score == temp.score && rootMoves[index2].nodes >= temp.nodes) break;
+			rootMoves[index2 + 1] = rootMoves[index2];
+		}
+		rootMoves[index2 + 1] = temp;
+	}
+}
+
+/**
+ * The search of the root node, it walks the root move list instead of generating the moves and records
+ * the score and the subtree nodes of every move for the ordering of the next iteration. The moves of
+ * the MultiPV lines found before in this iteration are skipped, and the root hash entry is never used
+ * to cut the search since the root must always return a move.
+ *
+ * @param alpha Alpha value.
+ * @param beta Beta value.
+ * @param depth The depth of the iteration.
+ * @param pos The position's pointer.
+ * @param info The pinter of the engine information stucture.
+ * @param rootMoves The root move list.
+ * @param count The number of root moves.
+ * @param contemptFactor The draw score of the side to move.
+ * @return The score of the root position.
+ */
+static s16 SearchRoot(s16 alpha, s16 beta, u8 depth, S_BOARD *pos, S_SEARCHINFO *info, S_ROOTMOVE *rootMoves, const u8 count, u8 contemptFactor){
+	
+	ASSERT(CheckBoard(pos));
+	ASSERT(beta > alpha);
+	
+	info->nodes++;
+	info->rootDepth = depth;
+	
+	u8 InCheck = IsSqAttacked(pos->kingSq[pos->side], pos->side ^ 1, pos);
+	if(InCheck == TRUE) depth++;
+	
+	s16 staticEval = InCheck ? -INFINITY : EvalPosition(pos);
+	pos->staticEval[0] = staticEval;
+	
+	u8 index, legal = 0;
+	s32 bestMove = NOMOVE;
+	s16 score, oldAlpha = alpha;
+	
+	s32 quietsTried[HISTORY_TRIED], capturesTried[HISTORY_TRIED];
+	u8 quietCount = 0, captureCount = 0;
+	
+	for(index = 0; index < count; index++){
+		
+		s32 move = rootMoves[index].move;
+		if(IsMultiPvMove(pos, move)) continue;
+		
+		u8 quiet = !(move & MFLAGCAP);
+		u64 startNodes = info->nodes;
+		
+		if(info->GAME_MODE == UCI_MODE && GetTimeMs() - info->starttime > CURRMOVE_TIME)
+			printf("info depth %d currmove %s currmovenumber %d\n", depth - InCheck, PrMove(move), index + 1);
+		
+		MakeMove(pos, move);
+		
+		if(legal > 0){
+			score = -AlphaBeta(-alpha - 1, -alpha, depth - 1, pos, info, TRUE, contemptFactor);
+			if(score > alpha && score < beta) score = -AlphaBeta(-beta, -alpha, depth - 1, pos, info, TRUE, contemptFactor);
+		}else{
+			score = -AlphaBeta(-beta, -alpha, depth - 1, pos, info, TRUE, contemptFactor);
+		}
+		
+		UnMakeMove(pos);
+		
+		legal++;
+		
+		if(info->stopped == TRUE) return 0;
+		
+		rootMoves[index].nodes = info->nodes - startNodes;
+		rootMoves[index].score = score > alpha ? score : -INFINITY;
+		
+		if(score > alpha){
+			bestMove = move;
+			
+			if(score >= beta){
+				
+				if(legal == 1) info->fhf++;
+				info->fh++;
+				
+				UpdateHistories(pos, bestMove, depth, quietsTried, quietCount, capturesTried, captureCount);
+				StoreHashEntry(pos, bestMove, beta, staticEval, HFBETA, depth);
+				
+				return beta;
+			}
+			
+			alpha = score;
+		}
+		
+		if(quiet && quietCount < HISTORY_TRIED) quietsTried[quietCount++] = move;
+		else if(!quiet && captureCount < HISTORY_TRIED) capturesTried[captureCount++] = move;
+	}
+	
+	if(legal == 0){
+		if(count > 0) return alpha;				// All the moves belong to the MultiPV lines before
+		else if(InCheck) return MATE;   		// Mate
+		else return 0;             				// Stalemate
+	}
+	
+	if(alpha != oldAlpha){
+		UpdateHistories(pos, bestMove, depth, quietsTried, quietCount, capturesTried, captureCount);
+		StoreHashEntry(pos, bestMove, alpha, staticEval, HFEXACT, depth);
+	}else StoreHashEntry(pos, rootMoves[0].move, alpha, staticEval, HFALPHA, depth);
 	
 	return alpha;
 }
@@ -396,17 +1018,21 @@ static void Pondering(S_BOARD *pos, S_SEARCHINFO *info){
 	info->depth = MAXDEPTH;
 	
 	if(bestMove == NOMOVE){
+		S_ROOTMOVE rootMoves[MAXPOSITIONMOVES];
+		u8 rootCount = InitRootMoves(pos, info, rootMoves);
+		
 		// Iterative deepening
 		for(currentDepth = 1; currentDepth <= info->depth;){
 		
 			u32 f = GetTimeMs();
-			bestScore = AlphaBeta(alpha, beta, currentDepth, pos, info, TRUE, contemptFactor);
+			bestScore = SearchRoot(alpha, beta, currentDepth, pos, info, rootMoves, rootCount, contemptFactor);
 			u32 l = GetTimeMs();
 			
 			if(info->stopped == TRUE) break;
 		
 			pvMoves = GetPvLine(currentDepth, pos);
 			bestMove = pos->PvArray[0];
+			SortRootMoves(rootMoves, rootCount);
 			
 			currentDepth++;
 		}
@@ -416,6 +1042,22 @@ static void Pondering(S_BOARD *pos, S_SEARCHINFO *info){
 	
 }
 
+/**
+ * Prints the score of an UCI "info" line, "mate" and the moves to mate (negative if the side to
+ * move is mated) for a mate score or "cp" and the score in centipawns.
+ *
+ * @param score The score.
+ * @param mate TRUE if any score but a draw is a mate score, a distance to mate tablebase score may be longer than MAXDEPTH.
+ */
+static void PrintUciScore(const s16 score, const u8 mate){
+	
+	if(score != 0 && (mate || abs(score) >= ISMATE)){
+		printf("info score mate %d", score > 0 ? (INFINITY - score + 1) / 2 : -((INFINITY + score) / 2));
+	}else{
+		printf("info score cp %d", score);
+	}
+}
+
 /**
  * The main function to find the best move for a given position.
  *
@@ -437,6 +1079,17 @@ void SearchPosition(S_BOARD *pos, S_SEARCHINFO *info){
 		bookMove = TRUE;
 	}	
 	
+	// The distance to mate tablebases play perfectly, there is nothing to search
+	s16 tbScore;
+	if(bestMove == NOMOVE && info->searchMovesCount == 0 && EngineOptions->MultiPV == 1 && (bestMove = ProbeRootDTM(pos, &tbScore)) != NOMOVE){
+		bookMove = TRUE;
+		if(info->GAME_MODE == UCI_MODE){
+			PrintUciScore(tbScore, TRUE);
+			printf("  depth 1 nodes 0 time 0 pv %s\n", PrMove(bestMove));
+		}
+		else if(info->POST_THINKING == TRUE) printf("tablebase score:%d pv %s\n", tbScore, PrMove(bestMove));
+	}
+	
 	//  Decide the contempt factor by looking at the phase the game is in
 	u8 gamePhase = GetGamePhase(pos);
 	u8 contemptFactor;
@@ -448,48 +1101,107 @@ void SearchPosition(S_BOARD *pos, S_SEARCHINFO *info){
 	s16 alpha = -INFINITY;
 	s16 beta = INFINITY;
 	
+	// The moves of "go searchmoves" are ignored if none of them is legal.
+	S_ROOTMOVE rootMoves[MAXPOSITIONMOVES];
+	u8 rootCount = InitRootMoves(pos, info, rootMoves);
+	if(rootCount == 0 && info->searchMovesCount > 0){
+		info->searchMovesCount = 0;
+		rootCount = InitRootMoves(pos, info, rootMoves);
+	}
+	
+	// MultiPV can't report more lines than the root moves.
+	u8 multiPV = EngineOptions->MultiPV, pvLine;
+	if(multiPV > rootCount) multiPV = rootCount;
+	if(multiPV == 0) multiPV = 1;
+	
 	if(bestMove == NOMOVE){
 		// Iterative deepening
 		for(currentDepth = 1; currentDepth <= info->depth;){
 		
+			#ifdef USE_SEARCH_STATS
+			u64 iterStartNodes = info->nodes;
+			#endif
 			u32 f = GetTimeMs();
-			bestScore = AlphaBeta(alpha, beta, currentDepth, pos, info, TRUE, contemptFactor);
-			u32 l = GetTimeMs();
-			
-			if(info->stopped == TRUE) break;
-		
-			pvMoves = GetPvLine(currentDepth, pos);
-			bestMove = pos->PvArray[0];
-			predictMove = pos->PvArray[1];
 			
-			if(info->GAME_MODE == UCI_MODE){
+			// Every MultiPV line is searched with the first moves of the lines before it excluded from the root.
+			pos->multiPvCount = 0;
+			for(pvLine = 0; pvLine < multiPV; pvLine++){
 				
-				printf("info score cp %d  depth %d nodes %ld time %d ",
-					bestScore, currentDepth, info->nodes, GetTimeMs() - info->starttime);
-					
-			}else if(info->GAME_MODE == XBOARD_MODE && info->POST_THINKING == TRUE){
-				
-				printf("%d %d %d %ld", currentDepth, bestScore, (GetTimeMs() - info->starttime) / 10, info->nodes);
-			}else if(info->POST_THINKING == TRUE){
-				
-				printf("score:%d  depth:%d nodes:%ld time:%d(ms) p:%ld ",
-					bestScore, currentDepth, info->nodes, GetTimeMs() - info->starttime, l - f);
+				s16 score = SearchRoot(alpha, beta, currentDepth, pos, info, rootMoves, rootCount, contemptFactor);
+				u32 l = GetTimeMs();
 				
-			}
+				if(info->stopped == TRUE) break;
 			
-			if(info->GAME_MODE == UCI_MODE || info->POST_THINKING == TRUE){
-				printf("pv");
+				pvMoves = GetPvLine(currentDepth, pos);
+				
+				if(pvLine == 0){
+					bestScore = score;
+					bestMove = pos->PvArray[0];
+					predictMove = pos->PvArray[1];
+				}else{
+					// The root entry belongs to the best line, the excluded search has overwritten it.
+					StoreHashEntry(pos, bestMove, bestScore, -INFINITY, HFEXACT, currentDepth);
+				}
+				pos->multiPvMoves[pos->multiPvCount++] = pos->PvArray[0];
 				
-				for(pvNum = 0; pvNum < pvMoves; pvNum++)
-					printf(" %s", PrMove(pos->PvArray[pvNum]));
+				if(info->GAME_MODE == UCI_MODE){
+					
+					PrintUciScore(score, FALSE);
+					printf("  depth %d nodes %llu time %d ",
+						currentDepth, (unsigned long long)info->nodes, GetTimeMs() - info->starttime);
+					if(multiPV > 1) printf("multipv %d ", pvLine + 1);
+						
+				}else if(info->GAME_MODE == XBOARD_MODE && info->POST_THINKING == TRUE){
+					
+					printf("%d %d %d %llu ", currentDepth, score, (GetTimeMs() - info->starttime) / 10, (unsigned long long)info->nodes);
+				}else if(info->POST_THINKING == TRUE){
+					
+					if(multiPV > 1) printf("%d. ", pvLine + 1);
+					printf("score:%d  depth:%d nodes:%llu time:%d(ms) p:%u ",
+						score, currentDepth, (unsigned long long)info->nodes, GetTimeMs() - info->starttime, l - f);
+					
+				}
 				
-				printf("\n");
+				if(info->GAME_MODE == UCI_MODE || info->POST_THINKING == TRUE){
+					printf("pv");
+					
+					for(pvNum = 0; pvNum < pvMoves; pvNum++)
+						printf(" %s", PrMove(pos->PvArray[pvNum]));
+					
+					printf("\n");
+				}
 			}
+			pos->multiPvCount = 0;
+			
+			if(info->stopped == TRUE) break;
+			
+			SortRootMoves(rootMoves, rootCount);
+			
+			#ifdef USE_SEARCH_STATS
+			info->stats.iterNodes[currentDepth] = info->nodes - iterStartNodes;
+			info->stats.iterTime[currentDepth] = GetTimeMs() - f;
+			info->stats.iterations = currentDepth;
+			#endif
+			
+			// "go mate" is answered once a mate in the given number of moves (or a shorter one) is found.
+			if(info->mate && bestScore >= INFINITY - (2 * info->mate - 1)) break;
 			
 			currentDepth++;
 		}
+		
+		// The search may be stopped before the first iteration ends, the best ordered move is played then.
+		if(bestMove == NOMOVE && rootCount > 0) bestMove = rootMoves[0].move;
+		
+		#ifdef USE_SEARCH_STATS
+		PrintSearchStats(pos, info);
+		#endif
 	}
 	
+	// The limits of "go" belong to this search only, pondering is never limited by them.
+	info->nodeLimit = 0;
+	info->mate = 0;
+	info->searchMovesCount = 0;
+	
 	if(info->GAME_MODE == UCI_MODE){
 		printf("bestmove %s\n", PrMove(bestMove));
 		MakeMove(pos, bestMove);
@@ -514,19 +1226,19 @@ void SearchPosition(S_BOARD *pos, S_SEARCHINFO *info){
 /** 
  * This is fuction used in DebugAnalysisTest() to check some test suites and
  * compare the result of search to the result of the test suite.
+ *
+ * It searches silently until the time is up and records in the job when the best move
+ * became correct (one of bm moves, or none of am moves) and stayed correct till the end.
  * 
  * @param pos The position's pointer.
  * @param info The pinter of the engine information stucture.
- * @param moveTo The square wher the piece move to from test suite.
- * @param am A flag to avoid move.
+ * @param job The pointer of the test suite position, the result of search is stored in it.
  * @return bestMove The best move for the given position.
  */
-s32 SearchDebug(S_BOARD *pos, S_SEARCHINFO *info, s8 *moveTo, u8 am){
+s32 SearchDebug(S_BOARD *pos, S_SEARCHINFO *info, S_EPDJOB *job){
 	
 	s32 bestMove = NOMOVE;
-	s16 bestScore = -INFINITY;
-	u8 currentDepth;
-	u8 pvMoves, pvNum;
+	u8 currentDepth, index, correct;
 	
 	ClearForSearch(pos, info);
 	
@@ -541,64 +1253,42 @@ s32 SearchDebug(S_BOARD *pos, S_SEARCHINFO *info, s8 *moveTo, u8 am){
 	s16 alpha = -INFINITY;
 	s16 beta = INFINITY;
 	
-	for(currentDepth = 1; currentDepth <= info->depth;){
+	job->depth = 0;
+	job->solveDepth = 0;
 	
-		u32 f = GetTimeMs();
-		bestScore = AlphaBeta(alpha, beta, currentDepth, pos, info, TRUE, contemptFactor);
-		u32 l = GetTimeMs();
-		
-		if(info->stopped == TRUE){
-			SetColor(LIGHT_GREEN);
-			printf("TIME OUT!");
-			SetColor(LIGHT_GRAY);
-			break;
-		}
-		
+	S_ROOTMOVE rootMoves[MAXPOSITIONMOVES];
+	u8 rootCount = InitRootMoves(pos, info, rootMoves);
+	
+	for(currentDepth = 1; currentDepth <= info->depth; currentDepth++){
 	
-		pvMoves = GetPvLine(currentDepth, pos);
+		SearchRoot(alpha, beta, currentDepth, pos, info, rootMoves, rootCount, contemptFactor);
+		if(info->stopped == TRUE) break;
+		
+		GetPvLine(currentDepth, pos);
 		bestMove = pos->PvArray[0];
+		SortRootMoves(rootMoves, rootCount);
+		job->depth = currentDepth;
 		
-		if(info->GAME_MODE == UCI_MODE){
-			
-			printf("info score cp %d  depth %d nodes %ld time %d ",
-				bestScore, currentDepth, info->nodes, GetTimeMs() - info->starttime);
-				
-		}else if(info->GAME_MODE == XBOARD_MODE && info->POST_THINKING == TRUE){
-			
-			printf("%d %d %d %ld", currentDepth, bestScore, (GetTimeMs() - info->starttime) / 10, info->nodes);
-		}else if(info->POST_THINKING == TRUE){
-			
-			printf("score:%d  depth:%d nodes:%ld time:%d(ms) p:%ld ",
-				bestScore, currentDepth, info->nodes, GetTimeMs() - info->starttime, l - f);
-			
+		correct = job->am;
+		for(index = 0; index < job->moveCount; index++){
+			if(job->moves[index] == bestMove){
+				correct = !job->am;
+				break;
+			}
 		}
 		
-		if(info->GAME_MODE == UCI_MODE || info->POST_THINKING == TRUE){
-			printf("pv");
-			
-			for(pvNum = 0; pvNum < pvMoves; pvNum++)
-				printf(" %s", PrMove(pos->PvArray[pvNum]));
-			
-			printf("\n");
+		if(!correct) job->solveDepth = 0;
+		else if(job->solveDepth == 0){
+			job->solveDepth = currentDepth;
+			job->solveTime = GetTimeMs() - info->starttime;
+			job->solveNodes = info->nodes;
 		}
-		
-		char *sq = PrSq(TOSQ(bestMove));
-		if(sq[0] == moveTo[0] && sq[1] == moveTo[1] && !am) break;
-
-		currentDepth++;
 	}
 	
-	if(info->GAME_MODE == UCI_MODE){
-		printf("bestmove %s\n", PrMove(bestMove));
-		
-	}else if(info->GAME_MODE == XBOARD_MODE){
-		printf("move %s\n", PrMove(bestMove));
-		MakeMove(pos, bestMove);
-	}else{
-		printf("\n\n!! %s make move %s !!\n\n", NAME, PrMove(bestMove));
-		MakeMove(pos, bestMove);
-		PrintBoard(pos);
-	}
+	job->bestMove = bestMove;
+	job->nodes = info->nodes;
+	job->time = GetTimeMs() - info->starttime;
+	
 	return bestMove;
 }
 
@@ -13,19 +13,19 @@
 
 #include"defs.h"
 
-static u8 move_to; 											// Holds the square where the captures take place
-static u8 move_from; 											// Holds the square from the initial attacker
-static u8 b_attackers_total; 									// Keeps track of the number of white attackers
-static u8 w_attackers_total; 									// Keeps track of the number of black attackers
+static THREAD_LOCAL u8 move_to; 							// Holds the square where the captures take place
+static THREAD_LOCAL u8 move_from; 							// Holds the square from the initial attacker
+static THREAD_LOCAL u8 b_attackers_total; 					// Keeps track of the number of white attackers
+static THREAD_LOCAL u8 w_attackers_total; 					// Keeps track of the number of black attackers
 
 
 
 /// The values are full pawns and not centipawns, and we don't need to worry
 /// about nuances like giving queens a slightly higher value than 9 pawns
 const u8 piece_values[13] = {0, 1, 3, 3, 5, 9, 99, 1, 3, 3, 5, 9, 99};
-static u8 w_attackers[16] = {0};
-static u8 b_attackers[16] = {0};
-static s8 scores[32] = {0}; // Holds the values after each capture
+static THREAD_LOCAL u8 w_attackers[16] = {0};
+static THREAD_LOCAL u8 b_attackers[16] = {0};
+static THREAD_LOCAL s16 scores[32] = {0}; // Holds the values after each capture
 
 
 /**
@@ -145,12 +145,12 @@ static void AddHidden(u8 startIndex, const S_BOARD *pos){
 s32 SEE(const S_BOARD *pos, s32 move){
 	
 	ASSERT(MoveValid(move, pos));
-	ASSERT(CAPTURED(move) != EMPTY || move & MFLAGEP);
+	ASSERT(CAPTURED(pos, move) != EMPTY || IsEP(move));
 	
 	// A simple check to see we are actually trying a capturing move
 	// if the move is not a capture there is not capture sequence
 	// and we won't go any further
-	if(!(CAPTURED(move) != EMPTY || move & MFLAGEP)) return 0;
+	if(!(CAPTURED(pos, move) != EMPTY || IsEP(move))) return 0;
 
 	// Initialize global variables
 	move_from = FROMSQ(move);
@@ -159,12 +159,12 @@ s32 SEE(const S_BOARD *pos, s32 move){
 	
 	move_to = TOSQ(move);
 	ASSERT(SqOnBoard(move_to));
-	ASSERT(PieceValid(pos->pieces[move_to] || move & MFLAGEP));
+	ASSERT(IsEP(move) || PieceValid(pos->pieces[move_to]));
 	
 	w_attackers_total = 0;
 	b_attackers_total = 0;
 
-	u8 capture_value = 0; 									// Will be set to the total gain of the caputre sequence
+	s16 capture_value = 0; 									// Will be set to the total gain of the caputre sequence
 	u8 tempAttack;										 	// Temporary variable used below
 	u8 sideToMove; 											// Keeps track of what side is moving
 	u8 attacked_piece_value; 								// Keeps track of the value of the piece that is standing on the attacked square after each capture                                  
@@ -294,7 +294,7 @@ s32 SEE(const S_BOARD *pos, s32 move){
 	
 	AddHidden(move_from, pos); 											// We now add any hidden attacker that was behind the inital attacker
 	
-	if(move & MFLAGEP){
+	if(IsEP(move)){
 		if(pos->side == WHITE){
 			scores[0] =  piece_values[bP];
 			AddHidden(move_to - 10, pos); 
@@ -302,7 +302,7 @@ s32 SEE(const S_BOARD *pos, s32 move){
 			scores[0] =  piece_values[wP];
 			AddHidden(move_to + 10, pos); 
 		}
-	}else scores[0] =  piece_values[CAPTURED(move)]; 					// We now have a first for the capture sequence, this is the value of the initally captured piece
+	}else scores[0] =  piece_values[CAPTURED(pos, move)]; 					// We now have a first for the capture sequence, this is the value of the initally captured piece
 
 	u8 scoresIndex = 1; 												// Keeps track of where in the sequence we are
 	u8 w_attackers_count = 0; 											// Keeps track of how many white pieces we have analyzed below
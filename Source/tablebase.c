@@ -0,0 +1,421 @@
+/**
+ * @file tablebase.c
+ * This file handles probing of the endgame tablebases.
+ *
+ * Every tablebase has two files generated by gentb (see tbgen.c): "<code>.wdl" has the
+ * win/draw/loss value of every position in 2 bits and "<code>.dtm" has its distance to mate
+ * in a byte. Both files are memory-mapped and a probe reads one value at its index.
+ *
+ * The index of a position is the side to move and the square of every piece in the order
+ * of the code, the kings first (e.g. KRKP: white king, black king, white rook, black pawn).
+ * A position where black has the pieces of white in the code is probed with the board
+ * flipped and the colors swapped. There is no castling or en passant in the tables.
+ *
+ * The files keep one position of every set of positions that are the same by the symmetry
+ * of the board, the one with the white king in the a1-d1-d4 triangle (the 8 symmetries) or
+ * on files a-d for the tables with pawns (the file mirror), see TBFileIndex().
+ *
+ * @author Tarek Elmenshawy (tarek.elmenshawy1997@gmail.com)
+ * Date: April 2020
+ */
+
+#include"defs.h"
+#include"string.h"
+
+#ifdef WIN32
+	#include"windows.h"
+#else
+	#include"fcntl.h"
+	#include"unistd.h"
+	#include"sys/mman.h"
+	#include"sys/stat.h"
+#endif
+
+/// The tables, every table comes after the tables that its captures and promotions lead to.
+S_TBTABLE Tablebases[] = {
+	{"KQK"}, {"KRK"}, {"KBK"}, {"KNK"}, {"KPK"},
+	{"KQQK"}, {"KQRK"}, {"KQBK"}, {"KQNK"}, {"KRRK"}, {"KRBK"}, {"KRNK"}, {"KBBK"}, {"KBNK"}, {"KNNK"},
+	{"KQKQ"}, {"KQKR"}, {"KQKB"}, {"KQKN"}, {"KRKR"}, {"KRKB"}, {"KRKN"}, {"KBKB"}, {"KBKN"}, {"KNKN"},
+	{"KQPK"}, {"KRPK"}, {"KBPK"}, {"KNPK"}, {"KPPK"},
+	{"KQKP"}, {"KRKP"}, {"KBKP"}, {"KNKP"}, {"KPKP"},
+};
+
+const u8 TablebasesNum = sizeof(Tablebases) / sizeof(S_TBTABLE);
+
+static u8 TBMaxPieces = 0;	///< The most pieces of a loaded table, 0 if no table is loaded.
+
+/**
+ * Map a file into memory for reading.
+ *
+ * @param name The name of the file.
+ * @param size The pointer to receive the size of the file.
+ * @return A pointer to the mapped file, NULL if it can't be mapped.
+ */
+static const u8 *MapFile(const char *name, u32 *size){
+#ifdef WIN32
+	HANDLE file = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) return NULL;
+	*size = GetFileSize(file, NULL);
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if(mapping == NULL) return NULL;
+	const u8 *data = (const u8 *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	return data;
+#else
+	struct stat info;
+	s32 file = open(name, O_RDONLY);
+	if(file < 0) return NULL;
+	if(fstat(file, &info) < 0 || info.st_size < (off_t) sizeof(S_TBHEADER)){
+		close(file);
+		return NULL;
+	}
+	*size = info.st_size;
+	void *data = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	return data == MAP_FAILED ? NULL : (const u8 *) data;
+#endif
+}
+
+/// Unmap a file mapped by MapFile().
+static void UnmapFile(const u8 *data, const u32 size){
+#ifdef WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap((void *) data, size);
+#endif
+}
+
+/**
+ * Returns TRUE if a mapped file is a tablebase file of the table.
+ *
+ * @param table The pointer of the table.
+ * @param data The mapped file.
+ * @param size The size of the file in bytes.
+ * @param bits The bits of a value of the file (TB_WDL_BITS or TB_DTM_BITS).
+ */
+static u8 ValidFile(const S_TBTABLE *table, const u8 *data, const u32 size, const u8 bits){
+	const S_TBHEADER *header = (const S_TBHEADER *) data;
+	return !memcmp(header->magic, "MCTB", 4) && header->entries == table->entries && header->bits == bits
+		&& size == sizeof(S_TBHEADER) + (table->entries * bits + 7) / 8;
+}
+
+/**
+ * Writes the name of a tablebase file, the directory then the code and the extension.
+ *
+ * @param name The buffer of TB_NAME_SIZE characters to receive the name.
+ * @param path The directory of the file.
+ * @param code The code of the table (e.g. "KRKP").
+ * @param extension The extension of the file ("wdl" or "dtm").
+ * @return TRUE if the name fits the buffer, FALSE if the directory is too long.
+ */
+u8 TBFileName(char *name, const char *path, const char *code, const char *extension){
+
+	s32 length = snprintf(name, TB_NAME_SIZE, "%s/%s.%s", path, code, extension);
+	return length >= 0 && length < TB_NAME_SIZE;
+}
+
+/**
+ * Set the pieces, size and material keys of every table from its code and map the
+ * tablebase files found in the directory.
+ *
+ * @param path The directory of the tablebase files.
+ */
+void InitTablebases(const char *path){
+
+	const char *pieceChars = "PNBRQK";
+	char name[TB_NAME_SIZE];
+	u8 i, k, loaded = 0, tooLong = FALSE;
+	TBMaxPieces = 0;
+
+	for(i = 0; i < TablebasesNum; i++){
+
+		S_TBTABLE *table = &Tablebases[i];
+		const char *black = strchr(table->code + 1, 'K');
+		u8 white = black - table->code;
+
+		// The kings then the other white pieces then the other black pieces
+		table->count = 0;
+		table->pieces[table->count++] = wK;
+		table->pieces[table->count++] = bK;
+		for(k = 1; k < white; k++) table->pieces[table->count++] = wP + (strchr(pieceChars, table->code[k]) - pieceChars);
+		for(k = 1; black[k] != '\0'; k++) table->pieces[table->count++] = bP + (strchr(pieceChars, black[k]) - pieceChars);
+
+		table->size = 2UL << (6 * table->count);
+		table->pawns = FALSE;
+		for(k = 0; k < table->count; k++) table->pawns |= PiecePawn[table->pieces[k]];
+		table->entries = 2UL * (table->pawns ? TB_PAWN_KING_SLOTS : TB_KING_SLOTS) << (6 * (table->count - 1));
+		table->materialKey[WHITE] = EndgameMaterialKey(table->code, WHITE);
+		table->materialKey[BLACK] = EndgameMaterialKey(table->code, BLACK);
+
+		if(table->wdl != NULL) UnmapFile(table->wdl, table->wdlSize);
+		if(table->dtm != NULL) UnmapFile(table->dtm, table->dtmSize);
+		table->wdl = table->dtm = NULL;
+
+		// A truncated name may be another file, so nothing is mapped
+		if(!TBFileName(name, path, table->code, "wdl")){
+			tooLong = TRUE;
+			continue;
+		}
+		table->wdl = MapFile(name, &table->wdlSize);
+		if(TBFileName(name, path, table->code, "dtm")) table->dtm = MapFile(name, &table->dtmSize);
+
+		// A table is used only if both files are valid
+		if(table->wdl == NULL || table->dtm == NULL || !ValidFile(table, table->wdl, table->wdlSize, TB_WDL_BITS)
+			|| !ValidFile(table, table->dtm, table->dtmSize, TB_DTM_BITS)){
+			if(table->wdl != NULL) UnmapFile(table->wdl, table->wdlSize);
+			if(table->dtm != NULL) UnmapFile(table->dtm, table->dtmSize);
+			table->wdl = table->dtm = NULL;
+			continue;
+		}
+
+		loaded++;
+		if(table->count > TBMaxPieces) TBMaxPieces = table->count;
+	}
+
+	if(tooLong){
+		SetColor(LIGHT_RED);
+		printf("INFO: Tablebases Directory Is Too Long For The File Names(%d characters), %s!!!\n", TB_NAME_SIZE, path);
+		SetColor(LIGHT_GRAY);
+	}
+
+	if(loaded){
+		SetColor(LIGHT_RED);
+		printf("INFO: Tablebases Init Complete With %d Tables(up to %d pieces).\n", loaded, TBMaxPieces);
+		SetColor(LIGHT_GRAY);
+	}
+}
+
+/**
+ * Unmap the tablebase files.
+ */
+void CleanTablebases(){
+
+	u8 i;
+
+	for(i = 0; i < TablebasesNum; i++){
+		if(Tablebases[i].wdl != NULL) UnmapFile(Tablebases[i].wdl, Tablebases[i].wdlSize);
+		if(Tablebases[i].dtm != NULL) UnmapFile(Tablebases[i].dtm, Tablebases[i].dtmSize);
+		Tablebases[i].wdl = Tablebases[i].dtm = NULL;
+	}
+	TBMaxPieces = 0;
+}
+
+/**
+ * Find the tablebase of a set of pieces and the index of the position in it.
+ *
+ * @param pieces The pieces (wP ... bK).
+ * @param squares The squares (64) of the pieces.
+ * @param count The number of pieces.
+ * @param side The side to move.
+ * @param index The pointer to receive the index of the position.
+ * @return A pointer to the table, NULL if there is no table of these pieces.
+ */
+S_TBTABLE *TBLookup(const u8 *pieces, const u8 *squares, const u8 count, const u8 side, u32 *index){
+
+	u8 counts[13] = {0};
+	u8 used[TB_MAXPIECES] = {0};
+	u8 i, k, strong;
+	u64 key = 0ULL;
+
+	if(count > TB_MAXPIECES) return NULL;
+
+	for(i = 0; i < count; i++) key ^= PieceKeys[pieces[i]][counts[pieces[i]]++];
+
+	for(i = 0; i < TablebasesNum; i++){
+
+		S_TBTABLE *table = &Tablebases[i];
+		if(table->count != count) continue;
+
+		if(key == table->materialKey[WHITE]) strong = WHITE;
+		else if(key == table->materialKey[BLACK]) strong = BLACK;
+		else continue;
+
+		// White of the table is the strong side, the board is flipped if it is black
+		*index = side ^ strong;
+		for(k = 0; k < count; k++){
+			u8 piece = table->pieces[k];
+			if(strong == BLACK) piece = PieceCol[piece] == WHITE ? piece + (bP - wP) : piece - (bP - wP);
+			u8 j = 0;
+			while(used[j] || pieces[j] != piece) j++;
+			used[j] = TRUE;
+			*index |= (u32)(strong == WHITE ? squares[j] : squares[j] ^ 56) << (1 + 6 * k);
+		}
+
+		return table;
+	}
+
+	return NULL;
+}
+
+/**
+ * Returns the index of a position in the files of a tablebase. The board is mirrored so the
+ * white king is on files a-d, and for a table without pawns flipped so it is on ranks 1-4 and
+ * flipped on the diagonal so it is in the a1-d1-d4 triangle. The index is the side to move,
+ * the square of the white king in these squares and the squares of the other pieces.
+ *
+ * @param table The pointer of the table.
+ * @param index The index of the position in the table.
+ */
+u32 TBFileIndex(const S_TBTABLE *table, const u32 index){
+
+	u8 squares[TB_MAXPIECES];
+	u8 k, file, rank, transform = 0;
+	u32 fileIndex = 0;
+
+	for(k = 0; k < table->count; k++) squares[k] = (index >> (1 + 6 * k)) & 63;
+
+	if((squares[0] & 7) > 3) transform |= 7;
+	if(!table->pawns && (squares[0] >> 3) > 3) transform |= 56;
+	for(k = 0; k < table->count; k++) squares[k] ^= transform;
+
+	file = squares[0] & 7;
+	rank = squares[0] >> 3;
+	if(!table->pawns && rank > file){
+		for(k = 0; k < table->count; k++) squares[k] = (squares[k] >> 3) | ((squares[k] & 7) << 3);
+		file = squares[0] & 7;
+		rank = squares[0] >> 3;
+	}
+
+	for(k = table->count - 1; k > 0; k--) fileIndex = (fileIndex << 6) | squares[k];
+
+	// The triangle has 4 squares on rank 1, 3 on rank 2, 2 on rank 3 and 1 on rank 4
+	u8 slot = table->pawns ? rank * 4 + file : 4 * rank - rank * (rank - 1) / 2 + file - rank;
+	fileIndex = fileIndex * (table->pawns ? TB_PAWN_KING_SLOTS : TB_KING_SLOTS) + slot;
+
+	return (fileIndex << 1) | (index & 1);
+}
+
+/**
+ * Returns the win/draw/loss value or the distance to mate code of a position in a tablebase,
+ * the table must be in memory (generator) or its files must be mapped.
+ *
+ * @param table The pointer of the table.
+ * @param index The index of the position.
+ * @param dtm TRUE to return the distance to mate code, FALSE to return the win/draw/loss value.
+ */
+u8 TBRead(const S_TBTABLE *table, const u32 index, const u8 dtm){
+
+	u8 code;
+
+	if(table->data != NULL) code = table->data[index];
+	else if(dtm) code = table->dtm[sizeof(S_TBHEADER) + TBFileIndex(table, index)];
+	else{
+		// 4 values in a byte, the first in the low bits
+		u32 fileIndex = TBFileIndex(table, index);
+		return (table->wdl[sizeof(S_TBHEADER) + fileIndex / 4] >> (2 * (fileIndex & 3))) & 3;
+	}
+
+	if(!dtm){
+		if(code == TB_CODE_ILLEGAL) return WDL_ILLEGAL;
+		if(code == TB_CODE_DRAW) return WDL_DRAW;
+		return (code & 1) ? WDL_LOSS : WDL_WIN;
+	}
+	return code;
+}
+
+/**
+ * Find the tablebase of a position and the index of the position in it.
+ *
+ * @param pos The position's pointer.
+ * @param index The pointer to receive the index of the position.
+ * @return A pointer to the table, NULL if there is no loaded table for the position.
+ */
+static S_TBTABLE *BoardLookup(const S_BOARD *pos, u32 *index){
+
+	u8 pieces[TB_MAXPIECES], squares[TB_MAXPIECES];
+	u8 piece, i, count = 0;
+
+	for(piece = wP; piece <= bK; piece++){
+		if(count + pos->pceNum[piece] > TBMaxPieces) return NULL;
+		for(i = 0; i < pos->pceNum[piece]; i++){
+			pieces[count] = piece;
+			squares[count++] = SQ64(pos->pList[piece][i]);
+		}
+	}
+
+	if(pos->castlePerm) return NULL;
+
+	// The en passant square matters only if a pawn can capture on it
+	if(pos->enPass != NO_SQ){
+		if(pos->side == WHITE && (pos->pieces[pos->enPass - 9] == wP || pos->pieces[pos->enPass - 11] == wP)) return NULL;
+		if(pos->side == BLACK && (pos->pieces[pos->enPass + 9] == bP || pos->pieces[pos->enPass + 11] == bP)) return NULL;
+	}
+
+	S_TBTABLE *table = TBLookup(pieces, squares, count, pos->side, index);
+	if(table == NULL || table->wdl == NULL) return NULL;
+	return table;
+}
+
+/**
+ * Probe the win/draw/loss value of a position, the fifty move rule is not considered.
+ *
+ * @param pos The position's pointer.
+ * @param wdl The pointer to receive 1 if the side to move wins, 0 if it is a draw and -1 if it loses.
+ * @return TRUE if the position was found in a tablebase, FALSE if not.
+ */
+u8 ProbeWDL(const S_BOARD *pos, s8 *wdl){
+
+	u32 index;
+
+	// The pieces are counted from the counters and the pawn bitboard of the board, most positions of a
+	// search have more pieces than the tables and nothing else is done for them
+	if(pos->bigPce[WHITE] + pos->bigPce[BLACK] + POPCOUNT(pos->pawns[BOTH]) > TBMaxPieces || pos->castlePerm) return FALSE;
+
+	S_TBTABLE *table = BoardLookup(pos, &index);
+	if(table == NULL) return FALSE;
+
+	u8 value = TBRead(table, index, FALSE);
+	if(value == WDL_ILLEGAL) return FALSE;
+
+	*wdl = (s8) value - WDL_DRAW;
+	return TRUE;
+}
+
+/**
+ * Returns the move of perfect play in a position by the distance to mate tablebases, the
+ * shortest win, or a draw, or the longest loss. The fifty move rule is not considered.
+ *
+ * @param pos The position's pointer.
+ * @param score The pointer to receive the score of the move, a mate score for a win or a loss.
+ * @return The best move, NOMOVE if there is no tablebase for the position or one of its moves.
+ */
+s32 ProbeRootDTM(S_BOARD *pos, s16 *score){
+
+	S_MOVELIST list[1];
+	s32 bestMove = NOMOVE;
+	s16 best = -INFINITY, value;
+	u32 index;
+	u8 i, code;
+
+	if(TBMaxPieces == 0 || BoardLookup(pos, &index) == NULL) return NOMOVE;
+
+	GenerateAllMoves(pos, list);
+
+	for(i = 0; i < list->count; i++){
+
+		if(!MakeMove(pos, list->moves[i].move)) continue;
+
+		S_TBTABLE *table = BoardLookup(pos, &index);
+
+		if(pos->material[WHITE] + pos->material[BLACK] == 0) code = TB_CODE_DRAW;	// Only the kings are left
+		else if(table != NULL) code = TBRead(table, index, TRUE);
+		else code = TB_CODE_ILLEGAL;
+
+		UnMakeMove(pos);
+		if(code == TB_CODE_ILLEGAL) return NOMOVE;
+
+		// The code is from the opponent's side, a loss in n plies for him is a win in n + 1 plies
+		if(code == TB_CODE_DRAW) value = 0;
+		else if(code & 1) value = INFINITY - code;
+		else value = code - INFINITY;
+
+		if(value > best){
+			best = value;
+			bestMove = list->moves[i].move;
+		}
+	}
+
+	*score = best;
+	return bestMove;
+}
@@ -0,0 +1,534 @@
+/**
+ * @file tbgen.c
+ * This file generates the endgame tablebases (gentb).
+ *
+ * A table is generated by retrograde analysis over all indices of the table:
+ * - The first pass generates the moves of every position. The checkmates, stalemates and
+ *   the moves that leave the table (captures and promotions) are resolved by the tables
+ *   generated before, and the other moves are counted.
+ * - Pass n takes the positions won or lost in n plies and goes back to the positions before
+ *   them by un-moving the pieces of the side that just moved. A position before a loss is a
+ *   win in n + 1 plies, and a position before a win loses one of its counted moves, when
+ *   none is left the position is lost.
+ * - The positions that are not resolved when no pass finds new positions are draws.
+ *
+ * The indices have no symmetry reduction, so every position (and every order of identical
+ * pieces) is a different index and the moves are never counted twice. This keeps the tables
+ * simple and correct but large in memory, 2 x 64 ^ 4 positions for 4 pieces, 5 pieces would
+ * need 2 x 64 ^ 5 bytes for every array and isn't generated by default (TB_MAXPIECES). The
+ * files are written with the symmetry reduction of tablebase.c.
+ *
+ * The moves of the positions are generated from bitboards of the few pieces instead of the
+ * boards of the engine, the squares of the index are the squares of the pieces in
+ * S_BOARD (SQ64), so the tables are probed from any board by TBLookup().
+ *
+ * @author Tarek Elmenshawy (tarek.elmenshawy1997@gmail.com)
+ * Date: April 2020
+ */
+
+#include"defs.h"
+#include"string.h"
+#include"pthread.h"
+
+#ifdef WIN32
+	#include"direct.h"
+#else
+	#include"sys/stat.h"
+#endif
+
+#define TB_PASS_INIT	 0						///< Job of the first pass, generating the moves of every position.
+#define TB_PASS_RETRO	 1						///< Job of the retrograde passes, un-moving the positions resolved in the last pass.
+
+/// This is a struct that represents a position of the table being generated.
+typedef struct{
+	u8 squares[TB_MAXPIECES];					///< The squares (64) of the pieces in the order of the table.
+	u8 side;									///< The side to move.
+	u64 occupied;								///< The squares of all pieces.
+	u64 colour[2];								///< The squares of the white and black pieces.
+}S_TBPOS;
+
+/// This is a struct that represents the job of a generation thread, a range of indices of one pass.
+typedef struct{
+	u32 start;									///< The first index of the range.
+	u32 end;									///< The index after the last index of the range.
+	u8 pass;									///< TB_PASS_INIT or TB_PASS_RETRO.
+	u8 code;									///< The distance to mate code of the positions resolved in the last pass (TB_PASS_RETRO).
+}S_TBJOB;
+
+static S_TBTABLE *GenTable;						///< The table being generated.
+static u8 *Counts;								///< The moves of every position that are not known to lose yet (draws included).
+static u8 *ExitLoss;							///< The longest loss (in plies of the opponent's win) of every position by leaving the table.
+static volatile u8 MaxCode;						///< The largest distance to mate code found so far.
+static volatile u8 GenFailed;					///< Set if a table that the captures or promotions lead to isn't generated.
+
+/**
+ * Returns the squares attacked by a piece.
+ *
+ * @param piece The piece (wP ... bK).
+ * @param sq The square (64) of the piece.
+ * @param occupied The occupied squares.
+ */
+static u64 TBAttacks(const u8 piece, const u8 sq, const u64 occupied){
+
+	u64 bb = 1ULL << sq;
+
+	switch(piece){
+		case wP: return ((bb << 9) & ~FILE_A_BB) | ((bb << 7) & ~FILE_H_BB);
+		case bP: return ((bb >> 7) & ~FILE_A_BB) | ((bb >> 9) & ~FILE_H_BB);
+		case wN: case bN: return KnightAttacks[sq];
+		case wB: case bB: return BishopAttacks(sq, occupied);
+		case wR: case bR: return RookAttacks(sq, occupied);
+		case wQ: case bQ: return BishopAttacks(sq, occupied) | RookAttacks(sq, occupied);
+		default: return KingAttacks[sq];
+	}
+}
+
+/**
+ * Returns TRUE if a square is attacked by the pieces of a side.
+ *
+ * @param pieces The pieces.
+ * @param squares The squares (64) of the pieces.
+ * @param count The number of pieces.
+ * @param sq The square (64).
+ * @param side The attacking side.
+ * @param occupied The occupied squares.
+ */
+static u8 TBAttacked(const u8 *pieces, const u8 *squares, const u8 count, const u8 sq, const u8 side, const u64 occupied){
+
+	u8 i;
+
+	for(i = 0; i < count; i++){
+		if(PieceCol[pieces[i]] == side && (TBAttacks(pieces[i], squares[i], occupied) & (1ULL << sq))) return TRUE;
+	}
+	return FALSE;
+}
+
+/// Returns the index of a position of the table being generated.
+static u32 TBIndex(const u8 *squares, const u8 side){
+
+	u32 index = side;
+	u8 k;
+
+	for(k = 0; k < GenTable->count; k++) index |= (u32) squares[k] << (1 + 6 * k);
+	return index;
+}
+
+/**
+ * Decodes an index of the table being generated.
+ *
+ * @param index The index.
+ * @param p The position to be filled.
+ * @return TRUE if the position is legal, FALSE if not.
+ */
+static u8 TBDecode(const u32 index, S_TBPOS *p){
+
+	u8 k;
+
+	p->side = index & 1;
+	p->occupied = p->colour[WHITE] = p->colour[BLACK] = 0ULL;
+
+	for(k = 0; k < GenTable->count; k++){
+		u8 sq = (index >> (1 + 6 * k)) & 63;
+		u8 piece = GenTable->pieces[k];
+		if(p->occupied & (1ULL << sq)) return FALSE;
+		if(PiecePawn[piece] && (RanksBrd[sq] == RANK_1 || RanksBrd[sq] == RANK_8)) return FALSE;
+		p->squares[k] = sq;
+		p->occupied |= 1ULL << sq;
+		p->colour[PieceCol[piece]] |= 1ULL << sq;
+	}
+
+	// The side that isn't to move can't be in check
+	return !TBAttacked(GenTable->pieces, p->squares, GenTable->count, p->squares[p->side ^ 1], p->side, p->occupied);
+}
+
+/**
+ * Returns the distance to mate code of a position after a move that leaves the table.
+ *
+ * @param pieces The pieces after the move.
+ * @param squares The squares (64) of the pieces after the move.
+ * @param count The number of pieces after the move.
+ * @param side The side to move after the move.
+ */
+static u8 TBExitCode(const u8 *pieces, const u8 *squares, const u8 count, const u8 side){
+
+	u32 index;
+
+	// Only the kings are left
+	if(count == 2) return TB_CODE_DRAW;
+
+	S_TBTABLE *table = TBLookup(pieces, squares, count, side, &index);
+	if(table == NULL || (table->data == NULL && table->dtm == NULL)){
+		GenFailed = TRUE;
+		return TB_CODE_DRAW;
+	}
+	return TBRead(table, index, TRUE);
+}
+
+/**
+ * Generates the legal moves of a legal position and resolves it if possible.
+ *
+ * @param index The index of the position.
+ * @param p The decoded position.
+ */
+static void TBInitPosition(const u32 index, const S_TBPOS *p){
+
+	const u8 *pieces = GenTable->pieces;
+	u8 count = GenTable->count, side = p->side;
+	u8 childPieces[TB_MAXPIECES], childSquares[TB_MAXPIECES];
+	u8 i, k, captured, promotion, legal = 0, moves = 0, exitLoss = 0, win = TB_CODE_ILLEGAL;
+	s8 push = (side == WHITE) ? 8 : -8;
+	u64 targets;
+
+	for(i = 0; i < count; i++){
+
+		if(PieceCol[pieces[i]] != side) continue;
+		u8 from = p->squares[i];
+
+		if(PiecePawn[pieces[i]]){
+			targets = TBAttacks(pieces[i], from, p->occupied) & p->colour[side ^ 1];
+			if(!(p->occupied & (1ULL << (from + push)))){
+				targets |= 1ULL << (from + push);
+				if(RanksBrd[from] == (side == WHITE ? RANK_2 : RANK_7) && !(p->occupied & (1ULL << (from + 2 * push)))){
+					targets |= 1ULL << (from + 2 * push);
+				}
+			}
+		}else{
+			targets = TBAttacks(pieces[i], from, p->occupied) & ~p->colour[side];
+		}
+
+		while(targets){
+
+			u8 to = PopBit(&targets);
+			u8 last = PiecePawn[pieces[i]] && (RanksBrd[to] == RANK_1 || RanksBrd[to] == RANK_8);
+
+			// Every promotion is a move of its own, a move that isn't a promotion is done once
+			for(promotion = 0; promotion < (last ? 4 : 1); promotion++){
+
+				u8 childCount = 0;
+				captured = FALSE;
+				for(k = 0; k < count; k++){
+					if(k != i && p->squares[k] == to){
+						captured = TRUE;
+						continue;
+					}
+					childPieces[childCount] = (k == i && last) ? PromotedPce[side][promotion] : pieces[k];
+					childSquares[childCount++] = (k == i) ? to : p->squares[k];
+				}
+
+				// The king of the side can't be in check after its move
+				u64 occupied = (p->occupied ^ (1ULL << from)) | (1ULL << to);
+				u8 king = (side == WHITE) ? childSquares[0] : childSquares[1];
+				if(TBAttacked(childPieces, childSquares, childCount, king, side ^ 1, occupied)) continue;
+				legal++;
+
+				if(!captured && !last){
+					moves++;
+					continue;
+				}
+
+				// The move leaves the table, a loss of the opponent is a win and a win of the opponent is a loss
+				u8 code = TBExitCode(childPieces, childSquares, childCount, side ^ 1);
+				if(code == TB_CODE_DRAW) moves++;
+				else if(code & 1){
+					if(code + 1 < win) win = code + 1;
+				}else if(code - 1 > exitLoss) exitLoss = code - 1;
+			}
+		}
+	}
+
+	Counts[index] = moves;
+	ExitLoss[index] = exitLoss;
+
+	if(legal == 0){
+		// Checkmate or stalemate
+		u8 king = (side == WHITE) ? p->squares[0] : p->squares[1];
+		GenTable->data[index] = TBAttacked(pieces, p->squares, count, king, side ^ 1, p->occupied) ? 1 : TB_CODE_DRAW;
+	}else if(win != TB_CODE_ILLEGAL){
+		GenTable->data[index] = win;
+	}else if(moves == 0){
+		// Every move leaves the table and loses
+		GenTable->data[index] = exitLoss + 2;
+	}else{
+		GenTable->data[index] = TB_CODE_DRAW;
+	}
+}
+
+/**
+ * Resolves the positions before a position that was resolved in the last pass.
+ *
+ * @param p The decoded position.
+ * @param code The distance to mate code of the position.
+ */
+static void TBRetroPosition(const S_TBPOS *p, const u8 code){
+
+	const u8 *pieces = GenTable->pieces;
+	u8 count = GenTable->count, mover = p->side ^ 1;
+	u8 squares[TB_MAXPIECES];
+	u8 *data = GenTable->data;
+	u8 i;
+	u64 froms;
+
+	memcpy(squares, p->squares, count);
+
+	for(i = 0; i < count; i++){
+
+		if(PieceCol[pieces[i]] != mover) continue;
+		u8 to = p->squares[i];
+
+		// The pawns un-move one or two squares back, the other pieces un-move like they move
+		if(PiecePawn[pieces[i]]){
+			s8 back = (mover == WHITE) ? -8 : 8;
+			u8 relativeRank = (mover == WHITE) ? RanksBrd[to] : RANK_8 - RanksBrd[to];
+			froms = 0ULL;
+			if(relativeRank >= RANK_3 && !(p->occupied & (1ULL << (to + back)))){
+				froms |= 1ULL << (to + back);
+				if(relativeRank == RANK_4 && !(p->occupied & (1ULL << (to + 2 * back)))) froms |= 1ULL << (to + 2 * back);
+			}
+		}else{
+			froms = TBAttacks(pieces[i], to, p->occupied) & ~p->occupied;
+		}
+
+		while(froms){
+
+			u8 from = PopBit(&froms);
+			squares[i] = from;
+
+			// The side to move of this position can't be in check before the move
+			u64 occupied = (p->occupied ^ (1ULL << to)) | (1ULL << from);
+			if(TBAttacked(pieces, squares, count, squares[p->side], mover, occupied)) continue;
+
+			u32 before = TBIndex(squares, mover);
+
+			if(code & 1){
+				// A loss of the side to move is a win for the position before it
+				u8 old = data[before];
+				while((old == TB_CODE_DRAW || (!(old & 1) && old > code + 1)) && !__sync_bool_compare_and_swap(&data[before], old, code + 1)){
+					old = data[before];
+				}
+				if(code + 1 > MaxCode) MaxCode = code + 1;
+			}else if(data[before] == TB_CODE_DRAW && __sync_sub_and_fetch(&Counts[before], 1) == 0){
+				// Every move of the position before loses, the longest loss is taken
+				u8 plies = 1 + (code - 1 > ExitLoss[before] ? code - 1 : ExitLoss[before]);
+				data[before] = plies + 1;
+				if(plies + 1 > MaxCode) MaxCode = plies + 1;
+			}
+		}
+		squares[i] = to;
+	}
+}
+
+/// A generation thread, it runs one pass over a range of indices.
+static void *TBWorker(void *arg){
+
+	S_TBJOB *job = (S_TBJOB *) arg;
+	S_TBPOS p[1];
+	u32 index;
+
+	for(index = job->start; index < job->end; index++){
+
+		if(job->pass == TB_PASS_INIT){
+			if(TBDecode(index, p)) TBInitPosition(index, p);
+			else{
+				GenTable->data[index] = TB_CODE_ILLEGAL;
+				Counts[index] = 0;
+			}
+		}else if(GenTable->data[index] == job->code){
+			TBDecode(index, p);
+			TBRetroPosition(p, job->code);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Runs a pass of the generation over all indices of the table with the given threads.
+ *
+ * @param threads The number of threads.
+ * @param pass TB_PASS_INIT or TB_PASS_RETRO.
+ * @param code The distance to mate code of the positions resolved in the last pass.
+ */
+static void TBRunPass(const u8 threads, const u8 pass, const u8 code){
+
+	S_TBJOB jobs[threads];
+	pthread_t tid[threads];
+	u8 i, started = 0;
+	u32 step = GenTable->size / threads;
+
+	for(i = 0; i < threads; i++){
+		jobs[i].start = i * step;
+		jobs[i].end = (i == threads - 1) ? GenTable->size : (i + 1) * step;
+		jobs[i].pass = pass;
+		jobs[i].code = code;
+	}
+
+	for(i = 1; i < threads; i++){
+		if(pthread_create(&tid[i], NULL, TBWorker, &jobs[i]) != 0) break;
+		started++;
+	}
+	TBWorker(&jobs[0]);
+	for(i = 1; i <= started; i++) pthread_join(tid[i], NULL);
+
+	// The jobs of the threads that couldn't be created run on this thread
+	for(i = started + 1; i < threads; i++) TBWorker(&jobs[i]);
+}
+
+/**
+ * Writes a tablebase file, one value of every position at its index in the file (TBFileIndex()),
+ * the win/draw/loss values packed in TB_WDL_BITS bits and the distance to mate codes in a byte.
+ *
+ * @param name The name of the file.
+ * @param table The generated table.
+ * @param dtm TRUE to write the distance to mate codes, FALSE to write the win/draw/loss values.
+ * @return The size of the file in bytes, 0 if it can't be written.
+ */
+static u32 TBWriteFile(const char *name, const S_TBTABLE *table, const u8 dtm){
+
+	u8 bits = dtm ? TB_DTM_BITS : TB_WDL_BITS;
+	u32 bytes = (table->entries * bits + 7) / 8, index;
+
+	// Every position that isn't written is illegal, TB_CODE_ILLEGAL and WDL_ILLEGAL have all bits set
+	u8 *values = (u8 *) malloc(bytes);
+	if(values == NULL) return 0;
+	memset(values, 0xFF, bytes);
+
+	// The positions that are the same by symmetry have the same index and value
+	for(index = 0; index < table->size; index++){
+		u8 value = TBRead(table, index, dtm);
+		if(value == (dtm ? TB_CODE_ILLEGAL : WDL_ILLEGAL)) continue;
+		u32 fileIndex = TBFileIndex(table, index);
+		if(dtm) values[fileIndex] = value;
+		else values[fileIndex / 4] &= ~((WDL_ILLEGAL ^ value) << (2 * (fileIndex & 3)));
+	}
+
+	S_TBHEADER header;
+	memcpy(header.magic, "MCTB", 4);
+	header.entries = table->entries;
+	header.bits = bits;
+
+	FILE *file = fopen(name, "wb");
+	u8 written = file != NULL && fwrite(&header, sizeof(S_TBHEADER), 1, file) == 1 && fwrite(values, 1, bytes, file) == bytes;
+	if(file != NULL) fclose(file);
+	free(values);
+
+	return written ? sizeof(S_TBHEADER) + bytes : 0;
+}
+
+/**
+ * Generates one table, its distance to mate codes are kept in memory for the tables after it.
+ *
+ * @param table The table.
+ * @param path The directory of the files.
+ * @param threads The number of threads.
+ * @return TRUE if the table is generated and written, FALSE if not.
+ */
+static u8 TBGenerate(S_TBTABLE *table, const char *path, const u8 threads){
+
+	char name[TB_NAME_SIZE];
+	s32 start = GetTimeMs();
+	u32 index, results[3] = {0, 0, 0};
+	u8 code;
+
+	// The files couldn't be written after the generation
+	if(!TBFileName(name, path, table->code, "wdl")){
+		printf("%-6s the directory is too long for the file names (%d characters)\n", table->code, TB_NAME_SIZE);
+		return FALSE;
+	}
+
+	GenTable = table;
+	table->data = (u8 *) malloc(table->size);
+	Counts = (u8 *) malloc(table->size);
+	ExitLoss = (u8 *) malloc(table->size);
+
+	if(table->data == NULL || Counts == NULL || ExitLoss == NULL){
+		printf("%-6s memory isn't enough for %u positions\n", table->code, table->size);
+		free(table->data);
+		free(Counts);
+		free(ExitLoss);
+		table->data = NULL;
+		return FALSE;
+	}
+
+	GenFailed = FALSE;
+	MaxCode = 0;
+	TBRunPass(threads, TB_PASS_INIT, 0);
+
+	if(GenFailed){
+		printf("%-6s a table that its captures or promotions lead to isn't generated\n", table->code);
+		free(table->data);
+		table->data = NULL;
+	}else{
+		// The first pass may resolve positions by leaving the table with any distance
+		for(index = 0; index < table->size; index++){
+			code = table->data[index];
+			if(code != TB_CODE_ILLEGAL && code > MaxCode) MaxCode = code;
+		}
+		for(code = 1; code <= MaxCode && code < TB_CODE_ILLEGAL; code++) TBRunPass(threads, TB_PASS_RETRO, code);
+	}
+
+	free(Counts);
+	free(ExitLoss);
+	if(table->data == NULL) return FALSE;
+
+	// The longest mate is counted from the results, MaxCode may be larger than any of them
+	MaxCode = 0;
+	for(index = 0; index < table->size; index++){
+		u8 value = TBRead(table, index, FALSE);
+		if(value != WDL_ILLEGAL) results[value]++;
+		if(value != WDL_ILLEGAL && table->data[index] > MaxCode) MaxCode = table->data[index];
+	}
+
+	u32 wdlSize = TBFileName(name, path, table->code, "wdl") ? TBWriteFile(name, table, FALSE) : 0;
+	u32 dtmSize = TBFileName(name, path, table->code, "dtm") ? TBWriteFile(name, table, TRUE) : 0;
+
+	printf("%-6s %10u positions, win %9u draw %9u loss %9u, longest mate %3d plies, wdl %6u KB, dtm %6u KB, %d ms\n",
+		table->code, table->size, results[WDL_WIN], results[WDL_DRAW], results[WDL_LOSS], MaxCode - 1,
+		wdlSize / 1024, dtmSize / 1024, GetTimeMs() - start);
+
+	return wdlSize != 0 && dtmSize != 0;
+}
+
+/**
+ * Generates the tablebases of the given codes (all tables if none is given) and writes their
+ * files in the directory. The tables that the captures and promotions of a table lead to must
+ * be generated before it, or their files must be in the directory.
+ *
+ * @param path The directory of the files.
+ * @param threads The number of threads.
+ * @param codes The codes of the tables to generate (e.g. "KRKP").
+ * @param count The number of codes, 0 to generate all tables.
+ * @return The number of tables that failed.
+ */
+s32 GenerateTablebases(const char *path, const u8 threads, char **codes, const u8 count){
+
+	s32 start = GetTimeMs(), failed = 0;
+	u8 i, k;
+
+#ifdef WIN32
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+
+	// The files that are already generated are used for the captures and promotions
+	InitTablebases(path);
+
+	for(i = 0; i < TablebasesNum; i++){
+
+		u8 wanted = (count == 0);
+		for(k = 0; k < count; k++){
+			if(!strcmp(codes[k], Tablebases[i].code)) wanted = TRUE;
+		}
+		if(!wanted || Tablebases[i].count > TB_MAXPIECES) continue;
+
+		if(!TBGenerate(&Tablebases[i], path, threads < 1 ? 1 : threads)) failed++;
+	}
+
+	for(i = 0; i < TablebasesNum; i++){
+		free(Tablebases[i].data);
+		Tablebases[i].data = NULL;
+	}
+	CleanTablebases();
+
+	printf("\n%d tables failed, %d ms\n", failed, GetTimeMs() - start);
+	return failed;
+}
@@ -0,0 +1,548 @@
+/**
+ * @file tune.c
+ * This file loads and saves the evaluation weights and tunes them (Texel's tuning method).
+ *
+ * All weights of the evaluation are in EvalWeights, they are saved in a text file of named
+ * weights that the engine loads at startup (WEIGHTS_FILE) or by the UCI option EvalFile.
+ *
+ * The tuner reads labelled positions (a FEN and the result of the game) and minimizes the
+ * mean squared error between the results and the expected scores of the static evaluations,
+ * sigmoid(K * eval / 400). The evaluation traces the coefficients of the weights it uses, so
+ * the gradient of every position is computed from one evaluation, the positions are evaluated
+ * by several threads and the weights are updated by Adam after every pass over all positions.
+ * The middle game and ending values of every weight are tuned separately. The first pass checks
+ * that the trace of every position sums to its evaluation, otherwise the gradient is wrong.
+ * The evaluation is static (no quiescence search), so the positions should be quiet.
+ *
+ * @author Tarek Elmenshawy (tarek.elmenshawy1997@gmail.com)
+ * Date: April 2020
+ */
+
+#include"defs.h"
+#include"string.h"
+#include"math.h"		// It defines INFINITY too, so the engine's INFINITY must not be used in this file
+#include"pthread.h"
+
+#define TUNE_PASS_EVAL		 0					///< Job of keeping the evaluations of the positions, to fit the constant K.
+#define TUNE_PASS_GRADIENT	 1					///< Job of computing the loss and the gradient of the positions.
+
+#define WEIGHTS_DELIMITERS	" \t\r\n,()"			///< The characters between the names and values of the weights file.
+
+/// This is a struct that describes a named group of weights in the weights file.
+typedef struct{
+	const char *name;							///< The name of the weights in the file.
+	S_SCORE *weights;							///< The pointer of the first weight in EvalWeights.
+	u16 count;									///< The number of weights.
+}S_WEIGHTINFO;
+
+/// This is a struct that represents the job of a tuning thread, a range of the positions.
+typedef struct{
+	u32 start;									///< The first position of the range.
+	u32 end;									///< The position after the last position of the range.
+	u8 pass;									///< TUNE_PASS_EVAL or TUNE_PASS_GRADIENT.
+	double K;									///< The scaling constant of the sigmoid.
+	double loss;								///< The sum of the squared errors of the range.
+	double *gradient;							///< The gradient of the range, EVAL_TRACE_SIZE values (middle game and ending of every weight).
+	u32 mismatches;								///< The positions of the range that their trace doesn't sum to their evaluation (TUNE_PASS_EVAL).
+}S_TUNEJOB;
+
+static const S_WEIGHTINFO WeightsTable[] = {
+	{"PIECE_VALUE",					EvalWeights.pieceValue,					5},
+	{"BISHOP_PAIR",					&EvalWeights.bishopPair,				1},
+	{"DOUBLED_PAWN",				&EvalWeights.doubledPawn,				1},
+	{"ISOLATED_PAWN",				&EvalWeights.isolatedPawn,				1},
+	{"WEAK_PAWN",					&EvalWeights.weakPawn,					1},
+	{"PASSED_RANK",					EvalWeights.passedRank,					8},
+	{"UNSTOPPABLE_PASSER",			&EvalWeights.unstoppablePasser,			1},
+	{"KNIGHT_OUTPOST",				EvalWeights.knightOutpost,				64},
+	{"ROOK_ON_OPEN",				&EvalWeights.rookOnOpen,				1},
+	{"ROOK_ON_SEMI",				&EvalWeights.rookOnSemi,				1},
+	{"ROOK_ON_SEVENTH",				&EvalWeights.rookOnSeventh,				1},
+	{"ROOK_BEHIND_PASSER",			&EvalWeights.rookBehindPasser,			1},
+	{"QUEEN_ON_SEVENTH",			&EvalWeights.queenOnSeventh,			1},
+	{"PINNED_PIECE",				&EvalWeights.pinnedPiece,				1},
+	{"MOBILITY",					&EvalWeights.mobility,					1},
+	{"MOBILITY_SAFE",				&EvalWeights.mobilitySafe,				1},
+	{"LOW_MOBILITY",				&EvalWeights.lowMobility,				1},
+	{"TROPISM_KNIGHT",				EvalWeights.tropism[0],					8},
+	{"TROPISM_BISHOP",				EvalWeights.tropism[1],					8},
+	{"TROPISM_ROOK",				EvalWeights.tropism[2],					8},
+	{"TROPISM_QUEEN",				EvalWeights.tropism[3],					8},
+	{"KING_ATTACK",					EvalWeights.kingAttack,					80},
+	{"KING_SHELTER",				EvalWeights.kingShelter,				8},
+	{"PAWN_STORM",					EvalWeights.pawnStorm,					8},
+	{"FIANCHETTO",					&EvalWeights.fianchetto,				1},
+	{"KING_WEAK_PAWN",				&EvalWeights.kingWeakPawn,				1},
+	{"TRAPPED_KNIGHT",				&EvalWeights.trappedKnight,				1},
+	{"TRAPPED_KNIGHT_CORNER",		&EvalWeights.trappedKnightCorner,		1},
+	{"TRAPPED_BISHOP",				&EvalWeights.trappedBishop,				1},
+	{"TRAPPED_BISHOP_SUPPORTED",	&EvalWeights.trappedBishopSupported,	1},
+	{"TRAPPED_ROOK",				&EvalWeights.trappedRook,				1},
+	{"BLOCKED_CENTER_PAWN",			&EvalWeights.blockedCenterPawn,			1},
+	{"BLOCKED_BISHOP",				&EvalWeights.blockedBishop,				1},
+	{"HUNG_PIECES",					&EvalWeights.hungPieces,				1},
+	{"TEMPO",						&EvalWeights.tempo,						1},
+	{"PAWN_POS",					EvalWeights.pst[0],						64},
+	{"KNIGHT_POS",					EvalWeights.pst[1],						64},
+	{"BISHOP_POS",					EvalWeights.pst[2],						64},
+	{"ROOK_POS",					EvalWeights.pst[3],						64},
+	{"QUEEN_POS",					EvalWeights.pst[4],						64},
+	{"KING_POS",					EvalWeights.pst[5],						64},
+	{NULL,							NULL,									0}
+};
+
+static char *TuneFens;							///< The FENs of all positions, every one ends with '\0'.
+static u64 *TuneOffsets;						///< The offset of the FEN of every position in TuneFens.
+static float *TuneResults;						///< The result of the game of every position from white's point of view (1, 0.5 or 0).
+static s16 *TuneEvals;							///< The evaluation of every position from white's point of view (TUNE_PASS_EVAL).
+static u32 TuneCount;							///< The number of positions.
+
+/**
+ * Returns the weights of a name in the weights file.
+ *
+ * @param name The name of the weights.
+ * @return The pointer of its entry in the weights table, NULL if there isn't any.
+ */
+static const S_WEIGHTINFO *FindWeights(const char *name){
+
+	const S_WEIGHTINFO *info;
+
+	for(info = WeightsTable; info->name != NULL; info++){
+		if(!strcmp(info->name, name)) return info;
+	}
+	return NULL;
+}
+
+/**
+ * Loads the evaluation weights from a file. The file has the name of every group of weights
+ * followed by the middle game and ending values of every weight (e.g. "(100, 120)"), separated
+ * by any white space, commas or brackets, and '#' starts a comment until the end of the line.
+ * A group that isn't in the file keeps its current values. The weights are changed only if the
+ * whole file is valid.
+ *
+ * @param fileName The name of the file.
+ * @return TRUE if the weights are loaded, FALSE if the file can't be read or isn't valid.
+ */
+u8 LoadEvalWeights(const char *fileName){
+
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL) return FALSE;
+
+	S_EVALWEIGHTS weights = EvalWeights;
+	const S_WEIGHTINFO *info = NULL;
+	char line[1024], *token;
+	u32 lineNo = 0, loaded = 0;
+	u16 index = 0;
+	s32 value, mg = 0;
+	u8 valid = TRUE;
+
+	while(valid && fgets(line, sizeof(line), file) != NULL){
+		lineNo++;
+		if((token = strchr(line, '#')) != NULL) *token = '\0';
+
+		for(token = strtok(line, WEIGHTS_DELIMITERS); token != NULL && valid; token = strtok(NULL, WEIGHTS_DELIMITERS)){
+			if(sscanf(token, "%d", &value) == 1){
+				if(info == NULL || index >= 2 * info->count || abs(value) > WEIGHT_MAX){
+					valid = FALSE;
+					break;
+				}
+				// The weight is packed when its ending value is read, it goes to the same place in the copy
+				if(index++ % 2 == 0) mg = value;
+				else *((S_SCORE *) &weights + (info->weights - (S_SCORE *) &EvalWeights) + index / 2 - 1) = SCORE(mg, value);
+			}else{
+				if(info != NULL && index != 2 * info->count){
+					valid = FALSE;
+					break;
+				}
+				if((info = FindWeights(token)) == NULL){
+					valid = FALSE;
+					break;
+				}
+				index = 0;
+				loaded++;
+			}
+		}
+	}
+	fclose(file);
+
+	if(info != NULL && index != 2 * info->count) valid = FALSE;
+
+	SetColor(LIGHT_RED);
+	if(valid){
+		EvalWeights = weights;
+		InitPieceSquare();
+		printf("INFO: Evaluation Weights Loaded From %s (%d Groups Of %d).\n", fileName, loaded, (s32)(sizeof(WeightsTable) / sizeof(S_WEIGHTINFO) - 1));
+	}else{
+		printf("INFO: Evaluation Weights File %s Isn't Valid At Line %d, The Weights Aren't Changed.\n", fileName, lineNo);
+	}
+	SetColor(LIGHT_GRAY);
+
+	return valid;
+}
+
+/**
+ * Saves the evaluation weights to a file that LoadEvalWeights() can read, the tables are
+ * printed 8 weights per line.
+ *
+ * @param fileName The name of the file.
+ * @return TRUE if the file is written, FALSE if not.
+ */
+u8 SaveEvalWeights(const char *fileName){
+
+	FILE *file = fopen(fileName, "w");
+	if(file == NULL) return FALSE;
+
+	const S_WEIGHTINFO *info;
+	u16 index;
+
+	fprintf(file, "# %s evaluation weights, (middle game, ending)\n", NAME);
+
+	for(info = WeightsTable; info->name != NULL; info++){
+		if(info->count == 1){
+			fprintf(file, "%s (%d, %d)\n", info->name, SCORE_MG(info->weights[0]), SCORE_EG(info->weights[0]));
+			continue;
+		}
+		fprintf(file, "%s\n", info->name);
+		for(index = 0; index < info->count; index++){
+			fprintf(file, "(%4d,%4d)%s", SCORE_MG(info->weights[index]), SCORE_EG(info->weights[index]), (index % 8 == 7 || index == info->count - 1) ? "\n" : " ");
+		}
+	}
+
+	return fclose(file) == 0;
+}
+
+/**
+ * Returns the result of a labelled position, the label is after the FEN as a PGN result
+ * ("1-0", "0-1", "1/2-1/2") or a number in brackets ([1.0], [0.5], [0.0]).
+ *
+ * @param line The line of the position.
+ * @param result The result from white's point of view.
+ * @return TRUE if the line has a result, FALSE if not.
+ */
+static u8 ParseResult(const char *line, float *result){
+
+	const char *ptr;
+
+	if((ptr = strchr(line, '[')) != NULL) return sscanf(ptr + 1, "%f", result) == 1 && *result >= 0 && *result <= 1;
+	if(strstr(line, "1/2-1/2") != NULL) *result = 0.5;
+	else if(strstr(line, "1-0") != NULL) *result = 1.0;
+	else if(strstr(line, "0-1") != NULL) *result = 0.0;
+	else return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * Reads the labelled positions of a file into TuneFens, TuneOffsets and TuneResults, the lines
+ * without a result or a valid FEN are skipped.
+ *
+ * @param fileName The name of the file.
+ * @param pos A board to check the FENs.
+ * @return The number of positions, 0 if the file can't be read.
+ */
+static u32 LoadPositions(const char *fileName, S_BOARD *pos){
+
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL) return 0;
+
+	char line[TUNE_LINE_SIZE];
+	u64 size = 0, capacity = 0;
+	u32 limit = 0, skipped = 0;
+	float result;
+	void *ptr;
+
+	TuneCount = 0;
+
+	while(fgets(line, sizeof(line), file) != NULL){
+		if(!ParseResult(line, &result) || !ParseFen(line, pos) || pos->pceNum[wK] != 1 || pos->pceNum[bK] != 1){
+			skipped++;
+			continue;
+		}
+
+		// Keep the first 4 fields of the FEN only, the move counters and the label aren't needed
+		u16 length = 0, fields = 0;
+		while(line[length] != '\0' && line[length] != '\n' && line[length] != '\r'){
+			if(line[length] == ' ' && ++fields == 4) break;
+			length++;
+		}
+
+		if(TuneCount == limit){
+			limit = limit ? 2 * limit : 1 << 16;
+			if((ptr = realloc(TuneOffsets, limit * sizeof(u64))) == NULL) break;
+			TuneOffsets = ptr;
+			if((ptr = realloc(TuneResults, limit * sizeof(float))) == NULL) break;
+			TuneResults = ptr;
+		}
+		if(size + length + 1 > capacity){
+			capacity = capacity ? 2 * capacity : 1 << 22;
+			if((ptr = realloc(TuneFens, capacity)) == NULL) break;
+			TuneFens = ptr;
+		}
+
+		memcpy(TuneFens + size, line, length);
+		TuneFens[size + length] = '\0';
+		TuneOffsets[TuneCount] = size;
+		TuneResults[TuneCount++] = result;
+		size += length + 1;
+	}
+	fclose(file);
+
+	if(skipped){
+		SetColor(LIGHT_RED);
+		printf("INFO: %d Lines Without A Valid Position Or Result Are Skipped.\n", skipped);
+		SetColor(LIGHT_GRAY);
+	}
+
+	return TuneCount;
+}
+
+/// Returns the expected score of an evaluation from white's point of view.
+static double Sigmoid(const double K, const double eval){
+	return 1.0 / (1.0 + pow(10.0, -K * eval / 400.0));
+}
+
+/// Returns the evaluation of a position from white's point of view by its trace, the sum of the weights by their coefficients.
+static double TraceEval(const float *trace){
+
+	const S_SCORE *weights = (const S_SCORE *) &EvalWeights;
+	double eval = 0;
+	u16 weight;
+
+	for(weight = 0; weight < EVAL_WEIGHTS_NUM; weight++){
+		eval += trace[2 * weight] * SCORE_MG(weights[weight]) + trace[2 * weight + 1] * SCORE_EG(weights[weight]);
+	}
+	return eval;
+}
+
+/**
+ * Evaluates a range of the positions, either to keep the evaluations (TUNE_PASS_EVAL) or to
+ * add the loss and the gradient of the range to the job (TUNE_PASS_GRADIENT).
+ *
+ * @param data The job of the thread.
+ */
+static void *TuneWorker(void *data){
+
+	S_TUNEJOB *job = (S_TUNEJOB *) data;
+	S_BOARD *pos = (S_BOARD *) calloc(1, sizeof(S_BOARD));
+	float *trace = (float *) malloc(EVAL_TRACE_SIZE * sizeof(float));
+	double expected, error, coef, traced;
+	s16 eval;
+	u32 index;
+	u16 weight;
+
+	job->loss = 0;
+	job->mismatches = 0;
+	if(pos == NULL || trace == NULL){
+		free(pos);
+		free(trace);
+		return NULL;
+	}
+
+	// The board has no evaluation tables, the evaluation doesn't use them while tracing
+	SetEvalTrace(trace);
+
+	for(index = job->start; index < job->end; index++){
+		ParseFen(TuneFens + TuneOffsets[index], pos);
+		memset(trace, 0, EVAL_TRACE_SIZE * sizeof(float));
+
+		eval = EvalPosition(pos);
+		if(pos->side == BLACK) eval = -eval;
+
+		if(job->pass == TUNE_PASS_EVAL){
+			TuneEvals[index] = eval;
+			// The gradient is only right if the trace sums to the evaluation, the special endings have no trace
+			traced = TraceEval(trace);
+			if(traced != 0 && fabs(traced - eval) > TUNE_TRACE_TOLERANCE) job->mismatches++;
+			continue;
+		}
+
+		// d(error^2)/d(weight) = -2 * error * sigmoid' * coefficient of the weight
+		expected = Sigmoid(job->K, eval);
+		error = TuneResults[index] - expected;
+		job->loss += error * error;
+		coef = -2.0 * error * expected * (1.0 - expected) * log(10.0) * job->K / 400.0;
+
+		for(weight = 0; weight < EVAL_TRACE_SIZE; weight++){
+			if(trace[weight] != 0) job->gradient[weight] += coef * trace[weight];
+		}
+	}
+
+	SetEvalTrace(NULL);
+	free(pos);
+	free(trace);
+	return NULL;
+}
+
+/**
+ * Runs a pass over all positions with the given threads.
+ *
+ * @param threads The number of threads.
+ * @param pass TUNE_PASS_EVAL or TUNE_PASS_GRADIENT.
+ * @param K The scaling constant of the sigmoid.
+ * @param gradient The gradient of all positions (TUNE_PASS_GRADIENT).
+ * @return The mean squared error of all positions (TUNE_PASS_GRADIENT).
+ */
+static double TuneRunPass(const u8 threads, const u8 pass, const double K, double *gradient){
+
+	S_TUNEJOB jobs[threads];
+	pthread_t tid[threads];
+	u8 i, started = 0;
+	u32 step = TuneCount / threads, mismatches = 0;
+	double loss = 0;
+	u16 weight;
+
+	for(i = 0; i < threads; i++){
+		jobs[i].start = i * step;
+		jobs[i].end = (i == threads - 1) ? TuneCount : (i + 1) * step;
+		jobs[i].pass = pass;
+		jobs[i].K = K;
+		jobs[i].gradient = (pass == TUNE_PASS_GRADIENT) ? (double *) calloc(EVAL_TRACE_SIZE, sizeof(double)) : NULL;
+		if(pass == TUNE_PASS_GRADIENT && jobs[i].gradient == NULL) jobs[i].end = jobs[i].start;
+	}
+
+	for(i = 1; i < threads; i++){
+		if(pthread_create(&tid[i], NULL, TuneWorker, &jobs[i]) != 0) break;
+		started++;
+	}
+	TuneWorker(&jobs[0]);
+	for(i = 1; i <= started; i++) pthread_join(tid[i], NULL);
+
+	// The jobs of the threads that couldn't be created run on this thread
+	for(i = started + 1; i < threads; i++) TuneWorker(&jobs[i]);
+
+	if(pass == TUNE_PASS_EVAL){
+		for(i = 0; i < threads; i++) mismatches += jobs[i].mismatches;
+		if(mismatches){
+			SetColor(LIGHT_RED);
+			printf("INFO: The Evaluation Trace Doesn't Match The Evaluation Of %d Positions, The Gradient Is Wrong!!!\n", mismatches);
+			SetColor(LIGHT_GRAY);
+		}
+	}else{
+		memset(gradient, 0, EVAL_TRACE_SIZE * sizeof(double));
+		for(i = 0; i < threads; i++){
+			loss += jobs[i].loss;
+			if(jobs[i].gradient == NULL) continue;
+			for(weight = 0; weight < EVAL_TRACE_SIZE; weight++) gradient[weight] += jobs[i].gradient[weight] / TuneCount;
+			free(jobs[i].gradient);
+		}
+	}
+
+	return loss / TuneCount;
+}
+
+/**
+ * Finds the scaling constant K of the sigmoid that fits the current evaluations to the results
+ * best, by refining the step of K around the best value found so far.
+ *
+ * @return The constant K.
+ */
+static double FitScalingConstant(){
+
+	double K = 1.0, best = K, step, loss, bestLoss = HUGE_VAL;
+	u32 index;
+	s8 i;
+
+	for(step = 0.5; step >= 0.001; step /= 10){
+		for(i = -9; i <= 9; i++){
+			if((K = best + i * step) <= 0) continue;
+
+			loss = 0;
+			for(index = 0; index < TuneCount; index++){
+				double error = TuneResults[index] - Sigmoid(K, TuneEvals[index]);
+				loss += error * error;
+			}
+			if(loss < bestLoss){
+				bestLoss = loss;
+				best = K;
+			}
+		}
+	}
+
+	return best;
+}
+
+/**
+ * Tunes the evaluation weights by the labelled positions of a file and saves the weights to
+ * the output file after every epoch.
+ *
+ * @param fileName The file of the labelled positions, a FEN and a result on every line.
+ * @param threads The number of threads.
+ * @param epochs The number of passes over all positions.
+ * @param output The file of the tuned weights.
+ * @return The number of epochs done, -1 if the positions can't be read.
+ */
+s32 TuneEvaluation(const char *fileName, const u8 threads, const u32 epochs, const char *output){
+
+	S_BOARD *pos = (S_BOARD *) calloc(1, sizeof(S_BOARD));
+	S_SCORE *weights = (S_SCORE *) &EvalWeights;
+	double *params = (double *) malloc(EVAL_TRACE_SIZE * sizeof(double));
+	double *gradient = (double *) malloc(EVAL_TRACE_SIZE * sizeof(double));
+	double *moment1 = (double *) calloc(EVAL_TRACE_SIZE, sizeof(double));
+	double *moment2 = (double *) calloc(EVAL_TRACE_SIZE, sizeof(double));
+	double K, loss, m, v;
+	s32 start, epoch = -1, time;
+	u16 weight;
+
+	if(pos == NULL || params == NULL || gradient == NULL || moment1 == NULL || moment2 == NULL || LoadPositions(fileName, pos) == 0){
+		SetColor(LIGHT_RED);
+		printf("INFO: Tuning Positions Can't Be Read From %s!!!\n", fileName);
+		SetColor(LIGHT_GRAY);
+	}else if((TuneEvals = (s16 *) malloc(TuneCount * sizeof(s16))) != NULL){
+
+		start = GetTimeMs();
+		TuneRunPass(threads, TUNE_PASS_EVAL, 0, NULL);
+		K = FitScalingConstant();
+
+		SetColor(LIGHT_RED);
+		printf("INFO: Tuning %d Values Of %d Weights By %d Positions With %d Threads, K = %.3f (%d ms).\n", (s32) EVAL_TRACE_SIZE, (s32) EVAL_WEIGHTS_NUM, TuneCount, threads, K, GetTimeMs() - start);
+		SetColor(LIGHT_GRAY);
+
+		// The middle game and ending values of the weights are updated in double precision
+		// and rounded into EvalWeights for the evaluation
+		for(weight = 0; weight < EVAL_WEIGHTS_NUM; weight++){
+			params[2 * weight] = SCORE_MG(weights[weight]);
+			params[2 * weight + 1] = SCORE_EG(weights[weight]);
+		}
+
+		for(epoch = 0; epoch < (s32) epochs; epoch++){
+			start = GetTimeMs();
+			loss = TuneRunPass(threads, TUNE_PASS_GRADIENT, K, gradient);
+
+			for(weight = 0; weight < EVAL_TRACE_SIZE; weight++){
+				moment1[weight] = TUNE_BETA1 * moment1[weight] + (1 - TUNE_BETA1) * gradient[weight];
+				moment2[weight] = TUNE_BETA2 * moment2[weight] + (1 - TUNE_BETA2) * gradient[weight] * gradient[weight];
+				m = moment1[weight] / (1 - pow(TUNE_BETA1, epoch + 1));
+				v = moment2[weight] / (1 - pow(TUNE_BETA2, epoch + 1));
+				params[weight] -= TUNE_LEARNING_RATE * m / (sqrt(v) + 1e-8);
+			}
+			for(weight = 0; weight < EVAL_WEIGHTS_NUM; weight++){
+				weights[weight] = SCORE(lround(params[2 * weight]), lround(params[2 * weight + 1]));
+			}
+
+			time = GetTimeMs() - start;
+			printf("epoch %d loss %.7f time %d ms positions/s %.0f\n", epoch + 1, loss, time, TuneCount * 1000.0 / (time > 0 ? time : 1));
+
+			if(!SaveEvalWeights(output)){
+				SetColor(LIGHT_RED);
+				printf("INFO: Evaluation Weights Can't Be Saved To %s!!!\n", output);
+				SetColor(LIGHT_GRAY);
+			}
+		}
+	}
+
+	free(pos);
+	free(params);
+	free(gradient);
+	free(moment1);
+	free(moment2);
+	free(TuneFens);
+	free(TuneOffsets);
+	free(TuneResults);
+	free(TuneEvals);
+	TuneFens = NULL;
+	TuneOffsets = NULL;
+	TuneResults = NULL;
+	TuneEvals = NULL;
+
+	return epoch;
+}
@@ -9,6 +9,134 @@
 #include"defs.h"
 #include"string.h"
 
+/// This is a struct that describes one of the engine options that can be set at runtime.
+typedef struct{
+	const char *name;					///< The name of the option as used by setoption.
+	u8 *value;							///< The pointer of the option in EngineOptions.
+	u8 check;							///< TRUE if it's a check (on/off) option, FALSE if it's a spin option.
+	u8 min;								///< The minimum value of a spin option.
+	u8 max;								///< The maximum value of a spin option.
+}S_OPTIONENTRY;
+
+static const S_OPTIONENTRY OptionTable[] = {
+	{"OwnBook",				&EngineOptions->UseBook,		TRUE,	0, 1},
+	{"MultiPV",				&EngineOptions->MultiPV,		FALSE,	1, MAXMULTIPV},
+	{"UseTables",			&EngineOptions->UseTables,		TRUE,	0, 1},
+	{"UseNullMove",			&EngineOptions->UseNullMove,	TRUE,	0, 1},
+	{"UseKillers",			&EngineOptions->UseKillers,		TRUE,	0, 1},
+	{"UseHistory",			&EngineOptions->UseHistory,		TRUE,	0, 1},
+	{"UseEvalMove",			&EngineOptions->UseEvalMove,	TRUE,	0, 1},
+	{"UseSEE",				&EngineOptions->UseSEE,			TRUE,	0, 1},
+	{"NullMoveR",			&EngineOptions->NullMoveR,		FALSE,	1, 6},
+	{"LMRMoves",			&EngineOptions->LmrMoves,		FALSE,	1, 64},
+	{"LMRDepth",			&EngineOptions->LmrDepth,		FALSE,	1, MAXDEPTH},
+	{"LMRReduction",		&EngineOptions->LmrReduction,	FALSE,	0, 4},
+	{"UseLMRTable",			&EngineOptions->UseLmrTable,	TRUE,	0, 1},
+	{"PawnExtension",		&EngineOptions->PawnExtension,	TRUE,	0, 1},
+	{"ThreatExtension",		&EngineOptions->ThreatExtension,TRUE,	0, 1},
+	{"UseRFP",				&EngineOptions->UseRFP,			TRUE,	0, 1},
+	{"UseFutility",			&EngineOptions->UseFutility,	TRUE,	0, 1},
+	{"UseRazoring",			&EngineOptions->UseRazoring,	TRUE,	0, 1},
+	{"UseLMP",				&EngineOptions->UseLMP,			TRUE,	0, 1},
+	{"UseIID",				&EngineOptions->UseIID,			TRUE,	0, 1},
+	{"UseIIR",				&EngineOptions->UseIIR,			TRUE,	0, 1},
+	{"UseSingular",			&EngineOptions->UseSingular,	TRUE,	0, 1},
+	{"UseCounterMove",		&EngineOptions->UseCounterMove,	TRUE,	0, 1},
+	{"UseContHistory",		&EngineOptions->UseContHistory,	TRUE,	0, 1},
+	{"UseCaptureHistory",	&EngineOptions->UseCaptureHistory,TRUE,	0, 1},
+	{NULL,					NULL,							FALSE,	0, 0}
+};
+
+/**
+ * Set an engine option by its name.
+ * 
+ * Check options take "true/false" (or "on/off", "1/0") and spin options take a number in their range.
+ * 
+ * @param name The name of the option (case insensitive).
+ * @param value The new value of the option as a string.
+ * @return TRUE if the option exists and the value is valid, FALSE if not.
+ */
+u8 SetEngineOption(const char *name, const char *value){
+	
+	const S_OPTIONENTRY *option;
+	s32 number;
+	
+	for(option = OptionTable; option->name != NULL; option++){
+		if(strcasecmp(option->name, name)) continue;
+		
+		if(option->check){
+			if(!strcasecmp(value, "true") || !strcasecmp(value, "on") || !strcmp(value, "1")) number = TRUE;
+			else if(!strcasecmp(value, "false") || !strcasecmp(value, "off") || !strcmp(value, "0")) number = FALSE;
+			else return FALSE;
+		}else{
+			if(sscanf(value, "%d", &number) != 1 || number < option->min || number > option->max) return FALSE;
+		}
+		
+		*option->value = number;
+		return TRUE;
+	}
+	
+	return FALSE;
+}
+
+/**
+ * Print all engine options with their current values.
+ * 
+ * @param mode UCI_MODE to print the UCI option lines, else a list for the console.
+ */
+void PrintEngineOptions(const u8 mode){
+	
+	const S_OPTIONENTRY *option;
+	
+	if(mode == UCI_MODE) printf("option name EvalFile type string default %s\n", WEIGHTS_FILE);
+	else printf(" %-14s %s\n", "EvalFile", WEIGHTS_FILE);
+	
+	for(option = OptionTable; option->name != NULL; option++){
+		if(mode == UCI_MODE){
+			if(option->check) printf("option name %s type check default %s\n", option->name, *option->value ? "true" : "false");
+			else printf("option name %s type spin default %d min %d max %d\n", option->name, *option->value, option->min, option->max);
+		}else{
+			if(option->check) printf(" %-14s %s\n", option->name, *option->value ? "true" : "false");
+			else printf(" %-14s %d (%d:%d)\n", option->name, *option->value, option->min, option->max);
+		}
+	}
+}
+
+/**
+ * This function parses the given 'setoption' command (i.e. setoption name <id> value <x>).
+ * 
+ * The option EvalFile loads the evaluation weights from a file, the tables are cleared
+ * since their evaluations are of the old weights.
+ * 
+ * @param line A pinter to array of character.
+ * @param pos The position's pointer.
+ */
+static void ParseSetOption(char *line, S_BOARD *pos){
+	
+	char name[64], value[64];
+	char *ptrName = strstr(line, "name ");
+	char *ptrValue = strstr(line, " value ");
+	
+	if(ptrName == NULL || ptrValue == NULL || ptrValue < ptrName) return;
+	
+	if(sscanf(ptrName + 5, "%63s", name) != 1 || sscanf(ptrValue + 7, "%63s", value) != 1) return;
+	
+	if(!strcasecmp(name, "EvalFile")){
+		// The path may have spaces, it is the rest of the line
+		ptrValue += 7;
+		ptrValue[strcspn(ptrValue, "\r\n")] = '\0';
+		if(LoadEvalWeights(ptrValue)){
+			ClearHashTable(pos->HashTable);
+			ClearEvalTable(pos->EvalTable);
+		}else{
+			printf("info string evaluation weights can't be loaded from %s\n", ptrValue);
+		}
+		return;
+	}
+	
+	if(!SetEngineOption(name, value)) printf("info string unknown option or value: %s %s\n", name, value);
+}
+
 
 /**
  * This function receives a locatoin on th board in algebric form (ex. e2, a1, etc.)
@@ -61,6 +189,12 @@ static void PrintMovesForLocation(char *line, S_BOARD *pos){
  *	   search exactly x mseconds
  * - infinite
  *	   search until the "stop" command. Do not exit the search without being told so in this mode!
+ * - nodes 
+ *	   search x nodes only.
+ * - mate 
+ *	   search for a mate in x moves.
+ * - searchmoves 
+ *	   restrict search to the given moves only, they must be the last parameters of the command.
  * 
  * @param line A pinter to array of character.
  * @param info The pointer of engine inforamtion structure.
@@ -86,6 +220,27 @@ static void ParseGo(char *line, S_SEARCHINFO *info, S_BOARD *pos){
 	if((ptr = strstr(line, "movetime"))) movetime = atoi(ptr + 9);
 	if((ptr = strstr(line, "movestogo"))) movestogo = atoi(ptr + 10);
 	
+	info->nodeLimit = 0;
+	info->mate = 0;
+	info->searchMovesCount = 0;
+	
+	if((ptr = strstr(line, "nodes "))) info->nodeLimit = strtoull(ptr + 6, NULL, 10);
+	if((ptr = strstr(line, "mate "))) info->mate = atoi(ptr + 5);
+	
+	if((ptr = strstr(line, "searchmoves "))){
+		ptr += 12;
+		while(*ptr && info->searchMovesCount < MAXPOSITIONMOVES - 1){
+			
+			s32 move = ParseMove(ptr, pos);
+			if(move == NOMOVE) break;
+			
+			info->searchMoves[info->searchMovesCount++] = move;
+			
+			while(*ptr && *ptr != ' ') ptr++;
+			while(*ptr == ' ') ptr++;
+		}
+	}
+	
 	if(movetime != -1){
 		time = movetime;
 		movestogo = 1;
@@ -172,6 +327,7 @@ void UCI_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 	
 	printf("id name %s\n", NAME);
 	printf("id author T.Elmenshawy\n");
+	PrintEngineOptions(UCI_MODE);
 	printf("uciok\n");
 	
 	char line[INPUTBUFFER];
@@ -209,11 +365,19 @@ void UCI_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 			ParsePosition(line, pos);
 		}else if(!strncmp(line, "ucinewgame", 10)){
 			ParsePosition("postion startpos\n", pos);
+			ClearHistory(pos);
 		}else if(!strncmp(line, "go", 2)){
 			ParseGo(line,info, pos);
+		}else if(!strncmp(line, "setoption", 9)){
+			ParseSetOption(line, pos);
+		}else if(!strncmp(line, "bench", 5)){
+			s32 depth = 0;
+			sscanf(line, "bench %d", &depth);
+			DebugBench(pos, depth > 0 && depth <= MAXDEPTH ? depth : 0, strstr(line, "compare") != NULL);
 		}else if(!strncmp(line, "uci", 3)){
 			printf("id name %s\n", NAME);
 			printf("id author T.Elmenshawy\n");
+			PrintEngineOptions(UCI_MODE);
 			printf("uciok\n");
 		}else if(!strncmp(line, "generate", 8)){
 			PrintMovesForLocation(line, pos);
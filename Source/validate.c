@@ -9,6 +9,7 @@
 #include"defs.h"
 #include"string.h"
 #include"ctype.h"
+#include"pthread.h"
 
 u8 print = FALSE;		 ///< A flag used in evalution debugging
 
@@ -47,14 +48,14 @@ u8 CapturesListOk(const S_MOVELIST *list, const S_BOARD *pos){
 			return FALSE;
 		}
 		
-		if(CAPTURED(list->moves[moveNum].move) != EMPTY){
-			if(!PieceValid(CAPTURED(list->moves[moveNum].move))){
+		if(CAPTURED(pos, list->moves[moveNum].move) != EMPTY){
+			if(!PieceValid(CAPTURED(pos, list->moves[moveNum].move))){
 				PrintBoard(pos);
 				return FALSE;
 			}
 		}else{
-			if(list->moves[moveNum].move & MFLAGEP) return TRUE;
-			printf("CapturesListOk(): no ccaptures(%d) failed ",CAPTURED(list->moves[moveNum].move));
+			if(IsEP(list->moves[moveNum].move)) return TRUE;
+			printf("CapturesListOk(): no ccaptures(%d) failed ",CAPTURED(pos, list->moves[moveNum].move));
 			return FALSE;
 		}
 		
@@ -98,8 +99,8 @@ u8 MoveListOk(const S_MOVELIST *list, const S_BOARD *pos){
 			return FALSE;
 		}
 		
-		if(CAPTURED(list->moves[moveNum].move) != EMPTY){
-			if(!PieceValid(CAPTURED(list->moves[moveNum].move))){
+		if(CAPTURED(pos, list->moves[moveNum].move) != EMPTY){
+			if(!PieceValid(CAPTURED(pos, list->moves[moveNum].move))){
 				PrintBoard(pos);
 				return FALSE;
 			}
@@ -138,8 +139,8 @@ u8 MoveValid(const s32 move, const S_BOARD *pos){
 		return FALSE;
 	}
 	
-	if(CAPTURED(move) != EMPTY){
-		if(!PieceValid(CAPTURED(move))){
+	if(CAPTURED(pos, move) != EMPTY){
+		if(!PieceValid(CAPTURED(pos, move))){
 			PrintBoard(pos);
 			return FALSE;
 		}
@@ -228,71 +229,6 @@ u8 PieceValid(const u8 p){
 	}else return 1;
 }
 
-/**
- * This function is used to make a performance test for the chess engine thinking
- * using test suites.
- * 
- * @param pos The position's pointer.
- * @param info The pointer of engine inforamtion structure.
- */
-void DebugAnalysisTest(S_BOARD *pos, S_SEARCHINFO *info){
-
-	FILE *file;
-    file = fopen("arasan20.epd","r");
-    char lineIn [1024];
-
-	info->depth = MAXDEPTH;
-	info->timeset = TRUE;
-	s32 time = 60000 * 30;
-	s16 errors[1000] = {0};
-	s16 index = 0;
-	//096 is ok
-	s16 er_pet[152] = {
-		9, 12, 15, 17, 18, 19, 21, 29, 32, 34, 42, 44, 45, 47, 48
-	};
-	s32 counter = 0, errorIndex = 0;
-
-    if(file == NULL){
-        printf("File Not Found\n");
-        return;
-    }else{
-        while(fgets (lineIn , 1024 , file) != NULL){
-			info->starttime = GetTimeMs();
-			info->stoptime = info->starttime + time;
-			ClearHashTable(pos->HashTable);
-			counter++;
-			//if(re[index] != counter) continue;
-			index++;
-            ParseFen(lineIn, pos);
-			char *ptr = strstr(lineIn, "bm");
-			u8 am = 0;
-			if(ptr == NULL){
-				ptr = strstr(lineIn, "am");
-				am = 1;
-			}
-			ptr += 3;
-			while(!(ptr[0] >= 'a' && ptr[0] <= 'h' && ptr[1] >= '1' && ptr[1] <= '8')) ptr ++;
-            printf("\n%s\n",lineIn);
-			printf("time:%d start:%d stop:%d depth:%d timeset:%d moveto:%c%c\n",
-				time,info->starttime,info->stoptime,info->depth,info->timeset, ptr[0], ptr[1]);
-			s32 move = SearchDebug(pos, info, ptr, am);
-
-			char *res = PrSq(TOSQ(move));
-			if(!(ptr[0] == res[0] && ptr[1] == res[1])) errors[errorIndex++] = counter;
-			SetColor(LIGHT_GREEN);
-			printf("\nTotal:%d error:%d\n", index, errorIndex);
-			SetColor(LIGHT_GRAY);
-            memset(&lineIn[0], 0, sizeof(lineIn));
-        }
-		
-		printf("positions didn't match [%d]:\n", errorIndex);
-		for(s32 i = 0; i < errorIndex; i++){
-			if(i % 20 == 0) printf("\n");
-			printf("%d, ", errors[i]);
-		}
-    }
-}
-
 /**
  * This function is used to check the performace of EvalPosition()  
  * by comparing the evaluation value of a specific board position to 
@@ -410,73 +346,850 @@ void CheckFen(S_BOARD *pos){
     }
 }
 
-static u64 myAtoi(char* str){
-    // Initialize result
-    u64 res = 0;
- 
-    // Iterate through all characters
-    // of input string and update result
-    // take ASCII character of corosponding digit and
-    // subtract the code from '0' to get numerical
-    // value and multiply res by 10 to shuffle
-    // digits left to update running total
-    for (u8 i = 0; str[i] != '\0'; ++i){
-		if(str[i] == ' ' || str[i] == ';' || str[i] == '\n') break;
-        res = (res * 10) + (str[i] - '0');
-	}
- 
-    // return result.
-    return res;
+static s32 suiteJobsCount = 0;				///< Number of positions in the running test suite.
+static s32 suiteNextJob = 0;				///< Index of the next position to be taken by a worker.
+static pthread_mutex_t suiteLock = PTHREAD_MUTEX_INITIALIZER;
+
+static S_PERFTJOB *perftJobs = NULL;		///< Positions of the running perft suite.
+static u8 perftMaxDepth = 0;				///< Deepest depth to be checked in the running perft suite.
+
+static S_EPDJOB *epdJobs = NULL;			///< Positions of the running EPD suite.
+static s32 epdTime = 0;						///< Search time of each position of the running EPD suite in milliseconds.
+static u8 epdProgress = FALSE;				///< A flag to print the progress of the running EPD suite on console.
+
+/**
+ * Take the next position of the running test suite, shared between all the workers.
+ *
+ * @return The index of the position, -1 if no positions are left.
+ */
+static s32 NextSuiteJob(){
+	
+	s32 index;
+	pthread_mutex_lock(&suiteLock);
+	index = suiteNextJob < suiteJobsCount ? suiteNextJob++ : -1;
+	pthread_mutex_unlock(&suiteLock);
+	
+	return index;
 }
 
 /**
- * This function is used to check the performace of PerftTest().
+ * Start the workers of a test suite and wait until all of them are done, if no thread
+ * can be created the worker runs on the calling thread.
  *
- * This process is performed on test suites.
+ * @param workers The number of worker threads.
+ * @param worker The worker function.
+ * @param args The argument of each worker, NULL to pass NULL to all of them.
+ */
+static void RunSuiteWorkers(const u8 workers, void *(*worker)(void *), void **args){
+	
+	pthread_t *tid = (pthread_t *) malloc(workers * sizeof(pthread_t));
+	u8 i, started = 0;
+	
+	for(i = 0; tid != NULL && i < workers; i++){
+		if(pthread_create(&tid[i], NULL, worker, args ? args[i] : NULL) == 0) started++;
+		else break;
+	}
+	if(started == 0) worker(args ? args[0] : NULL);
+	for(i = 0; i < started; i++) pthread_join(tid[i], NULL);
+	
+	free(tid);
+}
+
+/**
+ * Open the report file of a test suite.
+ *
+ * @param reportName The path of the report file, NULL to print the report on console.
+ * @return The report stream, stdout if no file is given or it can't be opened.
+ */
+static FILE *OpenReport(const char *reportName){
+	
+	FILE *report = stdout;
+	if(reportName != NULL && (report = fopen(reportName, "w")) == NULL){
+		SetColor(LIGHT_RED);
+		printf("ERROR: Can't write the report to %s\n", reportName);
+		SetColor(LIGHT_GRAY);
+		report = stdout;
+	}
+	
+	return report;
+}
+
+/**
+ * Parse one line of a perft test suite in the form "<FEN> ;D1 20 ;D2 400 ;...".
+ *
+ * @param lineIn The line read from the suite.
+ * @param job The pointer of the job to be filled.
+ * @return TRUE if the line has a position and at least one depth entry, FALSE if not.
+ */
+static u8 ParsePerftLine(const char *lineIn, S_PERFTJOB *job){
+	
+	memset(job, 0, sizeof(S_PERFTJOB));
+	
+	const char *ptr = strchr(lineIn, ';');
+	if(ptr == NULL) return FALSE;
+	
+	// The FEN is everything before the first ';' without the trailing spaces
+	u32 length = ptr - lineIn;
+	if(length >= sizeof(job->fen)) length = sizeof(job->fen) - 1;
+	memcpy(job->fen, lineIn, length);
+	while(length > 0 && isspace((u8)job->fen[length - 1])) job->fen[--length] = '\0';
+	if(length == 0) return FALSE;
+	
+	u8 found = FALSE;
+	u32 depth;
+	unsigned long long nodes;
+	while(ptr != NULL){
+		if(sscanf(ptr, "; D%u %llu", &depth, &nodes) == 2 && depth >= 1 && depth <= MAXPERFTDEPTH){
+			job->expected[depth] = nodes;
+			found = TRUE;
+		}
+		ptr = strchr(ptr + 1, ';');
+	}
+	
+	return found;
+}
+
+/**
+ * A worker thread of DebugPerftTest(). It keeps taking positions from the suite and checks
+ * them on its own board until no positions are left.
+ *
+ * @param arg Not used.
+ * @return NULL
+ */
+static void *PerftSuiteWorker(void *arg){
+	
+	S_BOARD *pos = (S_BOARD *) calloc(1, sizeof(S_BOARD));
+	if(pos == NULL) return NULL;
+	
+	s32 index;
+	u8 depth;
+	
+	while((index = NextSuiteJob()) != -1){
+		
+		S_PERFTJOB *job = &perftJobs[index];
+		s32 start = GetTimeMs();
+		
+		if(!ParseFen(job->fen, pos)){
+			job->failDepth = 1;
+			continue;
+		}
+		
+		for(depth = 1; depth <= perftMaxDepth; depth++){
+			if(job->expected[depth] == 0) continue;
+			
+			job->found = Perft(depth, pos);
+			job->nodes += job->found;
+			job->depth = depth;
+			
+			if(job->found != job->expected[depth]){
+				job->failDepth = depth;
+				break;
+			}
+		}
+		
+		job->time = GetTimeMs() - start;
+	}
+	
+	free(pos);
+	return NULL;
+}
+
+/**
+ * This function is used to check the performace of Perft().
+ *
+ * The positions of the test suite are shared between a number of worker threads and every
+ * position is checked for all its depths up to maxDepth, then a report is printed in file order
+ * with pass/fail, node counts, time and NPS of each position.
+ * 
+ * @param fileName The path of the test suite.
+ * @param threads The number of worker threads.
+ * @param maxDepth The deepest depth to be checked.
+ * @param format The report format (REPORT_JSON, REPORT_CSV).
+ * @param reportName The path of the report file, NULL to print the report on console.
+ * @return The number of failed positions, or -1 if the suite can't be read.
+ */
+s32 DebugPerftTest(const char *fileName, const u8 threads, const u8 maxDepth, const u8 format, const char *reportName){
+	
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL){
+		SetColor(LIGHT_RED);
+		printf("File Not Found: %s\n", fileName);
+		SetColor(LIGHT_GRAY);
+		return -1;
+	}
+	
+	char lineIn[2048];
+	s32 capacity = 64;
+	suiteJobsCount = 0;
+	suiteNextJob = 0;
+	perftMaxDepth = (maxDepth == 0 || maxDepth > MAXPERFTDEPTH) ? MAXPERFTDEPTH : maxDepth;
+	perftJobs = (S_PERFTJOB *) malloc(capacity * sizeof(S_PERFTJOB));
+	
+	while(perftJobs != NULL && fgets(lineIn, sizeof(lineIn), file) != NULL){
+		if(suiteJobsCount == capacity){
+			capacity *= 2;
+			S_PERFTJOB *jobs = (S_PERFTJOB *) realloc(perftJobs, capacity * sizeof(S_PERFTJOB));
+			if(jobs == NULL) break;
+			perftJobs = jobs;
+		}
+		if(ParsePerftLine(lineIn, &perftJobs[suiteJobsCount])) suiteJobsCount++;
+	}
+	fclose(file);
+	
+	if(perftJobs == NULL){
+		SetColor(LIGHT_RED);
+		printf("ERROR: Failed to allocate memory for %s\n", fileName);
+		SetColor(LIGHT_GRAY);
+		return -1;
+	}
+	
+	// Run the workers
+	u8 workers = threads == 0 ? 1 : threads;
+	if(workers > suiteJobsCount && suiteJobsCount > 0) workers = suiteJobsCount;
+	s32 start = GetTimeMs();
+	RunSuiteWorkers(workers, PerftSuiteWorker, NULL);
+	s32 time = GetTimeMs() - start;
+	
+	// Print the report
+	FILE *report = OpenReport(reportName);
+	
+	s32 index, failed = 0;
+	u64 totalNodes = 0;
+	
+	if(format == REPORT_JSON) fprintf(report, "{\n\"suite\": \"%s\",\n\"threads\": %d,\n\"maxdepth\": %d,\n\"positions\": [\n", fileName, workers, perftMaxDepth);
+	else fprintf(report, "id,result,depth,nodes,time_ms,nps,fail_depth,expected,found,fen\n");
+	
+	for(index = 0; index < suiteJobsCount; index++){
+		
+		S_PERFTJOB *job = &perftJobs[index];
+		unsigned long long nps = job->time > 0 ? job->nodes * 1000 / job->time : job->nodes * 1000;
+		unsigned long long expected = job->failDepth ? job->expected[job->failDepth] : 0;
+		
+		if(job->failDepth) failed++;
+		totalNodes += job->nodes;
+		
+		if(format == REPORT_JSON){
+			fprintf(report, "{\"id\": %d, \"result\": \"%s\", \"depth\": %d, \"nodes\": %llu, \"time_ms\": %d, \"nps\": %llu",
+				index + 1, job->failDepth ? "fail" : "pass", job->depth, (unsigned long long)job->nodes, job->time, nps);
+			if(job->failDepth) fprintf(report, ", \"fail_depth\": %d, \"expected\": %llu, \"found\": %llu", job->failDepth, expected, (unsigned long long)job->found);
+			fprintf(report, ", \"fen\": \"%s\"}%s\n", job->fen, index + 1 < suiteJobsCount ? "," : "");
+		}else{
+			fprintf(report, "%d,%s,%d,%llu,%d,%llu,%d,%llu,%llu,%s\n", index + 1, job->failDepth ? "fail" : "pass", job->depth,
+				(unsigned long long)job->nodes, job->time, nps, job->failDepth, expected,
+				job->failDepth ? (unsigned long long)job->found : 0ULL, job->fen);
+		}
+	}
+	
+	unsigned long long nps = time > 0 ? totalNodes * 1000 / time : totalNodes * 1000;
+	if(format == REPORT_JSON){
+		fprintf(report, "],\n\"passed\": %d,\n\"failed\": %d,\n\"nodes\": %llu,\n\"time_ms\": %d,\n\"nps\": %llu\n}\n",
+			suiteJobsCount - failed, failed, (unsigned long long)totalNodes, time, nps);
+	}
+	
+	if(report != stdout){
+		fclose(report);
+		SetColor(failed ? LIGHT_RED : LIGHT_GREEN);
+		printf("INFO: %d Positions Passed, %d Failed, %llu Nodes In %d ms.\n", suiteJobsCount - failed, failed, (unsigned long long)totalNodes, time);
+		SetColor(LIGHT_GRAY);
+	}
+	free(perftJobs);
+	perftJobs = NULL;
+	
+	return failed;
+}
+
+/**
+ * Find an operation of an EPD line (e.g. bm, am, id) and return a pointer to its operand.
+ *
+ * @param lineIn The line read from the suite.
+ * @param opcode The name of the operation.
+ * @return A pointer to the first character of the operand, NULL if not found.
+ */
+static const char *FindEPDOperation(const char *lineIn, const char *opcode){
+	
+	u8 length = strlen(opcode);
+	const char *ptr = lineIn;
+	
+	while((ptr = strstr(ptr, opcode)) != NULL){
+		// The opcode must be a whole word that starts an operation
+		if(ptr > lineIn && (ptr[-1] == ' ' || ptr[-1] == ';') && ptr[length] == ' ') return ptr + length + 1;
+		ptr += length;
+	}
+	
+	return NULL;
+}
+
+/**
+ * Read the position of an EPD line, it is the first four fields of the line.
+ *
+ * @param lineIn The line read from the suite.
+ * @param fen The buffer that receives the position.
+ * @param size The size of the buffer.
+ * @param pos The board that the position is set on.
+ * @return A pointer to the operations after the position, NULL if the position is not valid.
+ */
+static const char *ReadEPDPosition(const char *lineIn, char *fen, const u16 size, S_BOARD *pos){
+	
+	u8 fields = 0;
+	u16 length = 0;
+	const char *ptr = lineIn;
+	
+	while(isspace((u8)*ptr)) ptr++;
+	for(; *ptr != '\0' && length < size - 1; ptr++){
+		if(isspace((u8)*ptr)){
+			if(++fields == 4) break;
+			while(isspace((u8)ptr[1])) ptr++;
+			fen[length++] = ' ';
+		}else fen[length++] = *ptr;
+	}
+	fen[length] = '\0';
+	
+	if(fields < 4 || !ParseFen(fen, pos)) return NULL;
+	return ptr;
+}
+
+/**
+ * Parse one line of an EPD test suite in the form "<4 FEN fields> bm <moves>; id "<id>";".
+ *
+ * @param lineIn The line read from the suite.
+ * @param job The pointer of the job to be filled.
+ * @param pos A board used to read the bm/am moves.
+ * @return TRUE if the line has a valid position and at least one legal bm/am move, FALSE if not.
+ */
+static u8 ParseEPDLine(const char *lineIn, S_EPDJOB *job, S_BOARD *pos){
+	
+	memset(job, 0, sizeof(S_EPDJOB));
+	
+	u8 length;
+	const char *ptr = ReadEPDPosition(lineIn, job->fen, sizeof(job->fen), pos);
+	if(ptr == NULL) return FALSE;
+	
+	const char *operand = FindEPDOperation(ptr, "bm");
+	if(operand == NULL){
+		operand = FindEPDOperation(ptr, "am");
+		job->am = TRUE;
+	}
+	if(operand == NULL) return FALSE;
+	
+	for(length = 0; operand[length] != '\0' && operand[length] != ';' && operand[length] != '\n' && length < sizeof(job->expected) - 1; length++){
+		job->expected[length] = operand[length] == '"' ? '\'' : operand[length];
+	}
+	
+	// Read every move of the operand
+	const char *end = operand + length;
+	while(operand < end && job->moveCount < MAXEPDMOVES){
+		while(operand < end && (*operand == ' ' || *operand == ',')) operand++;
+		if(operand >= end) break;
+		s32 move = ParseSANMove(operand, pos);
+		if(move != NOMOVE) job->moves[job->moveCount++] = move;
+		while(operand < end && *operand != ' ' && *operand != ',') operand++;
+	}
+	
+	if((operand = FindEPDOperation(ptr, "id")) != NULL){
+		if(*operand == '"') operand++;
+		for(length = 0; operand[length] != '\0' && operand[length] != '"' && operand[length] != ';' && length < sizeof(job->id) - 1; length++){
+			job->id[length] = operand[length];
+		}
+	}
+	
+	return job->moveCount > 0;
+}
+
+/**
+ * A worker thread of DebugAnalysisTest(). It keeps taking positions from the suite and searches
+ * them on its own board (i.e. its own hash tables) until no positions are left.
+ *
+ * @param arg The worker's board.
+ * @return NULL
+ */
+static void *EPDSuiteWorker(void *arg){
+	
+	S_BOARD *pos = (S_BOARD *) arg;
+	S_SEARCHINFO info[1];
+	memset(info, 0, sizeof(S_SEARCHINFO));
+	info->GAME_MODE = CONSOLE_MODE;
+	info->POST_THINKING = FALSE;
+	info->ponder = FALSE;
+	
+	s32 index;
+	
+	while((index = NextSuiteJob()) != -1){
+		
+		S_EPDJOB *job = &epdJobs[index];
+		
+		ClearHashTable(pos->HashTable);
+		ClearHistory(pos);
+		ParseFen(job->fen, pos);
+		
+		info->depth = MAXDEPTH;
+		info->timeset = TRUE;
+		info->starttime = GetTimeMs();
+		info->stoptime = info->starttime + epdTime;
+		
+		SearchDebug(pos, info, job);
+		
+		if(epdProgress){
+			pthread_mutex_lock(&suiteLock);
+			SetColor(job->solveDepth ? LIGHT_GREEN : LIGHT_RED);
+			printf("INFO: %d %s %s best %s depth %d\n", index + 1, job->id, job->solveDepth ? "solved" : "failed", job->bestMove != NOMOVE ? PrMove(job->bestMove) : "none", job->depth);
+			SetColor(LIGHT_GRAY);
+			pthread_mutex_unlock(&suiteLock);
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * This function is used to make a performance test for the chess engine thinking
+ * using test suites.
+ *
+ * The positions of the test suite are shared between a number of worker threads, each of them
+ * has its own board and hash tables, so every position is searched by a separate engine instance.
+ * The bm/am moves are compared as full moves (SAN or coordinate form), then a report is printed
+ * in file order with the solve depth, time-to-solution and nodes of each position.
  * 
+ * @param fileName The path of the test suite.
+ * @param time The search time of each position in milliseconds.
+ * @param workers The number of worker threads.
+ * @param format The report format (REPORT_JSON, REPORT_CSV).
+ * @param reportName The path of the report file, NULL to print the report on console.
+ * @return The number of failed positions, or -1 if the suite can't be read.
+ */
+s32 DebugAnalysisTest(const char *fileName, const s32 time, const u8 workers, const u8 format, const char *reportName){
+	
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL){
+		SetColor(LIGHT_RED);
+		printf("File Not Found: %s\n", fileName);
+		SetColor(LIGHT_GRAY);
+		return -1;
+	}
+	
+	S_BOARD *pos = (S_BOARD *) calloc(1, sizeof(S_BOARD));
+	char lineIn[2048];
+	s32 capacity = 64, lineNum = 0;
+	suiteJobsCount = 0;
+	suiteNextJob = 0;
+	epdTime = time;
+	epdProgress = reportName != NULL;
+	epdJobs = (S_EPDJOB *) malloc(capacity * sizeof(S_EPDJOB));
+	
+	while(pos != NULL && epdJobs != NULL && fgets(lineIn, sizeof(lineIn), file) != NULL){
+		lineNum++;
+		if(suiteJobsCount == capacity){
+			capacity *= 2;
+			S_EPDJOB *jobs = (S_EPDJOB *) realloc(epdJobs, capacity * sizeof(S_EPDJOB));
+			if(jobs == NULL) break;
+			epdJobs = jobs;
+		}
+		if(ParseEPDLine(lineIn, &epdJobs[suiteJobsCount], pos)) suiteJobsCount++;
+		else if(lineIn[0] != '\n' && lineIn[0] != '\r' && lineIn[0] != '\0'){
+			SetColor(LIGHT_RED);
+			printf("INFO: Line %d skipped, no legal bm/am move found.\n", lineNum);
+			SetColor(LIGHT_GRAY);
+		}
+	}
+	fclose(file);
+	free(pos);
+	
+	if(epdJobs == NULL){
+		SetColor(LIGHT_RED);
+		printf("ERROR: Failed to allocate memory for %s\n", fileName);
+		SetColor(LIGHT_GRAY);
+		return -1;
+	}
+	
+	// Every worker is a separate engine instance with its own board and tables
+	u8 i, count = workers == 0 ? 1 : workers;
+	if(count > suiteJobsCount && suiteJobsCount > 0) count = suiteJobsCount;
+	S_BOARD **boards = (S_BOARD **) calloc(count, sizeof(S_BOARD *));
+	for(i = 0; boards != NULL && i < count; i++){
+		if((boards[i] = (S_BOARD *) calloc(1, sizeof(S_BOARD))) == NULL) break;
+		InitHashTable(boards[i]->HashTable, SUITE_HASH_SIZE_MB);
+		InitEvalTable(boards[i]->EvalTable, SUITE_PAWN_SIZE_MB, SUITE_EVAL_SIZE_MB);
+	}
+	count = i;
+	
+	s32 start = GetTimeMs();
+	if(count > 0) RunSuiteWorkers(count, EPDSuiteWorker, (void **) boards);
+	s32 wallTime = GetTimeMs() - start;
+	
+	for(i = 0; i < count; i++){
+		FreeTables(boards[i]->HashTable, boards[i]->EvalTable);
+		free(boards[i]);
+	}
+	free(boards);
+	
+	// Print the report
+	FILE *report = OpenReport(reportName);
+	s32 index, failed = 0;
+	u64 totalNodes = 0;
+	
+	if(format == REPORT_JSON) fprintf(report, "{\n\"suite\": \"%s\",\n\"time_ms\": %d,\n\"workers\": %d,\n\"positions\": [\n", fileName, time, count);
+	else fprintf(report, "id,name,result,expected,best,depth,solve_depth,solve_time_ms,solve_nodes,nodes,time_ms\n");
+	
+	for(index = 0; index < suiteJobsCount; index++){
+		
+		S_EPDJOB *job = &epdJobs[index];
+		if(!job->solveDepth) failed++;
+		totalNodes += job->nodes;
+		
+		if(format == REPORT_JSON){
+			fprintf(report, "{\"id\": %d, \"name\": \"%s\", \"result\": \"%s\", \"%s\": \"%s\", \"best\": \"%s\", \"depth\": %d",
+				index + 1, job->id, job->solveDepth ? "solved" : "failed", job->am ? "am" : "bm", job->expected, job->bestMove != NOMOVE ? PrMove(job->bestMove) : "none", job->depth);
+			if(job->solveDepth) fprintf(report, ", \"solve_depth\": %d, \"solve_time_ms\": %d, \"solve_nodes\": %llu", job->solveDepth, job->solveTime, (unsigned long long)job->solveNodes);
+			fprintf(report, ", \"nodes\": %llu, \"time_ms\": %d}%s\n", (unsigned long long)job->nodes, job->time, index + 1 < suiteJobsCount ? "," : "");
+		}else{
+			fprintf(report, "%d,\"%s\",%s,\"%s %s\",%s,%d,%d,%d,%llu,%llu,%d\n", index + 1, job->id, job->solveDepth ? "solved" : "failed",
+				job->am ? "am" : "bm", job->expected, job->bestMove != NOMOVE ? PrMove(job->bestMove) : "none", job->depth, job->solveDepth,
+				job->solveDepth ? job->solveTime : -1, (unsigned long long)(job->solveDepth ? job->solveNodes : 0), (unsigned long long)job->nodes, job->time);
+		}
+	}
+	
+	if(format == REPORT_JSON){
+		fprintf(report, "],\n\"solved\": %d,\n\"failed\": %d,\n\"nodes\": %llu,\n\"wall_time_ms\": %d\n}\n",
+			suiteJobsCount - failed, failed, (unsigned long long)totalNodes, wallTime);
+	}
+	
+	if(report != stdout){
+		fclose(report);
+		SetColor(LIGHT_GREEN);
+		printf("INFO: %d Positions Solved, %d Failed In %d ms.\n", suiteJobsCount - failed, failed, wallTime);
+		SetColor(LIGHT_GRAY);
+	}
+	
+	free(epdJobs);
+	epdJobs = NULL;
+	
+	return failed;
+}
+
+#define BENCH_DEPTH 7							///< Default depth of the bench positions.
+
+/// Positions used by DebugBench(), a mix of opening, middle game and ending positions.
+static const char *BenchFens[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"r1bq1rk1/pp2bppp/2n1pn2/8/2Pp4/N2P1NP1/PP3PBP/R1BQ1RK1 w - - 0 1",
+	"r1b2rk1/1p1nbppp/pq1p4/3B4/P2NP3/2N1p3/1PP3PP/R2Q1R1K w - - 0 1",
+	"2q1r1k1/1ppb4/r2p1Pp1/p4n1p/2P1n3/5NPP/PP3Q1K/2BRRB2 w - - 0 1",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"8/7p/2k1Pp2/pp1p2p1/3P2P1/4P3/P3K2P/8 w - - 0 1",
+	"6k1/5pp1/p3p2p/3bP3/1P1B4/P5PP/5P2/6K1 w - - 0 1",
+	NULL
+};
+
+/// Configurations compared by DebugBench(), each one changes a single option of the current configuration.
+static const char *BenchConfigs[][2] = {
+	{"UseTables", "false"},
+	{"UseNullMove", "false"},
+	{"UseKillers", "false"},
+	{"UseHistory", "false"},
+	{"UseEvalMove", "false"},
+	{"UseSEE", "false"},
+	{"PawnExtension", "false"},
+	{"ThreatExtension", "false"},
+	{"UseRFP", "false"},
+	{"UseFutility", "false"},
+	{"UseRazoring", "false"},
+	{"UseLMP", "false"},
+	{"UseIID", "false"},
+	{"UseIIR", "false"},
+	{"UseSingular", "false"},
+	{"UseCounterMove", "false"},
+	{"UseContHistory", "false"},
+	{"UseCaptureHistory", "false"},
+	{"NullMoveR", "3"},
+	{"UseLMRTable", "false"},
+	{"LMRMoves", "8"},
+	{NULL, NULL}
+};
+
+/**
+ * Search all bench positions to a fixed depth with the current engine options.
+ *
  * @param pos The position's pointer.
+ * @param depth The depth of search.
+ * @param print A flag to print the result of each position.
+ * @param nodes The pointer of variable to retrieve the total searched nodes.
+ * @param time The pointer of variable to retrieve the total time-to-depth in milliseconds.
  */
-void DebugPerftTest(S_BOARD *pos){
-    FILE *file;
-    file = fopen("perftsuite.epd","r");
-    char lineIn [2048];
-    u64 ev1 = 0, ev2 = 0;
-    s32 positions = 0;
-    if(file == NULL) {
-        printf("File Not Found\n");
-        return;
-    }else{
-        while(fgets (lineIn , 1024 , file) != NULL){
-			positions++;
-			printf("\n\n%d  %s\n", positions,lineIn);
-            ParseFen(lineIn, pos);
-			char *ptr = NULL;
-			char D[3] = {'D', '1', '\0'};
-			for(u8 i = 0; i <= 5; i++){
-				D[1] = '1' + i;
-				if((ptr = strstr(lineIn, D))){
-					ev1 = myAtoi(ptr + 3);
-					if(ev1 < 0){
-						SetColor(LIGHT_RED);
-						printf("ERROR: nodes_suite: %lld\n", ev1);
-						SetColor(LIGHT_GRAY);
-						return;
-					}
-					ev2 = PerftTest(i+1, pos);
-					if(ev1 != ev2){
-						PrintBoard(pos);
-						SetColor(LIGHT_RED);
-						printf("\n nodes_suite: %lld\n nodes_perft: %lld\n", ev1, ev2);
-						printf("\n perfttest Fail:\n%s\n",lineIn);
-						SetColor(LIGHT_GRAY);
-						getchar();
-						return;
-					}
-				}
-			}
+static void RunBench(S_BOARD *pos, const u8 depth, const u8 print, u64 *nodes, s32 *time){
+	
+	S_SEARCHINFO info[1];
+	S_EPDJOB job[1];
+	u8 index;
+	
+	*nodes = 0;
+	*time = 0;
+	
+	for(index = 0; BenchFens[index] != NULL; index++){
+		
+		memset(info, 0, sizeof(S_SEARCHINFO));
+		memset(job, 0, sizeof(S_EPDJOB));
+		info->GAME_MODE = CONSOLE_MODE;
+		info->depth = depth;
+		info->timeset = FALSE;
+		
+		ClearHashTable(pos->HashTable);
+		ClearEvalTable(pos->EvalTable);
+		ClearHistory(pos);
+		ParseFen(BenchFens[index], pos);
+		
+		info->starttime = GetTimeMs();
+		SearchDebug(pos, info, job);
+		
+		*nodes += job->nodes;
+		*time += job->time;
+		
+		if(print) printf("%2d  %-6s %10llu %8d  %s\n", index + 1, job->bestMove != NOMOVE ? PrMove(job->bestMove) : "none", (unsigned long long)job->nodes, job->time, BenchFens[index]);
+	}
+}
 
-            memset(&lineIn[0], 0, sizeof(lineIn));
-        }
-    }
+/**
+ * This function is used to measure the search by searching some fixed positions to a fixed depth,
+ * it reports the node counts and the time-to-depth.
+ *
+ * In compare mode the bench is repeated for the current configuration and then for every configuration
+ * in BenchConfigs, so the worth of each search feature can be measured from a single binary.
+ *
+ * @param pos The position's pointer.
+ * @param depth The depth of search, 0 for the default depth.
+ * @param compare A flag to compare the configurations.
+ */
+void DebugBench(S_BOARD *pos, const u8 depth, const u8 compare){
+	
+	S_BOARD *saved = (S_BOARD *) malloc(sizeof(S_BOARD));
+	if(saved == NULL) return;
+	*saved = *pos;
+	
+	S_OPTIONS options = *EngineOptions;
+	u8 benchDepth = depth ? depth : BENCH_DEPTH;
+	u64 nodes, baseNodes;
+	s32 time, baseTime;
+	u8 index;
+	
+	#ifdef FIXED_OPTIONS
+	if(compare){
+		SetColor(LIGHT_RED);
+		printf("INFO: Options are fixed at compile time (FIXED_OPTIONS), nothing to compare.\n");
+		SetColor(LIGHT_GRAY);
+	}
+	#endif
+	
+	printf("\nBench depth %d:\n", benchDepth);
+	if(!compare) printf(" #  best        nodes  time(ms)  fen\n");
+	RunBench(pos, benchDepth, !compare, &baseNodes, &baseTime);
+	
+	if(!compare){
+		printf("\nTotal: %llu nodes in %d ms, %llu nps\n", (unsigned long long)baseNodes, baseTime,
+			(unsigned long long)(baseTime > 0 ? baseNodes * 1000 / baseTime : 0));
+	}else{
+		printf("%-20s %12s %10s %10s %8s %8s\n", "config", "nodes", "time(ms)", "nps", "nodes%", "time%");
+		printf("%-20s %12llu %10d %10llu %8d %8d\n", "current", (unsigned long long)baseNodes, baseTime,
+			(unsigned long long)(baseTime > 0 ? baseNodes * 1000 / baseTime : 0), 100, 100);
+		
+		#ifndef FIXED_OPTIONS
+		char config[40];
+		for(index = 0; BenchConfigs[index][0] != NULL; index++){
+			
+			*EngineOptions = options;
+			SetEngineOption(BenchConfigs[index][0], BenchConfigs[index][1]);
+			RunBench(pos, benchDepth, FALSE, &nodes, &time);
+			
+			snprintf(config, sizeof(config), "%s=%s", BenchConfigs[index][0], BenchConfigs[index][1]);
+			printf("%-20s %12llu %10d %10llu %8d %8d\n", config, (unsigned long long)nodes, time,
+				(unsigned long long)(time > 0 ? nodes * 1000 / time : 0),
+				(s32)(baseNodes ? nodes * 100 / baseNodes : 0), baseTime ? time * 100 / baseTime : 0);
+		}
+		#endif
+	}
+	
+	*EngineOptions = options;
+	ClearHashTable(pos->HashTable);
+	*pos = *saved;
+	free(saved);
+}
+
+/**
+ * Check the evaluation of the registered endings on the positions of an EPD file in the form
+ * "<4 FEN fields> c0 "win"|"draw"; id "<id>";". The evaluation must be a clear win for the side
+ * with more material or close to a draw, the ending must have its own evaluation or scale factor,
+ * and the mirrored position must have the same evaluation.
+ *
+ * @param pos The position's pointer.
+ * @param fileName The name of the EPD file.
+ * @return The number of failed positions, -1 if the file can't be read.
+ */
+s32 DebugEndgameTest(S_BOARD *pos, const char *fileName){
+	
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL){
+		printf("File Not Found: %s\n", fileName);
+		return -1;
+	}
+	
+	char lineIn[1024], fen[128], id[32];
+	const char *ptr, *operand;
+	s32 positions = 0, failed = 0;
+	S_MATERIALENTRY *entry;
+	
+	while(fgets(lineIn, sizeof(lineIn), file) != NULL){
+		
+		if((ptr = ReadEPDPosition(lineIn, fen, sizeof(fen), pos)) == NULL) continue;
+		if((operand = FindEPDOperation(ptr, "c0")) == NULL) continue;
+		u8 win = !strncmp(operand, "\"win\"", 5);
+		
+		strcpy(id, "-");
+		if((operand = FindEPDOperation(ptr, "id")) != NULL){
+			u8 length;
+			if(*operand == '"') operand++;
+			for(length = 0; operand[length] != '\0' && operand[length] != '"' && operand[length] != ';' && length < sizeof(id) - 1; length++){
+				id[length] = operand[length];
+			}
+			id[length] = '\0';
+		}
+		
+		// The evaluation from the side with more material
+		u8 strong = pos->material[WHITE] > pos->material[BLACK] ? WHITE : BLACK;
+		s16 eval = EvalPosition(pos);
+		if(pos->side != strong) eval = -eval;
+		
+		ProbeMaterial(pos, &entry);
+		u8 registered = entry->evaluate != NULL || entry->scale[strong] < 100;
+		
+		MirrorBoard(pos);
+		s16 mirror = EvalPosition(pos);
+		if(pos->side == strong) mirror = -mirror;
+		
+		u8 passed = registered && eval == mirror && (win ? eval >= PieceVal[wR] - PieceVal[wP] : abs(eval) < PieceVal[wP]);
+		
+		positions++;
+		if(!passed) failed++;
+		printf("%-12s %-6s %6d %s%s\n", id, win ? "win" : "draw", eval, passed ? "passed" : "failed",
+			!registered ? " (not registered)" : eval != mirror ? " (mirror)" : "");
+	}
+	
+	fclose(file);
+	printf("\n%d positions, %d passed, %d failed\n", positions, positions - failed, failed);
+	return failed;
 }
 
+/**
+ * Measure the speed of the evaluation on the positions of an EPD file, the positions are evaluated
+ * again and again for every instruction set of the piece square sums that the CPU supports. Only
+ * the evaluations are timed, the board must have an evaluation table of 0 MB so that every position
+ * is evaluated fully (the pawn and material tables are used as in the search). All instruction sets
+ * must give the same evaluations.
+ *
+ * Then the positions are evaluated once more with the best instruction set to profile the evaluation,
+ * the cycles spent in each group of terms are reported per evaluation. The profile is a separate pass
+ * since reading the cycles slows the evaluation down. "other" is the rest of the cycles, mostly the
+ * evaluations that end early (e.g. a draw by material or a specialized ending).
+ *
+ * @param pos The position's pointer.
+ * @param fileName The name of the EPD file.
+ * @param iterations The number of times every position is evaluated.
+ * @return The number of instruction sets that gave other evaluations than the scalar sums, -1 if the file can't be read.
+ */
+s32 DebugEvalBench(S_BOARD *pos, const char *fileName, const u32 iterations){
+	
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL){
+		printf("File Not Found: %s\n", fileName);
+		return -1;
+	}
+	
+	char lineIn[1024];
+	char (*fens)[128] = NULL, (*grown)[128];
+	u32 count = 0, capacity = 0, iteration, index;
+	
+	while(fgets(lineIn, sizeof(lineIn), file) != NULL){
+		
+		if(count == capacity){
+			capacity = capacity ? 2 * capacity : 256;
+			if((grown = realloc(fens, capacity * sizeof(*fens))) == NULL) break;
+			fens = grown;
+		}
+		if(ReadEPDPosition(lineIn, fens[count], sizeof(fens[count]), pos) != NULL) count++;
+	}
+	
+	fclose(file);
+	if(count == 0){
+		printf("No Positions Found: %s\n", fileName);
+		free(fens);
+		return -1;
+	}
+	
+	u64 checksum, scalarChecksum = 0, start, time;
+	s32 mismatches = 0;
+	u8 simd;
+	
+	printf("\n%u positions, %u iterations\n", count, iterations);
+	printf("%-8s %12s %10s %12s %18s\n", "simd", "evals", "time(ms)", "evals/s", "checksum");
+	
+	for(simd = SIMD_NONE; simd < SIMD_NUM; simd++){
+		
+		if(SetEvalSimd(simd) != simd){
+			printf("%-8s not supported by the CPU\n", EvalSimdNames[simd]);
+			continue;
+		}
+		
+		// Warm up the pawn and material tables
+		ClearEvalTable(pos->EvalTable);
+		for(index = 0; index < count; index++){
+			ParseFen(fens[index], pos);
+			EvalPosition(pos);
+		}
+		
+		checksum = 0;
+		time = 0;
+		for(iteration = 0; iteration < iterations; iteration++){
+			for(index = 0; index < count; index++){
+				ParseFen(fens[index], pos);
+				start = GetTimeNs();
+				checksum += (u64) EvalPosition(pos);
+				time += GetTimeNs() - start;
+			}
+		}
+		
+		if(simd == SIMD_NONE) scalarChecksum = checksum;
+		else if(checksum != scalarChecksum) mismatches++;
+		
+		printf("%-8s %12llu %10llu %12llu   %016llx\n", EvalSimdNames[simd], (unsigned long long)count * iterations,
+			(unsigned long long)(time / 1000000), (unsigned long long)(time > 0 ? (u64)count * iterations * 1000000000ULL / time : 0),
+			(unsigned long long)checksum);
+	}
+	
+	simd = SetEvalSimd(SIMD_AVX2);
+	
+	u64 profile[EVAL_PROF_NUM] = {0}, total = 0, groups = 0, evals = (u64)count * iterations;
+	u8 group;
+	
+	SetEvalProfile(profile);
+	for(iteration = 0; iteration < iterations; iteration++){
+		for(index = 0; index < count; index++){
+			ParseFen(fens[index], pos);
+			start = CYCLES();
+			EvalPosition(pos);
+			total += CYCLES() - start;
+		}
+	}
+	SetEvalProfile(NULL);
+	
+	printf("\nProfile (%s):\n", EvalSimdNames[simd]);
+	printf("%-20s %14s %12s %7s\n", "terms", "cycles", "cycles/eval", "%");
+	for(group = 0; group < EVAL_PROF_NUM; group++){
+		groups += profile[group];
+		printf("%-20s %14llu %12.1f %6.1f%%\n", EvalProfileNames[group], (unsigned long long)profile[group],
+			(double)profile[group] / evals, total ? 100.0 * profile[group] / total : 0.0);
+	}
+	printf("%-20s %14llu %12.1f %6.1f%%\n", "other", (unsigned long long)(total - groups),
+		(double)(total - groups) / evals, total ? 100.0 * (total - groups) / total : 0.0);
+	printf("%-20s %14llu %12.1f %6.1f%%\n", "total", (unsigned long long)total, (double)total / evals, total ? 100.0 : 0.0);
+	
+	free(fens);
+	return mismatches;
+}
@@ -211,6 +211,7 @@ void XBoard_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 		if(!strcmp(command, "new")) { 
 			engineSide = BLACK; 
 			ParseFen(START_FEN, pos);
+			ClearHistory(pos);
 			depth = -1; 
 			time = -1;
 			continue; 
@@ -321,7 +322,15 @@ void Console_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 			printf(" default    -> To reset time and depth to default value (time = 6s, depth = Max).\n");
 			printf(" view       -> Show current depth and movetime settings.\n");
 			printf(" ponder_on  -> Turn ON ponder.\n");
-			printf(" ponder_off -> Turn OFF ponder.\n\n");
+			printf(" ponder_off -> Turn OFF ponder.\n");
+			printf(" options    -> Show the engine options.\n");
+			printf(" set x y    -> Set the engine option 'x' to 'y' (ex. set UseNullMove false).\n");
+			printf(" bench [depth] [compare]\n");
+			printf("            -> Search the bench positions, compare the search options if asked.\n");
+			printf(" perftsuite <file> [threads] [maxdepth] [json|csv] [report]\n");
+			printf("            -> Run a perft test suite concurrently and report every position.\n");
+			printf(" epdsuite <file> <ms> [workers] [json|csv] [report]\n");
+			printf("            -> Search an EPD test suite concurrently and report time-to-solution.\n\n");
 			printf(">> Notes <<\n");
 			printf("- You can make moves in the form \"e2e4\", \"e1g1\", \"e7e8q\" (promoring to queen), etc.\n");
 			printf("- After making \"undo\" command the computer will not think, so you should make \"go\" command to return thinking.\n");
@@ -389,6 +398,7 @@ void Console_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 		
 		if(!strcmp(command, "new")){
 			ClearHashTable(pos->HashTable);
+			ClearHistory(pos);
 			engineSide = BLACK;
 			ParseFen(START_FEN,pos);
 			printf("\n---------- New Game ----------\n");
@@ -426,7 +436,22 @@ void Console_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 		
 		if(!strcmp(command, "perft")){
 			engineSide = BOTH;
-			DebugPerftTest(pos);
+			DebugPerftTest("perftsuite.epd", 1, 6, REPORT_CSV, NULL);
+			continue;
+		}
+		
+		if(!strcmp(command, "perftsuite")){
+			engineSide = BOTH;
+			char fileName[80], format[8] = "json", reportName[80];
+			s32 threads = 1, maxDepth = MAXPERFTDEPTH;
+			s32 args = sscanf(inBuf, "perftsuite %79s %d %d %7s %79s", fileName, &threads, &maxDepth, format, reportName);
+			if(args < 1 || threads < 1 || threads > 255 || maxDepth < 1){
+				SetColor(LIGHT_RED);
+				printf("-> Usage: perftsuite <file> [threads] [maxdepth] [json|csv] [report]\n");
+				SetColor(LIGHT_GRAY);
+				continue;
+			}
+			DebugPerftTest(fileName, threads, maxDepth, strcmp(format, "csv") ? REPORT_JSON : REPORT_CSV, args >= 5 ? reportName : NULL);
 			continue;
 		}
 		
@@ -439,7 +464,44 @@ void Console_Loop(S_BOARD *pos, S_SEARCHINFO *info){
 		
 		if(!strcmp(command, "debug")){
 			engineSide = BOTH;
-			DebugAnalysisTest(pos, info);
+			DebugAnalysisTest("arasan20.epd", 60000 * 30, 1, REPORT_CSV, NULL);
+			continue;
+		}
+		
+		if(!strcmp(command, "set")){
+			char name[40], value[40];
+			if(sscanf(inBuf, "set %39s %39s", name, value) != 2 || !SetEngineOption(name, value)){
+				SetColor(LIGHT_RED);
+				printf("-> Unknown option or value! Type \"options\" to list them.\n");
+				SetColor(LIGHT_GRAY);
+			}
+			continue;
+		}
+		
+		if(!strcmp(command, "options")){
+			PrintEngineOptions(CONSOLE_MODE);
+			continue;
+		}
+		
+		if(!strcmp(command, "bench")){
+			s32 benchDepth = 0;
+			sscanf(inBuf, "bench %d", &benchDepth);
+			DebugBench(pos, benchDepth > 0 && benchDepth <= MAXDEPTH ? benchDepth : 0, strstr(inBuf, "compare") != NULL);
+			continue;
+		}
+		
+		if(!strcmp(command, "epdsuite")){
+			engineSide = BOTH;
+			char fileName[80], format[8] = "json", reportName[80];
+			s32 time = 0, workers = 1;
+			s32 args = sscanf(inBuf, "epdsuite %79s %d %d %7s %79s", fileName, &time, &workers, format, reportName);
+			if(args < 2 || time < 1 || workers < 1 || workers > 255){
+				SetColor(LIGHT_RED);
+				printf("-> Usage: epdsuite <file> <ms> [workers] [json|csv] [report]\n");
+				SetColor(LIGHT_GRAY);
+				continue;
+			}
+			DebugAnalysisTest(fileName, time, workers, strcmp(format, "csv") ? REPORT_JSON : REPORT_CSV, args >= 5 ? reportName : NULL);
 			continue;
 		}
 		